@@ -0,0 +1,262 @@
+// Copyright 2021 Airbus Defence and Space
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package godal
+
+/*
+#include "godal.h"
+#include <stdlib.h>
+*/
+import "C"
+import (
+	"fmt"
+	"sync"
+	"unsafe"
+)
+
+// RasterBuffer is a pixel buffer returned by a BufferPool
+type RasterBuffer struct {
+	// Data is a slice of Width*Height*Bands pixels of type DataType (i.e. []byte,
+	// []float32, ...) that can be passed to Band.IO or Dataset.IO. Its content is
+	// undefined when returned by BufferPool.Get.
+	Data                 interface{}
+	DataType             DataType
+	Width, Height, Bands int
+	cptr                 unsafe.Pointer
+}
+
+type bufferKey struct {
+	dt     DataType
+	pixels int
+}
+
+// maxBufferKeys is the number of buffer sizes a BufferPool keeps buffers for. Buffers
+// of the least recently requested sizes are dropped when it is exceeded.
+const maxBufferKeys = 64
+
+// maxCBufferPixels is the maximum number of pixels of a C allocated buffer, which is
+// exposed as a slice of a fixed size array
+const maxCBufferPixels = 1 << 30
+
+// BufferPool recycles the pixel buffers used to read or write rasters, in order to
+// avoid allocating a new buffer for each window. Buffers are pooled by data type and
+// number of pixels, i.e. a buffer of 256x256x3 pixels may be reused for a 768x256x1
+// request. Buffers are only kept for the 64 most recently requested sizes. A BufferPool
+// is safe for concurrent use.
+type BufferPool struct {
+	cmem    bool
+	maxIdle int
+	mu      sync.Mutex
+	// heap buffers are kept in sync.Pools so that idle buffers can be collected.
+	// C buffers must be freed explicitly and are kept in bounded free lists.
+	pools map[bufferKey]*sync.Pool
+	idle  map[bufferKey][]*RasterBuffer
+	keys  []bufferKey // sizes of pools and idle, least recently requested first
+}
+
+// NewBufferPool creates a BufferPool
+func NewBufferPool(opts ...BufferPoolOption) *BufferPool {
+	bo := bufferPoolOpts{
+		maxIdle: 16,
+	}
+	for _, o := range opts {
+		o.setBufferPoolOpt(&bo)
+	}
+	return &BufferPool{
+		cmem:    bo.cmem,
+		maxIdle: bo.maxIdle,
+		pools:   make(map[bufferKey]*sync.Pool),
+		idle:    make(map[bufferKey][]*RasterBuffer),
+	}
+}
+
+// Get returns a buffer of width*height*bands pixels of type dt, either recycled
+// or newly allocated. It should be returned to the pool with Put once it is not
+// needed anymore, which is mandatory for pools created with CMemory. An error is
+// returned for unsupported data types, and for C allocated buffers of more than 1<<30 pixels.
+func (p *BufferPool) Get(dt DataType, width, height, bands int) (*RasterBuffer, error) {
+	if _, err := newBuffer(dt, 0); err != nil {
+		return nil, err
+	}
+	if width < 0 || height < 0 || bands < 0 {
+		return nil, fmt.Errorf("invalid buffer size %dx%dx%d", width, height, bands)
+	}
+	key := bufferKey{dt, width * height * bands}
+	if height > 0 && bands > 0 && key.pixels/height/bands != width {
+		return nil, fmt.Errorf("invalid buffer size %dx%dx%d", width, height, bands)
+	}
+	var rb *RasterBuffer
+	if p.cmem {
+		if key.pixels > maxCBufferPixels {
+			return nil, fmt.Errorf("buffer of %d pixels cannot be C allocated", key.pixels)
+		}
+		p.mu.Lock()
+		p.touch(key)
+		if idle := p.idle[key]; len(idle) > 0 {
+			rb = idle[len(idle)-1]
+			p.idle[key] = idle[:len(idle)-1]
+		}
+		p.mu.Unlock()
+		if rb == nil {
+			var err error
+			if rb, err = newCRasterBuffer(dt, key.pixels); err != nil {
+				return nil, err
+			}
+		}
+	} else {
+		p.mu.Lock()
+		p.touch(key)
+		pool := p.pools[key]
+		if pool == nil {
+			pool = &sync.Pool{New: func() interface{} {
+				//the data type has been validated by Get
+				data, _ := newBuffer(key.dt, key.pixels)
+				return &RasterBuffer{Data: data, DataType: key.dt}
+			}}
+			p.pools[key] = pool
+		}
+		p.mu.Unlock()
+		rb = pool.Get().(*RasterBuffer)
+	}
+	rb.Width, rb.Height, rb.Bands = width, height, bands
+	return rb, nil
+}
+
+// touch marks key as the most recently requested size, and drops the buffers of the
+// least recently requested size if there are more than maxBufferKeys. p.mu must be held
+func (p *BufferPool) touch(key bufferKey) {
+	for i := len(p.keys) - 1; i >= 0; i-- {
+		if p.keys[i] == key {
+			copy(p.keys[i:], p.keys[i+1:])
+			p.keys[len(p.keys)-1] = key
+			return
+		}
+	}
+	p.keys = append(p.keys, key)
+	if len(p.keys) <= maxBufferKeys {
+		return
+	}
+	evicted := p.keys[0]
+	p.keys = append(p.keys[:0], p.keys[1:]...)
+	//heap buffers are collected once unreferenced, and buffers of the evicted size that
+	//are still in use are dropped (or freed) when they are Put back
+	delete(p.pools, evicted)
+	for _, rb := range p.idle[evicted] {
+		rb.free()
+	}
+	delete(p.idle, evicted)
+}
+
+// Put returns a buffer obtained with Get to the pool. The buffer must not be used
+// after it has been returned.
+func (p *BufferPool) Put(rb *RasterBuffer) {
+	if rb == nil {
+		return
+	}
+	key := bufferKey{rb.DataType, rb.Width * rb.Height * rb.Bands}
+	if rb.cptr == nil {
+		p.mu.Lock()
+		pool := p.pools[key]
+		p.mu.Unlock()
+		if pool != nil {
+			pool.Put(rb)
+		}
+		return
+	}
+	p.mu.Lock()
+	if idle, ok := p.idle[key]; (ok || p.requested(key)) && len(idle) < p.maxIdle {
+		p.idle[key] = append(idle, rb)
+		rb = nil
+	}
+	p.mu.Unlock()
+	if rb != nil {
+		rb.free()
+	}
+}
+
+// requested returns whether key is one of the sizes the pool keeps buffers for. p.mu must be held
+func (p *BufferPool) requested(key bufferKey) bool {
+	for _, k := range p.keys {
+		if k == key {
+			return true
+		}
+	}
+	return false
+}
+
+// Close releases the idle C allocated buffers of the pool. Buffers that are still in
+// use are released when they are Put back.
+func (p *BufferPool) Close() {
+	p.mu.Lock()
+	idle := p.idle
+	p.idle = make(map[bufferKey][]*RasterBuffer)
+	p.maxIdle = 0
+	p.mu.Unlock()
+	for _, bufs := range idle {
+		for _, rb := range bufs {
+			rb.free()
+		}
+	}
+}
+
+func newCRasterBuffer(dt DataType, n int) (*RasterBuffer, error) {
+	esize := dt.Size()
+	switch dt {
+	//complex integers are exposed as complex floats
+	case CInt16:
+		esize = 8
+	case CInt32:
+		esize = 16
+	}
+	size := n * esize
+	if size == 0 {
+		size = 1
+	}
+	//aligned for the benefit of SIMD code processing the buffer
+	cptr := C.VSIMallocAligned(64, C.size_t(size))
+	if cptr == nil {
+		return nil, fmt.Errorf("VSIMallocAligned: cannot allocate %d bytes", size)
+	}
+	var data interface{}
+	switch dt {
+	case Byte:
+		data = (*[1 << 30]byte)(cptr)[:n:n]
+	case Int16:
+		data = (*[1 << 30]int16)(cptr)[:n:n]
+	case UInt16:
+		data = (*[1 << 30]uint16)(cptr)[:n:n]
+	case Int32:
+		data = (*[1 << 30]int32)(cptr)[:n:n]
+	case UInt32:
+		data = (*[1 << 30]uint32)(cptr)[:n:n]
+	case Float32:
+		data = (*[1 << 30]float32)(cptr)[:n:n]
+	case Float64:
+		data = (*[1 << 30]float64)(cptr)[:n:n]
+	case CInt16, CFloat32:
+		data = (*[1 << 30]complex64)(cptr)[:n:n]
+	case CInt32, CFloat64:
+		data = (*[1 << 30]complex128)(cptr)[:n:n]
+	default:
+		C.VSIFreeAligned(cptr)
+		return nil, fmt.Errorf("unsupported data type %s", dt)
+	}
+	return &RasterBuffer{Data: data, DataType: dt, cptr: cptr}, nil
+}
+
+func (rb *RasterBuffer) free() {
+	C.VSIFreeAligned(rb.cptr)
+	rb.cptr = nil
+	rb.Data = nil
+}
@@ -0,0 +1,218 @@
+// Copyright 2021 Airbus Defence and Space
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package godal
+
+/*
+#include "godal.h"
+#include <stdlib.h>
+*/
+import "C"
+import (
+	"container/list"
+	"fmt"
+	"strings"
+	"sync"
+)
+
+type idleDataset struct {
+	key    string
+	handle C.GDALDatasetH
+}
+
+// DatasetPool keeps opened datasets around so that they can be reused instead of
+// being opened again, e.g. to avoid parsing the same TIFF headers for each tile served
+// from a file. A DatasetPool is safe for concurrent use.
+//
+// Datasets are pooled by name, open flags, drivers, open options, sibling files and
+// config options. Each dataset returned by Get is for the exclusive use of the caller
+// (i.e. the same handle is never handed out twice at the same time), who must return it to
+// the pool by calling its Close method once done. Pooled datasets must be opened
+// read-only, and their state (e.g. block cache contents) is preserved between uses.
+type DatasetPool struct {
+	maxIdle int
+	maxOpen int
+	mu      sync.Mutex
+	cond    *sync.Cond
+	open    int // number of handles being opened, in use or idle
+	inUse   map[C.GDALDatasetH]string
+	idle    map[string][]*list.Element
+	lru     *list.List // idle datasets, most recently used first
+	waiting int        // number of Get calls waiting for a dataset to be returned
+	closed  bool
+}
+
+// NewDatasetPool creates a DatasetPool
+func NewDatasetPool(opts ...DatasetPoolOption) *DatasetPool {
+	po := datasetPoolOpts{
+		maxIdle: 64,
+	}
+	for _, o := range opts {
+		o.setDatasetPoolOpt(&po)
+	}
+	p := &DatasetPool{
+		maxIdle: po.maxIdle,
+		maxOpen: po.maxOpen,
+		inUse:   make(map[C.GDALDatasetH]string),
+		idle:    make(map[string][]*list.Element),
+		lru:     list.New(),
+	}
+	p.cond = sync.NewCond(&p.mu)
+	return p
+}
+
+func datasetPoolKey(name string, oopts *openOpts) string {
+	return fmt.Sprintf("%s\x01%d\x01%s\x01%s\x01%s\x01%s", name, oopts.flags,
+		strings.Join(oopts.drivers, "\x00"), strings.Join(oopts.options, "\x00"),
+		strings.Join(oopts.siblingFiles, "\x00"), strings.Join(oopts.config, "\x00"))
+}
+
+// Get returns an idle dataset opened with the same name and options if there is one,
+// and opens a new one with Open(name, options...) otherwise. The returned dataset must
+// be returned to the pool by calling its Close method.
+//
+// If MaxOpen datasets are already open, Get closes the least recently used idle
+// dataset, or waits for one to be returned if they are all in use.
+//
+// Get returns an error if the Update option is used, as the unflushed changes made
+// by one user would be seen by the next ones.
+func (p *DatasetPool) Get(name string, options ...OpenOption) (*Dataset, error) {
+	oopts := newOpenOpts(name, options)
+	if oopts.flags&C.GDAL_OF_UPDATE != 0 {
+		return nil, fmt.Errorf("datasets of a pool must be opened read-only")
+	}
+	key := datasetPoolKey(name, &oopts)
+	var evicted C.GDALDatasetH
+	p.mu.Lock()
+	if p.closed {
+		p.mu.Unlock()
+		return nil, fmt.Errorf("dataset pool is closed")
+	}
+	for {
+		if idle := p.idle[key]; len(idle) > 0 {
+			elem := idle[len(idle)-1]
+			p.removeIdle(elem)
+			h := elem.Value.(idleDataset).handle
+			p.inUse[h] = key
+			p.mu.Unlock()
+			return &Dataset{majorObject: majorObject{C.GDALMajorObjectH(h)}, pool: p}, nil
+		}
+		if p.maxOpen <= 0 || p.open < p.maxOpen {
+			break
+		}
+		if back := p.lru.Back(); back != nil {
+			//free a slot by closing the least recently used idle dataset
+			evicted = p.removeIdle(back).handle
+			p.open--
+			break
+		}
+		p.waiting++
+		p.cond.Wait()
+		p.waiting--
+		if p.closed {
+			p.mu.Unlock()
+			return nil, fmt.Errorf("dataset pool is closed")
+		}
+	}
+	p.open++
+	p.mu.Unlock()
+
+	if evicted != nil {
+		closeHandle(evicted)
+	}
+	ds, err := open(name, oopts)
+
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	if err != nil {
+		p.open--
+		p.cond.Signal()
+		return nil, err
+	}
+	p.inUse[ds.handle()] = key
+	ds.pool = p
+	return ds, nil
+}
+
+// removeIdle removes elem from the idle datasets. p.mu must be held
+func (p *DatasetPool) removeIdle(elem *list.Element) idleDataset {
+	ids := p.lru.Remove(elem).(idleDataset)
+	idle := p.idle[ids.key]
+	for i := range idle {
+		if idle[i] == elem {
+			idle = append(idle[:i], idle[i+1:]...)
+			break
+		}
+	}
+	if len(idle) == 0 {
+		delete(p.idle, ids.key)
+	} else {
+		p.idle[ids.key] = idle
+	}
+	return ids
+}
+
+// put is called by Dataset.Close to return a dataset obtained with Get
+func (p *DatasetPool) put(h C.GDALDatasetH) error {
+	var toClose []C.GDALDatasetH
+	p.mu.Lock()
+	key, ok := p.inUse[h]
+	if !ok {
+		p.mu.Unlock()
+		return fmt.Errorf("dataset is not in use in this pool")
+	}
+	delete(p.inUse, h)
+	if p.closed || p.maxIdle <= 0 {
+		toClose = append(toClose, h)
+		p.open--
+	} else {
+		elem := p.lru.PushFront(idleDataset{key: key, handle: h})
+		p.idle[key] = append(p.idle[key], elem)
+		for p.lru.Len() > p.maxIdle {
+			toClose = append(toClose, p.removeIdle(p.lru.Back()).handle)
+			p.open--
+		}
+	}
+	p.cond.Signal()
+	p.mu.Unlock()
+	for _, h := range toClose {
+		closeHandle(h)
+	}
+	return nil
+}
+
+// Close closes the idle datasets of the pool. Datasets that are still in use are
+// closed when they are returned. Get cannot be called on a closed pool.
+func (p *DatasetPool) Close() {
+	var toClose []C.GDALDatasetH
+	p.mu.Lock()
+	p.closed = true
+	for p.lru.Len() > 0 {
+		toClose = append(toClose, p.removeIdle(p.lru.Back()).handle)
+		p.open--
+	}
+	p.cond.Broadcast()
+	p.mu.Unlock()
+	for _, h := range toClose {
+		closeHandle(h)
+	}
+}
+
+// closeHandle closes a dataset that has already been successfully used, hence
+// ignoring any error
+func closeHandle(h C.GDALDatasetH) {
+	cgc := createCGOContext(nil, nil)
+	C.godalClose(cgc.cPointer(), h)
+	_ = cgc.close()
+}
@@ -37,6 +37,7 @@ var errorHandlerIndex int
 type ErrorHandler func(ec ErrorCategory, code int, msg string) error
 
 type errorHandlerWrapper struct {
+	mu  sync.Mutex
 	fn  ErrorHandler
 	err error
 }
@@ -82,6 +83,7 @@ func ErrLogger(fn ErrorHandler) interface {
 	errorAndLoggingOption
 	BandCreateMaskOption
 	BandIOOption
+	BlockIOOption
 	//BoundsOption
 	BufferOption
 	BuildOverviewsOption
@@ -98,10 +100,12 @@ func ErrLogger(fn ErrorHandler) interface {
 	DatasetWarpIntoOption
 	DatasetWarpOption
 	DeleteFeatureOption
+	FeatureBatchOption
 	FeatureCountOption
 	FillBandOption
 	FillNoDataOption
 	GeoJSONOption
+	GeometryBatchOption
 	GeometryTransformOption
 	GeometryReprojectOption
 	GeometryWKBOption
@@ -113,8 +117,11 @@ func ErrLogger(fn ErrorHandler) interface {
 	NewGeometryOption
 	OpenOption
 	PolygonizeOption
+	ProcessTilesOption
 	RasterizeGeometryOption
+	RasterizeGeometriesOption
 	RasterizeOption
+	RawTileOption
 	SetColorInterpOption
 	SetColorTableOption
 	SetGeometryOption
@@ -124,11 +131,17 @@ func ErrLogger(fn ErrorHandler) interface {
 	SetSpatialRefOption
 	SieveFilterOption
 	SimplifyOption
+	StatisticsOption
 	TransformOption
 	UpdateFeatureOption
 	VSIHandlerOption
+	VSIInvalidateOption
 	VSIOpenOption
+	VSIStatsOption
 	VSIUnlinkOption
+	WarperOption
+	WarpTileOption
+	WriteFeatureBatchOption
 	WKTExportOption
 } {
 	return errorCallback{fn}
@@ -143,6 +156,33 @@ func (ec errorCallback) setBandCreateMaskOpt(o *bandCreateMaskOpts) {
 func (ec errorCallback) setBandIOOpt(o *bandIOOpts) {
 	o.errorHandler = ec.fn
 }
+func (ec errorCallback) setBlockIOOpt(o *blockIOOpts) {
+	o.errorHandler = ec.fn
+}
+func (ec errorCallback) setRawTileOpt(o *rawTileOpts) {
+	o.errorHandler = ec.fn
+}
+func (ec errorCallback) setProcessTilesOpt(o *processTilesOpts) {
+	o.errorHandler = ec.fn
+}
+func (ec errorCallback) setFeatureBatchOpt(o *featureBatchOpts) {
+	o.errorHandler = ec.fn
+}
+func (ec errorCallback) setWriteFeatureBatchOpt(o *writeFeatureBatchOpts) {
+	o.errorHandler = ec.fn
+}
+func (ec errorCallback) setGeometryBatchOpt(o *geometryBatchOpts) {
+	o.errorHandler = ec.fn
+}
+func (ec errorCallback) setStatisticsOpt(o *statisticsOpts) {
+	o.errorHandler = ec.fn
+}
+func (ec errorCallback) setWarperOpt(o *warperOpts) {
+	o.errorHandler = ec.fn
+}
+func (ec errorCallback) setWarpTileOpt(o *warpTileOpts) {
+	o.errorHandler = ec.fn
+}
 
 /*
 func (ec errorCallback) setBoundsOpt(o *boundsOpts) {
@@ -243,6 +283,9 @@ func (ec errorCallback) setPolygonizeOpt(o *polygonizeOpts) {
 func (ec errorCallback) setRasterizeGeometryOpt(o *rasterizeGeometryOpts) {
 	o.errorHandler = ec.fn
 }
+func (ec errorCallback) setRasterizeGeometriesOpt(o *rasterizeGeometriesOpts) {
+	o.errorHandler = ec.fn
+}
 func (ec errorCallback) setRasterizeOpt(o *rasterizeOpts) {
 	o.errorHandler = ec.fn
 }
@@ -282,9 +325,15 @@ func (ec errorCallback) setUpdateFeatureOpt(o *updateFeatureOpts) {
 func (ec errorCallback) setVSIHandlerOpt(o *vsiHandlerOpts) {
 	o.errorHandler = ec.fn
 }
+func (ec errorCallback) setVSIInvalidateOpt(o *vsiInvalidateOpts) {
+	o.errorHandler = ec.fn
+}
 func (ec errorCallback) setVSIOpenOpt(o *vsiOpenOpts) {
 	o.errorHandler = ec.fn
 }
+func (ec errorCallback) setVSIStatsOpt(o *vsiStatsOpts) {
+	o.errorHandler = ec.fn
+}
 func (ec errorCallback) setVSIUnlinkOpt(o *vsiUnlinkOpts) {
 	o.errorHandler = ec.fn
 }
@@ -0,0 +1,404 @@
+// Copyright 2021 Airbus Defence and Space
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package godal
+
+/*
+#include "godal.h"
+#include <stdlib.h>
+*/
+import "C"
+import (
+	"fmt"
+	"runtime"
+	"time"
+	"unsafe"
+)
+
+// FeatureBatch holds consecutive features of a Layer in a columnar layout, as returned
+// by Layer.NextFeatureBatch
+type FeatureBatch struct {
+	// FIDs holds the ids of the features
+	FIDs []int64
+	// Geometries holds the ISO WKB encoded geometries of the features. The geometry of the
+	// i-th feature is Geometries[GeometryOffsets[i]:GeometryOffsets[i+1]], which is empty
+	// if the feature has no geometry.
+	Geometries      []byte
+	GeometryOffsets []int
+	// Columns holds the attributes of the features, one column per field of the layer
+	Columns []FieldColumn
+}
+
+// Len returns the number of features in the batch
+func (b *FeatureBatch) Len() int {
+	return len(b.FIDs)
+}
+
+// Geometry returns the WKB geometry of the i-th feature, or nil if it has none
+func (b *FeatureBatch) Geometry(i int) []byte {
+	if b.GeometryOffsets[i] == b.GeometryOffsets[i+1] {
+		return nil
+	}
+	return b.Geometries[b.GeometryOffsets[i]:b.GeometryOffsets[i+1]]
+}
+
+// Column returns the column of the named field, or nil if there is no such field
+func (b *FeatureBatch) Column(name string) *FieldColumn {
+	for i := range b.Columns {
+		if b.Columns[i].Name == name {
+			return &b.Columns[i]
+		}
+	}
+	return nil
+}
+
+// FieldColumn holds the values of a field for all the features of a FeatureBatch.
+// Depending on Type, the value of the i-th feature is:
+//
+// • FTInt, FTInt64: Ints[i]
+//
+// • FTReal: Floats[i]
+//
+// • FTString, FTBinary: Bytes[Offsets[i]:Offsets[i+1]]
+//
+// • FTDate, FTTime, FTDateTime: Times[i]
+//
+// • FTIntList, FTInt64List: Ints[ListOffsets[i]:ListOffsets[i+1]]
+//
+// • FTRealList: Floats[ListOffsets[i]:ListOffsets[i+1]]
+//
+// • FTStringList: the strings j of [ListOffsets[i],ListOffsets[i+1]), i.e.
+// Bytes[Offsets[j]:Offsets[j+1]]
+//
+// Unset or null values are flagged in Nulls, and hold a zero/empty value.
+type FieldColumn struct {
+	Name        string
+	Type        FieldType
+	Nulls       []bool
+	Ints        []int64
+	Floats      []float64
+	Bytes       []byte
+	Offsets     []int
+	ListOffsets []int
+	Times       []time.Time
+}
+
+// String returns the value of the i-th feature of a FTString column
+func (c *FieldColumn) String(i int) string {
+	return string(c.Bytes[c.Offsets[i]:c.Offsets[i+1]])
+}
+
+// StringList returns the value of the i-th feature of a FTStringList column
+func (c *FieldColumn) StringList(i int) []string {
+	ret := make([]string, 0, c.ListOffsets[i+1]-c.ListOffsets[i])
+	for j := c.ListOffsets[i]; j < c.ListOffsets[i+1]; j++ {
+		ret = append(ret, c.String(j))
+	}
+	return ret
+}
+
+// NextFeatureBatch reads up to n features from the layer, continuing from where the
+// previous call to NextFeature or NextFeatureBatch stopped. All the features are read
+// with a single cgo call. Returns nil once all the features have been read.
+func (layer Layer) NextFeatureBatch(n int, opts ...FeatureBatchOption) (*FeatureBatch, error) {
+	fbo := featureBatchOpts{}
+	for _, o := range opts {
+		o.setFeatureBatchOpt(&fbo)
+	}
+	if n <= 0 {
+		return nil, fmt.Errorf("invalid batch size %d", n)
+	}
+	cgc := createCGOContext(nil, fbo.errorHandler)
+	cbatch := C.godalLayerNextFeatureBatch(cgc.cPointer(), layer.handle(), C.int(n))
+	defer C.godalFreeFeatureBatch(cbatch)
+	if err := cgc.close(); err != nil {
+		return nil, err
+	}
+	nf := int(cbatch.nFeatures)
+	if nf == 0 {
+		return nil, nil
+	}
+	b := &FeatureBatch{
+		FIDs:            cInt64s(cbatch.fids, nf),
+		GeometryOffsets: cOffsets(cbatch.wkbOffsets, nf+1),
+	}
+	b.Geometries = C.GoBytes(unsafe.Pointer(cbatch.wkb), C.int(b.GeometryOffsets[nf]))
+	ccols := (*[1 << 20]C.godalFieldColumn)(unsafe.Pointer(cbatch.columns))[:cbatch.nFields:cbatch.nFields]
+	b.Columns = make([]FieldColumn, len(ccols))
+	for i := range ccols {
+		b.Columns[i] = goFieldColumn(&ccols[i], nf)
+	}
+	return b, nil
+}
+
+func goFieldColumn(ccol *C.godalFieldColumn, nf int) FieldColumn {
+	col := FieldColumn{
+		Name:  C.GoString(ccol.name),
+		Type:  FieldType(ccol._type),
+		Nulls: make([]bool, nf),
+	}
+	for i, null := range (*[1 << 30]C.uchar)(unsafe.Pointer(ccol.nulls))[:nf:nf] {
+		col.Nulls[i] = null != 0
+	}
+	ints := cInt64s(ccol.ints, int(ccol.nInts))
+	floats := cFloat64s(ccol.doubles, int(ccol.nDoubles))
+	if ccol.nOffsets > 1 {
+		col.Offsets = cOffsets(ccol.offsets, int(ccol.nOffsets))
+		col.Bytes = C.GoBytes(unsafe.Pointer(ccol.bytes), C.int(col.Offsets[len(col.Offsets)-1]))
+	}
+	if ccol.listOffsets != nil {
+		col.ListOffsets = cOffsets(ccol.listOffsets, nf+1)
+	}
+	switch col.Type {
+	case FTDate, FTTime, FTDateTime:
+		col.Times = make([]time.Time, nf)
+		for i := range col.Times {
+			if !col.Nulls[i] {
+				col.Times[i] = ogrTime(ints[i*6:i*6+6], floats[i])
+			}
+		}
+	default:
+		col.Ints = ints
+		col.Floats = floats
+	}
+	return col
+}
+
+// ogrTime converts the year,month,day,hour,minute,tzflag and seconds of an OGR date
+func ogrTime(dt []int64, sec float64) time.Time {
+	month, day := time.Month(dt[1]), int(dt[2])
+	if month == 0 { //FTTime
+		month, day = 1, 1
+	}
+	loc := time.UTC
+	switch tz := int(dt[5]); {
+	case tz == 1:
+		loc = time.Local
+	case tz > 1 && tz != 100:
+		loc = time.FixedZone("", (tz-100)*15*60)
+	}
+	isec := int(sec)
+	nsec := int((sec - float64(isec)) * 1e9)
+	return time.Date(int(dt[0]), month, day, int(dt[3]), int(dt[4]), isec, nsec, loc)
+}
+
+func cInt64s(p *C.longlong, n int) []int64 {
+	if n == 0 {
+		return nil
+	}
+	ret := make([]int64, n)
+	copy(ret, (*[1 << 28]int64)(unsafe.Pointer(p))[:n:n])
+	return ret
+}
+
+func cFloat64s(p *C.double, n int) []float64 {
+	if n == 0 {
+		return nil
+	}
+	ret := make([]float64, n)
+	copy(ret, (*[1 << 28]float64)(unsafe.Pointer(p))[:n:n])
+	return ret
+}
+
+func cOffsets(p *C.longlong, n int) []int {
+	ret := make([]int, n)
+	for i, off := range (*[1 << 28]C.longlong)(unsafe.Pointer(p))[:n:n] {
+		ret[i] = int(off)
+	}
+	return ret
+}
+
+// WriteFeatureBatch creates one feature in the layer for each entry of b.FIDs, in a
+// single cgo call:
+//
+// • b.FIDs are set on the created features. Use -1 to let the driver assign the id.
+//
+// • b.Geometries and b.GeometryOffsets hold the WKB geometries of the features, as
+// returned by NextFeatureBatch. Features with an empty WKB, or all the features if
+// GeometryOffsets is empty, have no geometry.
+//
+// • each of b.Columns is written to the layer field of the same name, with the layout
+// documented on FieldColumn. Nulls may be left empty if no value is null.
+//
+// The features are created inside transactions of 10000 features, which can be changed
+// with TransactionSize. WriteFeatureBatch returns the number of features that have been
+// written: if an error occurs, the transaction it occurred in is rolled back while the
+// features of the previously committed transactions are kept.
+func (layer Layer) WriteFeatureBatch(b *FeatureBatch, opts ...WriteFeatureBatchOption) (int, error) {
+	wo := writeFeatureBatchOpts{transactionSize: 10000}
+	for _, o := range opts {
+		o.setWriteFeatureBatchOpt(&wo)
+	}
+	nf := len(b.FIDs)
+	if nf == 0 {
+		return 0, nil
+	}
+	var cwkb, cwkbOffsets C.uintptr_t
+	var wkbOffsets []int64
+	if len(b.GeometryOffsets) > 0 {
+		var err error
+		if wkbOffsets, err = checkOffsets(b.GeometryOffsets, nf+1, len(b.Geometries)); err != nil {
+			return 0, fmt.Errorf("geometries: %w", err)
+		}
+		cwkbOffsets = C.uintptr_t(uintptr(unsafe.Pointer(&wkbOffsets[0])))
+		if len(b.Geometries) > 0 {
+			cwkb = C.uintptr_t(uintptr(unsafe.Pointer(&b.Geometries[0])))
+		}
+	}
+	defn := C.OGR_L_GetLayerDefn(layer.handle())
+	ccols := make([]C.godalWriteColumn, len(b.Columns))
+	//keeps the arrays converted from the columns alive until the C call returns
+	keep := make([]interface{}, 0, 3*len(b.Columns))
+	for i := range b.Columns {
+		col := &b.Columns[i]
+		cname := C.CString(col.Name)
+		fld := C.OGR_FD_GetFieldIndex(defn, cname)
+		C.free(unsafe.Pointer(cname))
+		if fld < 0 {
+			return 0, fmt.Errorf("layer has no field %s", col.Name)
+		}
+		arrays, err := col.writeArrays(nf)
+		if err != nil {
+			return 0, fmt.Errorf("field %s: %w", col.Name, err)
+		}
+		keep = append(keep, arrays...)
+		ccols[i] = C.godalWriteColumn{
+			field:       fld,
+			_type:       C.OGRFieldType(col.Type),
+			nulls:       cAddress(arrays[0]),
+			ints:        cAddress(arrays[1]),
+			doubles:     cAddress(arrays[2]),
+			bytes:       cAddress(arrays[3]),
+			offsets:     cAddress(arrays[4]),
+			listOffsets: cAddress(arrays[5]),
+		}
+	}
+	var cccols *C.godalWriteColumn
+	if len(ccols) > 0 {
+		cccols = &ccols[0]
+	}
+
+	cgc := createCGOContext(nil, wo.errorHandler)
+	n := C.godalLayerWriteFeatureBatch(cgc.cPointer(), layer.handle(), C.int(nf),
+		C.uintptr_t(uintptr(unsafe.Pointer(&b.FIDs[0]))), cwkb, cwkbOffsets,
+		C.int(len(ccols)), cccols, C.int(wo.transactionSize))
+	runtime.KeepAlive(b)
+	runtime.KeepAlive(wkbOffsets)
+	runtime.KeepAlive(keep)
+	return int(n), cgc.close()
+}
+
+// writeArrays checks that the column holds nf features and returns the nulls, ints,
+// doubles, bytes, offsets and listOffsets arrays to pass to godalLayerWriteFeatureBatch
+func (c *FieldColumn) writeArrays(nf int) ([]interface{}, error) {
+	arrays := make([]interface{}, 6)
+	if len(c.Nulls) > 0 {
+		if len(c.Nulls) != nf {
+			return nil, fmt.Errorf("got %d nulls for %d features", len(c.Nulls), nf)
+		}
+		arrays[0] = c.Nulls
+	}
+	nvals := nf
+	switch c.Type {
+	case FTIntList, FTInt64List, FTRealList, FTStringList:
+		listOffsets, err := checkOffsets(c.ListOffsets, nf+1, -1)
+		if err != nil {
+			return nil, fmt.Errorf("list offsets: %w", err)
+		}
+		arrays[5] = listOffsets
+		nvals = int(listOffsets[nf])
+	}
+	switch c.Type {
+	case FTInt, FTInt64, FTIntList, FTInt64List:
+		if len(c.Ints) < nvals {
+			return nil, fmt.Errorf("got %d ints, expected %d", len(c.Ints), nvals)
+		}
+		arrays[1] = c.Ints
+	case FTReal, FTRealList:
+		if len(c.Floats) < nvals {
+			return nil, fmt.Errorf("got %d floats, expected %d", len(c.Floats), nvals)
+		}
+		arrays[2] = c.Floats
+	case FTString, FTBinary, FTStringList:
+		offsets, err := checkOffsets(c.Offsets, nvals+1, len(c.Bytes))
+		if err != nil {
+			return nil, fmt.Errorf("offsets: %w", err)
+		}
+		arrays[3] = c.Bytes
+		arrays[4] = offsets
+	case FTDate, FTTime, FTDateTime:
+		if len(c.Times) != nf {
+			return nil, fmt.Errorf("got %d times for %d features", len(c.Times), nf)
+		}
+		dts := make([]int64, 6*nf)
+		secs := make([]float64, nf)
+		for i, t := range c.Times {
+			_, offset := t.Zone()
+			tz := int64(100 + offset/(15*60))
+			if t.Location() == time.Local {
+				tz = 1
+			}
+			copy(dts[6*i:], []int64{int64(t.Year()), int64(t.Month()), int64(t.Day()),
+				int64(t.Hour()), int64(t.Minute()), tz})
+			secs[i] = float64(t.Second()) + float64(t.Nanosecond())/1e9
+		}
+		arrays[1] = dts
+		arrays[2] = secs
+	default:
+		return nil, fmt.Errorf("unsupported field type %d", c.Type)
+	}
+	return arrays, nil
+}
+
+// checkOffsets checks that offsets holds n increasing values not greater than max (if
+// max >= 0), and returns them as int64s
+func checkOffsets(offsets []int, n int, max int) ([]int64, error) {
+	if len(offsets) != n {
+		return nil, fmt.Errorf("got %d offsets, expected %d", len(offsets), n)
+	}
+	ret := make([]int64, n)
+	prev := 0
+	for i, off := range offsets {
+		if off < prev || (max >= 0 && off > max) {
+			return nil, fmt.Errorf("invalid offset %d at index %d", off, i)
+		}
+		ret[i] = int64(off)
+		prev = off
+	}
+	return ret, nil
+}
+
+// cAddress returns the address of the first element of a non empty slice, or 0
+func cAddress(slice interface{}) C.uintptr_t {
+	var p unsafe.Pointer
+	switch s := slice.(type) {
+	case []bool:
+		if len(s) > 0 {
+			p = unsafe.Pointer(&s[0])
+		}
+	case []int64:
+		if len(s) > 0 {
+			p = unsafe.Pointer(&s[0])
+		}
+	case []float64:
+		if len(s) > 0 {
+			p = unsafe.Pointer(&s[0])
+		}
+	case []byte:
+		if len(s) > 0 {
+			p = unsafe.Pointer(&s[0])
+		}
+	}
+	return C.uintptr_t(uintptr(p))
+}
@@ -0,0 +1,185 @@
+// Copyright 2021 Airbus Defence and Space
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package godal
+
+/*
+#include "godal.h"
+#include <stdlib.h>
+*/
+import "C"
+import (
+	"errors"
+	"fmt"
+	"runtime"
+	"unsafe"
+)
+
+// GeometryEncoding is the format of the geometries returned by ProcessGeometries
+// and ProcessWKB
+type GeometryEncoding int
+
+const (
+	// WKBEncoding encodes the geometries as little endian ISO WKB
+	WKBEncoding GeometryEncoding = iota
+	// WKTEncoding encodes the geometries as WKT
+	WKTEncoding
+	// GeoJSONEncoding encodes the geometries as GeoJSON, with the number of decimals
+	// set by SignificantDigits
+	GeoJSONEncoding
+)
+
+// GeometryBatch holds the encoded results of ProcessGeometries or ProcessWKB, laid
+// out in a single buffer.
+type GeometryBatch struct {
+	// Data holds the concatenated encoded geometries
+	Data []byte
+	// Offsets holds the Len()+1 boundaries of the geometries in Data
+	Offsets []int
+	// Errors is nil if all the geometries were processed successfully, or else holds
+	// the error of each failed geometry (nil for the ones that succeeded)
+	Errors []error
+}
+
+// Len returns the number of geometries in the batch
+func (b *GeometryBatch) Len() int {
+	return len(b.Offsets) - 1
+}
+
+// Geometry returns the encoded i-th geometry of the batch, or nil if the input
+// geometry was empty or failed to be processed
+func (b *GeometryBatch) Geometry(i int) []byte {
+	if b.Offsets[i] == b.Offsets[i+1] {
+		return nil
+	}
+	return b.Data[b.Offsets[i]:b.Offsets[i+1]]
+}
+
+// ProcessGeometries applies the BatchTransform, BatchSimplify and BatchBuffer
+// operations, in the order they are given, to each of the geometries and encodes the
+// results with the chosen BatchEncoding (WKB by default), in a single cgo call. The
+// input geometries are left untouched. nil entries produce empty results.
+//
+// The geometries are processed in parallel by the number of threads set with Workers,
+// runtime.NumCPU() by default. The geometries must not be used concurrently while
+// ProcessGeometries is running.
+//
+// Each failed geometry has its error set in the returned batch's Errors. Unless an
+// ErrLogger is given, these errors are also combined in the returned error.
+func ProcessGeometries(geoms []*Geometry, opts ...GeometryBatchOption) (*GeometryBatch, error) {
+	handles := make([]C.OGRGeometryH, len(geoms))
+	for i, g := range geoms {
+		if g != nil {
+			handles[i] = g.handle
+		}
+	}
+	if len(handles) == 0 {
+		return &GeometryBatch{Offsets: []int{0}}, nil
+	}
+	return processGeometries(len(geoms), &handles[0], 0, 0, opts)
+}
+
+// ProcessWKB is the same as ProcessGeometries for input geometries given as WKB,
+// encoded one after the other in wkb. offsets holds the n+1 boundaries of the n
+// geometries in wkb, as in FeatureBatch.GeometryOffsets. Empty geometries produce
+// empty results.
+func ProcessWKB(wkb []byte, offsets []int, opts ...GeometryBatchOption) (*GeometryBatch, error) {
+	if len(offsets) <= 1 {
+		return &GeometryBatch{Offsets: []int{0}}, nil
+	}
+	coffsets, err := checkOffsets(offsets, len(offsets), len(wkb))
+	if err != nil {
+		return nil, err
+	}
+	batch, err := processGeometries(len(offsets)-1, nil, cAddress(wkb), cAddress(coffsets), opts)
+	runtime.KeepAlive(wkb)
+	runtime.KeepAlive(coffsets)
+	return batch, err
+}
+
+func processGeometries(n int, geoms *C.OGRGeometryH, wkb, wkbOffsets C.uintptr_t, opts []GeometryBatchOption) (*GeometryBatch, error) {
+	gbo := geometryBatchOpts{
+		precision: 7,
+		workers:   runtime.NumCPU(),
+	}
+	for _, o := range opts {
+		o.setGeometryBatchOpt(&gbo)
+	}
+	var encoding C.godalGeometryEncoding
+	switch gbo.encoding {
+	case WKBEncoding:
+		encoding = C.godalEncodeWKB
+	case WKTEncoding:
+		encoding = C.godalEncodeWKT
+	case GeoJSONEncoding:
+		encoding = C.godalEncodeGeoJSON
+	default:
+		return nil, fmt.Errorf("invalid geometry encoding %d", gbo.encoding)
+	}
+	cops := make([]C.godalGeometryOp, len(gbo.ops)+1) //+1 so that &cops[0] is always valid
+	for i, op := range gbo.ops {
+		switch {
+		case op.trn != nil:
+			cops[i].op = C.godalGeomTransform
+			cops[i].trn = op.trn.handle
+		case op.buffer:
+			cops[i].op = C.godalGeomBuffer
+			cops[i].distance = C.double(op.distance)
+			cops[i].segments = C.int(op.segments)
+		default:
+			cops[i].op = C.godalGeomSimplify
+			cops[i].distance = C.double(op.distance)
+		}
+	}
+	if gbo.workers < 1 {
+		gbo.workers = 1
+	}
+
+	cgc := createCGOContext(nil, gbo.errorHandler)
+	cbatch := C.godalProcessGeometries(cgc.cPointer(), C.int(n), geoms, wkb, wkbOffsets,
+		C.int(len(gbo.ops)), &cops[0], encoding, C.int(gbo.precision), C.int(gbo.workers))
+	runtime.KeepAlive(gbo.ops)
+	err := cgc.close()
+	defer C.godalFreeGeometryBatch(cbatch)
+
+	batch := &GeometryBatch{
+		Offsets: cOffsets(cbatch.offsets, n+1),
+	}
+	if size := batch.Offsets[n]; size > 0 {
+		batch.Data = C.GoBytes(unsafe.Pointer(cbatch.data), C.int(size))
+	}
+	errMessages := (*[1 << 28]*C.char)(unsafe.Pointer(cbatch.errMessages))[:n:n]
+	failed := (*[1 << 28]C.int)(unsafe.Pointer(cbatch.failed))[:n:n]
+	for i := 0; i < n; i++ {
+		var gerr error
+		switch {
+		case errMessages[i] != nil:
+			gerr = errors.New(C.GoString(errMessages[i]))
+			C.free(unsafe.Pointer(errMessages[i]))
+			if gbo.errorHandler == nil {
+				err = combine(err, fmt.Errorf("geometry %d: %w", i, gerr))
+			}
+		case failed[i] != 0:
+			//the error has been returned by the ErrorHandler, and is already in err
+			gerr = fmt.Errorf("geometry %d failed", i)
+		default:
+			continue
+		}
+		if batch.Errors == nil {
+			batch.Errors = make([]error, n)
+		}
+		batch.Errors[i] = gerr
+	}
+	return batch, err
+}
@@ -24,21 +24,77 @@
 #include <gdal_frmts.h>
 #include <ogrsf_frmts.h>
 #include <dlfcn.h>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <gdal_utils.h>
 #include <gdal_alg.h>
+#include <gdalwarper.h>
 
 extern "C" {
-	extern long long int _gogdalSizeCallback(char* key, char** errorString);
-	extern int _gogdalMultiReadCallback(char* key, int nRanges, void* pocbuffers, void* coffsets, void* clengths, char** errorString);
-	extern size_t _gogdalReadCallback(char* key, void* buffer, size_t off, size_t clen, char** errorString);
+	extern long long int _gogdalSizeCallback(int handlerID, char* key, char** errorString);
+	extern int _gogdalOpenCallback(int handlerID, char* key, void* buffer, size_t clen, size_t* nread, long long int* size, int* extents, char** errorString);
+	extern void _gogdalCloseCallback(int readerID);
+	extern int _gogdalMultiReadCallback(int readerID, int nRanges, void* pocbuffers, void* coffsets, void* clengths, char** errorString);
+	extern size_t _gogdalReadCallback(int readerID, void* buffer, size_t off, size_t clen, char** errorString);
+	extern long long int _gogdalOpenWriterCallback(int handlerID, char* key, char** errorString);
+	extern int _gogdalWriteCallback(long long int writerID, void* buffer, size_t clen, char** errorString);
+	extern int _gogdalCloseWriterCallback(long long int writerID, char** errorString);
+	extern void* _gogdalExtentsCallback(int readerID, int* nExtents, char** errorString);
 	extern int goErrorHandler(int loggerID, CPLErr lvl, int code, const char *msg);
+	extern int goProgressCallback(int progressID, double dfComplete, const char *msg);
 }
 
+/* godalCall is a godal call running on the current thread, wrapped by godalWrap */
+struct godalCall {
+	cctx *ctx;
+	bool pushed; //whether godalWrap pushed the error handler for the duration of the call
+	const char *function; //set when the call is instrumented
+	std::chrono::steady_clock::time_point start;
+	long long wrapNs;
+};
+
+/* godalContexts holds the contexts of the godal calls running on the current thread,
+   innermost last. Calls can be nested when a go callback (e.g. a VSI handler) itself
+   calls into godal */
+static thread_local std::vector<godalCall> godalContexts;
+
+/* instrumentation of the calls, enabled with godalSetInstrumentation. The stats are
+   indexed by the __func__ of the calls to godalWrap */
+static std::atomic<bool> godalInstrumented(false);
+static std::mutex godalCallStatsMutex;
+static std::unordered_map<const char *, godalCallStat> godalCallStats;
+/* godalErrorHandlerInstalled is set once godalErrorHandler has been permanently pushed
+   onto the error handler stack of the current thread */
+static thread_local bool godalErrorHandlerInstalled = false;
+/* godalErrorHandlerTag is the user data of the handlers pushed by godalWrap, used to
+   check whether godalErrorHandler is already at the top of the error handler stack */
+static int godalErrorHandlerTag;
+
 static void godalErrorHandler(CPLErr e, CPLErrorNum n, const char* msg) {
-	cctx *ctx = (cctx*)CPLGetErrorHandlerUserData();
-	assert(ctx!=nullptr);
+	if (godalContexts.empty()) {
+		//outside of a godal call on a thread where the handler was installed
+		CPLDefaultErrorHandler(e, n, msg);
+		return;
+	}
+	cctx *ctx = godalContexts.back().ctx;
 	if (ctx->handlerIdx !=0) {
 		int ret = goErrorHandler(ctx->handlerIdx, e, n, msg);
 		if(ret!=0 && ctx->failed==0) {
@@ -65,35 +121,87 @@ static void godalErrorHandler(CPLErr e, CPLErrorNum n, const char* msg) {
 	}
 }
 
-static void godalWrap(cctx *ctx) {
-	CPLPushErrorHandlerEx(&godalErrorHandler,ctx);
+/* godalWrap makes ctx the target of the errors emitted by gdal on the current thread, and
+   sets ctx's config options. The error handler is installed once per thread: it is only
+   pushed for the duration of the call if another handler was pushed on top of it, or if
+   the call is nested inside a call that does not belong to godal.*/
+static void godalWrapCall(cctx *ctx, const char *function) {
+	std::chrono::steady_clock::time_point start;
+	bool instrumented = godalInstrumented.load(std::memory_order_relaxed);
+	if (instrumented) {
+		start = std::chrono::steady_clock::now();
+	}
+	bool pushed = false;
+	if (CPLGetErrorHandlerUserData() != &godalErrorHandlerTag) {
+		CPLPushErrorHandlerEx(&godalErrorHandler, &godalErrorHandlerTag);
+		if (!godalErrorHandlerInstalled && godalContexts.empty()) {
+			godalErrorHandlerInstalled = true;
+		} else {
+			pushed = true;
+		}
+	}
+	godalContexts.push_back(godalCall{ctx, pushed, nullptr, start, 0});
 	if(ctx->configOptions!=nullptr) {
-		char **options = ctx->configOptions;
-		for(char* option=*options; option; option=*(++options)) {
-			char *idx = strchr(option,'=');
-			if(idx) {
-				*idx='\0';
-				CPLSetThreadLocalConfigOption(option,idx+1);
-				*idx='=';
-			}
+		for(char **option=ctx->configOptions; *option; option+=2) {
+			CPLSetThreadLocalConfigOption(option[0],option[1]);
 		}
 	}
+	if (instrumented) {
+		godalCall &call = godalContexts.back();
+		call.function = function;
+		call.start = std::chrono::steady_clock::now();
+		call.wrapNs = std::chrono::duration_cast<std::chrono::nanoseconds>(call.start - start).count();
+	}
 }
+#define godalWrap(ctx) godalWrapCall(ctx, __func__)
 
 static void godalUnwrap() {
-	cctx *ctx = (cctx*)CPLGetErrorHandlerUserData();
-	CPLPopErrorHandler();
-	if(ctx->configOptions!=nullptr) {
-		char **options = ctx->configOptions;
-		for(char* option=*options; option; option=*(++options)) {
-			char *idx = strchr(option,'=');
-			if(idx) {
-				*idx='\0';
-				CPLSetThreadLocalConfigOption(option,nullptr);
-				*idx='=';
-			}
+	std::chrono::steady_clock::time_point end;
+	godalCall call = godalContexts.back();
+	if (call.function != nullptr) {
+		end = std::chrono::steady_clock::now();
+	}
+	if (call.pushed) {
+		CPLPopErrorHandler();
+	}
+	godalContexts.pop_back();
+	if(call.ctx->configOptions!=nullptr) {
+		for(char **option=call.ctx->configOptions; *option; option+=2) {
+			CPLSetThreadLocalConfigOption(option[0],nullptr);
 		}
 	}
+	if (call.function != nullptr) {
+		std::chrono::steady_clock::time_point done = std::chrono::steady_clock::now();
+		std::lock_guard<std::mutex> lock(godalCallStatsMutex);
+		godalCallStat &stat = godalCallStats[call.function];
+		stat.function = call.function;
+		stat.calls++;
+		stat.wrapNs += call.wrapNs + std::chrono::duration_cast<std::chrono::nanoseconds>(done - end).count();
+		stat.bodyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(end - call.start).count();
+	}
+}
+
+void godalSetInstrumentation(int enabled) {
+	godalInstrumented = (enabled != 0);
+}
+
+void godalResetInstrumentation() {
+	std::lock_guard<std::mutex> lock(godalCallStatsMutex);
+	godalCallStats.clear();
+}
+
+int godalInstrumentationStats(godalCallStat **stats) {
+	std::lock_guard<std::mutex> lock(godalCallStatsMutex);
+	*stats = nullptr;
+	if (godalCallStats.empty()) {
+		return 0;
+	}
+	*stats = (godalCallStat *)malloc(godalCallStats.size() * sizeof(godalCallStat));
+	int n = 0;
+	for (const auto &it : godalCallStats) {
+		(*stats)[n++] = it.second;
+	}
+	return n;
 }
 
 inline int failed(cctx *ctx) {
@@ -119,6 +227,19 @@ inline void forceOGRError(cctx *ctx, OGRErr err) {
 	}
 }
 
+static int CPL_STDCALL godalProgress(double dfComplete, const char *pszMessage, void *pProgressArg) {
+	return goProgressCallback((int)(intptr_t)pProgressArg, dfComplete, pszMessage);
+}
+
+/* godalProgressFunc and godalProgressArg return the pfnProgress,pProgressData pair to pass
+   to gdal so that its progress is reported to the go callback of ctx, if any */
+inline GDALProgressFunc godalProgressFunc(cctx *ctx) {
+	return ctx->progressIdx != 0 ? godalProgress : nullptr;
+}
+inline void *godalProgressArg(cctx *ctx) {
+	return (void *)(intptr_t)ctx->progressIdx;
+}
+
 void godalSetMetadataItem(cctx *ctx, GDALMajorObjectH mo, char *ckey, char *cval, char *cdom) {
 	godalWrap(ctx);
 	CPLErr ret = GDALSetMetadataItem(mo,ckey,cval,cdom);
@@ -278,6 +399,196 @@ OGRCoordinateTransformationH godalNewCoordinateTransformation(cctx *ctx, OGRSpat
 	return tr;
 }
 
+int godalTransformEx(OGRCoordinateTransformationH trn, long long nPoints, double *x, double *y, double *z,
+					 unsigned char *successful, int nThreads) {
+	//points are transformed by chunks, so that success flags can be converted with a bounded buffer
+	const long long chunkSize = 16384;
+	long long nChunks = (nPoints + chunkSize - 1) / chunkSize;
+	if (nThreads > nChunks) {
+		nThreads = (int)nChunks;
+	}
+	/* coordinate transformations cannot be used concurrently, so each additional thread
+	   transforms with its own copy of the transformation */
+	std::vector<OGRCoordinateTransformationH> trns(1, trn);
+#if GDAL_VERSION_NUM >= GDAL_COMPUTE_VERSION(3, 1, 0)
+	for (int t = 1; t < nThreads; t++) {
+		OGRCoordinateTransformationH clone = OCTClone(trn);
+		if (clone == nullptr) {
+			break;
+		}
+		trns.push_back(clone);
+	}
+#endif
+	std::atomic<long long> next(0);
+	std::atomic<int> ok(1);
+	auto worker = [&](OGRCoordinateTransformationH wtrn) {
+		std::vector<int> success;
+		if (successful != nullptr) {
+			success.resize(chunkSize);
+		}
+		for (long long c = next++; c < nChunks; c = next++) {
+			long long off = c * chunkSize;
+			int n = (int)std::min(chunkSize, nPoints - off);
+			int *pSuccess = successful != nullptr ? success.data() : nullptr;
+			if (!OCTTransformEx(wtrn, n, x + off, y + off, z != nullptr ? z + off : nullptr, pSuccess)) {
+				ok = 0;
+			}
+			if (successful != nullptr) {
+				for (int i = 0; i < n; i++) {
+					successful[off + i] = success[i] ? 1 : 0;
+				}
+			}
+		}
+	};
+	std::vector<std::thread> threads;
+	for (size_t t = 1; t < trns.size(); t++) {
+		threads.emplace_back(worker, trns[t]);
+	}
+	worker(trn);
+	for (std::thread &t : threads) {
+		t.join();
+	}
+	for (size_t t = 1; t < trns.size(); t++) {
+		OCTDestroyCoordinateTransformation(trns[t]);
+	}
+	return ok;
+}
+
+/* process wide cache of the spatial references created by godalCachedSpatialRef, keyed by
+   "EPSG:<code>" or by WKT. The cached objects are never handed out nor modified, callers get
+   clones that are made under the lock as spatial references are not safe for concurrent use */
+static std::mutex godalSRSCacheMutex;
+static std::unordered_map<std::string, OGRSpatialReferenceH> godalSRSCache;
+
+OGRSpatialReferenceH godalCachedSpatialRef(cctx *ctx, int epsgCode, char *wkt) {
+	std::string key = epsgCode != 0 ? "EPSG:" + std::to_string(epsgCode) : std::string(wkt);
+	std::lock_guard<std::mutex> lock(godalSRSCacheMutex);
+	auto it = godalSRSCache.find(key);
+	if (it != godalSRSCache.end()) {
+		return OSRClone(it->second);
+	}
+	OGRSpatialReferenceH sr = epsgCode != 0 ? godalCreateEPSGSpatialRef(ctx, epsgCode) : godalCreateWKTSpatialRef(ctx, wkt);
+	if (sr == nullptr) {
+		return nullptr;
+	}
+	godalSRSCache[key] = sr;
+	return OSRClone(sr);
+}
+
+/* godalSharedTransform is a process wide cached transformation. Each thread transforms with
+   its own instance, created from the master on first use */
+struct godalSharedTransform {
+	OGRSpatialReferenceH src, dst;
+	OGRCoordinateTransformationH master;
+};
+static std::mutex godalTransformCacheMutex;
+static std::unordered_map<std::string, godalSharedTransform *> godalTransformCache;
+
+/* godalThreadTransforms holds the calling thread's instances of the shared transforms, which
+   are released when the thread exits. Shared transforms are never destroyed */
+struct godalThreadTransform {
+	OGRCoordinateTransformationH trn;
+	OGRSpatialReferenceH dst; // thread local copy of the target srs, cloned for each transformed geometry
+};
+struct godalThreadTransforms {
+	std::unordered_map<const godalSharedTransform *, godalThreadTransform> instances;
+	~godalThreadTransforms() {
+		for (auto &it : instances) {
+			OCTDestroyCoordinateTransformation(it.second.trn);
+			OSRRelease(it.second.dst);
+		}
+	}
+};
+static thread_local godalThreadTransforms godalThreadTransformInstances;
+
+/* godalSRSKey returns a key identifying the definition and axis mapping of sr */
+static std::string godalSRSKey(OGRSpatialReferenceH sr) {
+	char *wkt = nullptr;
+	OSRExportToWkt(sr, &wkt);
+	std::string key = wkt != nullptr ? wkt : "";
+	CPLFree(wkt);
+	int nMapping = 0;
+	const int *mapping = OSRGetDataAxisToSRSAxisMapping(sr, &nMapping);
+	for (int i = 0; i < nMapping; i++) {
+		key += "," + std::to_string(mapping[i]);
+	}
+	return key;
+}
+
+godalSharedTransformH godalCachedTransform(cctx *ctx, OGRSpatialReferenceH src, OGRSpatialReferenceH dst) {
+	if (src == nullptr || dst == nullptr) {
+		godalWrap(ctx);
+		CPLError(CE_Failure, CPLE_AppDefined, "invalid spatial reference");
+		godalUnwrap();
+		return nullptr;
+	}
+	std::string key = godalSRSKey(src) + "\n" + godalSRSKey(dst);
+	std::lock_guard<std::mutex> lock(godalTransformCacheMutex);
+	auto it = godalTransformCache.find(key);
+	if (it != godalTransformCache.end()) {
+		return it->second;
+	}
+	OGRCoordinateTransformationH master = godalNewCoordinateTransformation(ctx, src, dst);
+	if (master == nullptr) {
+		return nullptr;
+	}
+	godalSharedTransform *trn = new godalSharedTransform;
+	trn->src = OSRClone(src);
+	trn->dst = OSRClone(dst);
+	trn->master = master;
+	godalTransformCache[key] = trn;
+	return trn;
+}
+
+static const godalThreadTransform *godalThreadInstance(cctx *ctx, const godalSharedTransform *trn) {
+	auto &instances = godalThreadTransformInstances.instances;
+	auto it = instances.find(trn);
+	if (it != instances.end()) {
+		return &it->second;
+	}
+	godalThreadTransform instance;
+	{
+		std::lock_guard<std::mutex> lock(godalTransformCacheMutex);
+#if GDAL_VERSION_NUM >= GDAL_COMPUTE_VERSION(3, 1, 0)
+		godalWrap(ctx);
+		instance.trn = OCTClone(trn->master);
+		if (instance.trn == nullptr) {
+			forceError(ctx);
+		}
+		godalUnwrap();
+#else
+		instance.trn = godalNewCoordinateTransformation(ctx, trn->src, trn->dst);
+#endif
+		if (instance.trn == nullptr) {
+			return nullptr;
+		}
+		instance.dst = OSRClone(trn->dst);
+	}
+	return &(instances[trn] = instance);
+}
+
+OGRCoordinateTransformationH godalSharedTransformHandle(cctx *ctx, godalSharedTransformH htrn) {
+	const godalThreadTransform *instance = godalThreadInstance(ctx, (const godalSharedTransform *)htrn);
+	return instance != nullptr ? instance->trn : nullptr;
+}
+
+void godalSharedTransformGeometry(cctx *ctx, OGRGeometryH geom, godalSharedTransformH htrn) {
+	const godalThreadTransform *instance = godalThreadInstance(ctx, (const godalSharedTransform *)htrn);
+	if (instance == nullptr) {
+		return;
+	}
+	godalWrap(ctx);
+	OGRErr gret = OGR_G_Transform(geom, instance->trn);
+	if (gret != 0) {
+		forceOGRError(ctx, gret);
+	}
+	//each geometry gets its own copy of the srs, which callers are free to modify
+	OGRSpatialReferenceH dst = OSRClone(instance->dst);
+	OGR_G_AssignSpatialReference(geom, dst);
+	OSRRelease(dst);
+	godalUnwrap();
+}
+
 void godalSetGeoTransform(cctx *ctx, GDALDatasetH ds, double *gt){
 	godalWrap(ctx);
 	CPLErr ret = GDALSetGeoTransform(ds,gt);
@@ -422,6 +733,7 @@ GDALDatasetH godalTranslate(cctx *ctx, char *dstName, GDALDatasetH ds, char **sw
 		godalUnwrap();
 		return nullptr;
 	}
+	GDALTranslateOptionsSetProgress(translateopts,godalProgressFunc(ctx),godalProgressArg(ctx));
 	int usageErr=0;
 	GDALDatasetH ret = GDALTranslate(dstName, ds, translateopts, &usageErr);
 	GDALTranslateOptionsFree(translateopts);
@@ -440,6 +752,7 @@ GDALDatasetH godalDatasetWarp(cctx *ctx, char *dstName, int nSrcCount, GDALDatas
 		godalUnwrap();
 		return nullptr;
 	}
+	GDALWarpAppOptionsSetProgress(warpopts,godalProgressFunc(ctx),godalProgressArg(ctx));
 	int usageErr=0;
 	GDALDatasetH ret = GDALWarp(dstName, nullptr, nSrcCount, srcDS, warpopts, &usageErr);
 	GDALWarpAppOptionsFree(warpopts);
@@ -458,6 +771,7 @@ void godalDatasetWarpInto(cctx *ctx, GDALDatasetH dstDs,  int nSrcCount, GDALDat
 		godalUnwrap();
 		return;
 	}
+	GDALWarpAppOptionsSetProgress(warpopts,godalProgressFunc(ctx),godalProgressArg(ctx));
 	int usageErr=0;
 	GDALDatasetH ret = GDALWarp(nullptr, dstDs, nSrcCount, srcDS, warpopts, &usageErr);
 	GDALWarpAppOptionsFree(warpopts);
@@ -467,6 +781,169 @@ void godalDatasetWarpInto(cctx *ctx, GDALDatasetH dstDs,  int nSrcCount, GDALDat
 	godalUnwrap();
 }
 
+/* godalWarper holds one warp setup per source dataset, whose transformer only needs its
+   destination geotransform to be updated to warp into a new destination */
+struct godalWarper {
+	std::vector<GDALWarpOptions *> options;
+	std::vector<void *> genImgProj; /* owned by the transformer of options[i] */
+	std::string dstWKT;
+};
+
+void godalDestroyWarper(godalWarperH hWarper) {
+	godalWarper *warper = (godalWarper *)hWarper;
+	for (GDALWarpOptions *psWO : warper->options) {
+		if (psWO->pTransformerArg != nullptr) {
+			GDALDestroyTransformer(psWO->pTransformerArg);
+			psWO->pTransformerArg = nullptr;
+		}
+		GDALDestroyWarpOptions(psWO);
+	}
+	delete warper;
+}
+
+godalWarperH godalCreateWarper(cctx *ctx, int nSrcCount, GDALDatasetH *srcDS, OGRSpatialReferenceH dstSRS, GDALResampleAlg alg,
+							   double errorThreshold, double memoryLimit, int nThreads) {
+	godalWrap(ctx);
+	godalWarper *warper = new godalWarper;
+	if (dstSRS != nullptr) {
+		char *wkt = nullptr;
+		if (OSRExportToWkt(dstSRS, &wkt) != OGRERR_NONE) {
+			CPLError(CE_Failure, CPLE_AppDefined, "failed to export destination srs");
+		} else {
+			warper->dstWKT = wkt;
+		}
+		CPLFree(wkt);
+	}
+	char **papszTO = nullptr;
+	if (!warper->dstWKT.empty()) {
+		papszTO = CSLSetNameValue(papszTO, "DST_SRS", warper->dstWKT.c_str());
+	}
+	int nBands = nSrcCount > 0 ? GDALGetRasterCount(srcDS[0]) : 0;
+	for (int i = 0; i < nSrcCount && !failed(ctx); i++) {
+		if (GDALGetRasterCount(srcDS[i]) != nBands) {
+			CPLError(CE_Failure, CPLE_AppDefined, "source %d has %d bands, expected %d", i, GDALGetRasterCount(srcDS[i]), nBands);
+			break;
+		}
+		void *hTransformArg = GDALCreateGenImgProjTransformer2(srcDS[i], nullptr, papszTO);
+		if (hTransformArg == nullptr) {
+			forceError(ctx);
+			break;
+		}
+		GDALWarpOptions *psWO = GDALCreateWarpOptions();
+		warper->options.push_back(psWO);
+		warper->genImgProj.push_back(hTransformArg);
+		psWO->pfnTransformer = GDALGenImgProjTransform;
+		psWO->pTransformerArg = hTransformArg;
+		if (errorThreshold > 0) {
+			psWO->pTransformerArg = GDALCreateApproxTransformer(GDALGenImgProjTransform, hTransformArg, errorThreshold);
+			GDALApproxTransformerOwnsSubtransformer(psWO->pTransformerArg, TRUE);
+			psWO->pfnTransformer = GDALApproxTransform;
+		}
+		psWO->hSrcDS = srcDS[i];
+		psWO->eResampleAlg = alg;
+		if (memoryLimit > 0) {
+			psWO->dfWarpMemoryLimit = memoryLimit;
+		}
+		if (nThreads != 0) {
+			psWO->papszWarpOptions = CSLSetNameValue(psWO->papszWarpOptions, "NUM_THREADS",
+													 nThreads > 0 ? CPLSPrintf("%d", nThreads) : "ALL_CPUS");
+		}
+		if (i == 0) {
+			/* later sources are warped over the first one */
+			psWO->papszWarpOptions = CSLSetNameValue(psWO->papszWarpOptions, "INIT_DEST", "NO_DATA");
+		}
+		psWO->nBandCount = nBands;
+		psWO->panSrcBands = (int *)CPLMalloc(nBands * sizeof(int));
+		psWO->panDstBands = (int *)CPLMalloc(nBands * sizeof(int));
+		bool hasNoData = false;
+		for (int b = 0; b < nBands; b++) {
+			psWO->panSrcBands[b] = psWO->panDstBands[b] = b + 1;
+			int set = 0;
+			GDALGetRasterNoDataValue(GDALGetRasterBand(srcDS[i], b + 1), &set);
+			hasNoData = hasNoData || set;
+		}
+		if (hasNoData) {
+			psWO->padfSrcNoDataReal = (double *)CPLMalloc(nBands * sizeof(double));
+			psWO->padfSrcNoDataImag = (double *)CPLCalloc(nBands, sizeof(double));
+			for (int b = 0; b < nBands; b++) {
+				psWO->padfSrcNoDataReal[b] = GDALGetRasterNoDataValue(GDALGetRasterBand(srcDS[i], b + 1), nullptr);
+			}
+		}
+	}
+	CSLDestroy(papszTO);
+	if (nSrcCount == 0) {
+		CPLError(CE_Failure, CPLE_AppDefined, "no source datasets");
+	}
+	if (failed(ctx)) {
+		godalDestroyWarper(warper);
+		warper = nullptr;
+	}
+	godalUnwrap();
+	return warper;
+}
+
+void godalWarperWarp(cctx *ctx, godalWarperH hWarper, GDALDatasetH dstDS, double *gt) {
+	godalWrap(ctx);
+	godalWarper *warper = (godalWarper *)hWarper;
+	int nBands = warper->options[0]->nBandCount;
+	if (GDALGetRasterCount(dstDS) != nBands) {
+		CPLError(CE_Failure, CPLE_AppDefined, "destination has %d bands, expected %d", GDALGetRasterCount(dstDS), nBands);
+		godalUnwrap();
+		return;
+	}
+	if (GDALSetGeoTransform(dstDS, gt) != CE_None) {
+		forceError(ctx);
+		godalUnwrap();
+		return;
+	}
+	const char *dstWKT = GDALGetProjectionRef(dstDS);
+	if ((dstWKT == nullptr || dstWKT[0] == 0) && !warper->dstWKT.empty()) {
+		GDALSetProjection(dstDS, warper->dstWKT.c_str());
+	}
+	std::vector<double> dstNoData(nBands);
+	bool hasDstNoData = false;
+	for (int b = 0; b < nBands; b++) {
+		int set = 0;
+		dstNoData[b] = GDALGetRasterNoDataValue(GDALGetRasterBand(dstDS, b + 1), &set);
+		hasDstNoData = hasDstNoData || set;
+	}
+	std::vector<double> dstNoDataImag(nBands, 0);
+	int nXSize = GDALGetRasterXSize(dstDS), nYSize = GDALGetRasterYSize(dstDS);
+	int nSrc = (int)warper->options.size();
+	for (int i = 0; i < nSrc && !failed(ctx); i++) {
+		GDALWarpOptions *psWO = warper->options[i];
+		GDALSetGenImgProjTransformerDstGeoTransform(warper->genImgProj[i], gt);
+		psWO->hDstDS = dstDS;
+		/* the warp operation works on a copy of the options, so they can point to our buffers */
+		psWO->padfDstNoDataReal = hasDstNoData ? dstNoData.data() : nullptr;
+		psWO->padfDstNoDataImag = hasDstNoData ? dstNoDataImag.data() : nullptr;
+		void *pScaledProgress = nullptr;
+		if (godalProgressFunc(ctx) != nullptr) {
+			pScaledProgress = GDALCreateScaledProgress(double(i) / nSrc, double(i + 1) / nSrc, godalProgressFunc(ctx), godalProgressArg(ctx));
+			psWO->pfnProgress = GDALScaledProgress;
+			psWO->pProgressArg = pScaledProgress;
+		}
+		GDALWarpOperationH hOperation = GDALCreateWarpOperation(psWO);
+		psWO->hDstDS = nullptr;
+		psWO->padfDstNoDataReal = psWO->padfDstNoDataImag = nullptr;
+		psWO->pfnProgress = GDALDummyProgress;
+		psWO->pProgressArg = nullptr;
+		if (hOperation == nullptr) {
+			forceError(ctx);
+		} else {
+			CPLErr ret = GDALChunkAndWarpImage(hOperation, 0, 0, nXSize, nYSize);
+			GDALDestroyWarpOperation(hOperation);
+			if (ret != CE_None) {
+				forceCPLError(ctx, ret);
+			}
+		}
+		if (pScaledProgress != nullptr) {
+			GDALDestroyScaledProgress(pScaledProgress);
+		}
+	}
+	godalUnwrap();
+}
+
 GDALDatasetH godalDatasetVectorTranslate(cctx *ctx, char *dstName, GDALDatasetH ds, char **switches) {
 	godalWrap(ctx);
 	GDALVectorTranslateOptions *opts = GDALVectorTranslateOptionsNew(switches,nullptr);
@@ -475,6 +952,7 @@ GDALDatasetH godalDatasetVectorTranslate(cctx *ctx, char *dstName, GDALDatasetH
 		godalUnwrap();
 		return nullptr;
 	}
+	GDALVectorTranslateOptionsSetProgress(opts,godalProgressFunc(ctx),godalProgressArg(ctx));
 	int usageErr=0;
 	GDALDatasetH ret = GDALVectorTranslate(dstName, nullptr, 1, &ds, opts, &usageErr);
 	GDALVectorTranslateOptionsFree(opts);
@@ -497,7 +975,7 @@ void godalClearOverviews(cctx *ctx, GDALDatasetH ds) {
 void godalBuildOverviews(cctx *ctx, GDALDatasetH ds, const char *resampling, int nLevels, int *levels,
 						  int nBands, int *bands) {
 	godalWrap(ctx);
-	CPLErr ret = GDALBuildOverviews(ds,resampling,nLevels,levels,nBands,bands,nullptr,nullptr);
+	CPLErr ret = GDALBuildOverviews(ds,resampling,nLevels,levels,nBands,bands,godalProgressFunc(ctx),godalProgressArg(ctx));
 	if(ret!=0){
 		forceCPLError(ctx,ret);
 	}
@@ -541,142 +1019,1338 @@ void godalBandRasterIO(cctx *ctx, GDALRasterBandH bnd, GDALRWFlag rw, int nDSXOf
 	godalUnwrap();
 }
 
-void godalDatasetRasterIO(cctx *ctx, GDALDatasetH ds, GDALRWFlag rw, int nDSXOff, int nDSYOff, int nDSXSize, int nDSYSize, void *pBuffer,
-		int nBXSize, int nBYSize, GDALDataType eBDataType, int nBandCount, int *panBandCount,
-		int nPixelSpace, int nLineSpace, int nBandSpace, GDALRIOResampleAlg alg) {
+/* godalReopenDataset returns up to n additional read-only handles on ds, for threads that
+   cannot share its handle. The handles are opened with the same driver, open options and
+   (thread local) config options as ds, and must be closed by the caller.
+   Datasets that are not opened read-only (whose other handles could miss unflushed
+   writes), or that cannot be reopened by name identically (e.g. MEM) get none, and must be
+   processed sequentially on ds. */
+static std::vector<GDALDatasetH> godalReopenDataset(GDALDatasetH ds, int n) {
+	std::vector<GDALDatasetH> handles;
+	if (n <= 0 || GDALGetAccess(ds) != GA_ReadOnly || GDALGetDatasetDriver(ds) == nullptr) {
+		return handles;
+	}
+	const char *name = GDALGetDescription(ds);
+	if (name == nullptr || *name == 0) {
+		return handles;
+	}
+	const char *drivers[2] = {GDALGetDriverShortName(GDALGetDatasetDriver(ds)), nullptr};
+	char **openOptions = GDALDataset::FromHandle(ds)->GetOpenOptions();
+	//the files found when ds was opened are the only siblings that need to be probed again
+	char **fileList = GDALGetFileList(ds);
+	char **siblings = nullptr;
+	for (char **f = fileList; f != nullptr && *f != nullptr; f++) {
+		siblings = CSLAddString(siblings, CPLGetFilename(*f));
+	}
+	CSLDestroy(fileList);
+	CPLPushErrorHandler(CPLQuietErrorHandler);
+	for (int t = 0; t < n; t++) {
+		GDALDatasetH h = GDALOpenEx(name, GDAL_OF_RASTER | GDAL_OF_READONLY, drivers, openOptions, siblings);
+		if (h == nullptr) {
+			break;
+		}
+		bool same = GDALGetRasterCount(h) == GDALGetRasterCount(ds) && GDALGetRasterXSize(h) == GDALGetRasterXSize(ds) &&
+					GDALGetRasterYSize(h) == GDALGetRasterYSize(ds);
+		for (int b = 1; same && b <= GDALGetRasterCount(ds); b++) {
+			same = GDALGetRasterDataType(GDALGetRasterBand(h, b)) == GDALGetRasterDataType(GDALGetRasterBand(ds, b));
+		}
+		if (!same) {
+			GDALClose(h);
+			break;
+		}
+		handles.push_back(h);
+	}
+	CPLPopErrorHandler();
+	CSLDestroy(siblings);
+	return handles;
+}
+
+int godalReopen(cctx *ctx, GDALDatasetH ds, int n, GDALDatasetH *handles) {
 	godalWrap(ctx);
+	std::vector<GDALDatasetH> reopened = godalReopenDataset(ds, n);
+	std::copy(reopened.begin(), reopened.end(), handles);
+	godalUnwrap();
+	return (int)reopened.size();
+}
+
+/* godalIOWindowRun transfers a single window of a batch, recording its errors in the window */
+static void godalIOWindowRun(cctx *ctx, GDALRasterBandH bnd, GDALRWFlag rw, godalIOWindow *w, GDALRIOResampleAlg alg) {
+	cctx wctx;
+	wctx.errMessage = nullptr;
+	wctx.handlerIdx = ctx->handlerIdx;
+	wctx.failed = 0;
+	wctx.configOptions = ctx->configOptions;
+	godalWrapCall(&wctx, "godalBandRasterIOBatch");
 	GDALRasterIOExtraArg exargs;
 	INIT_RASTERIO_EXTRA_ARG(exargs);
 	if (alg != GRIORA_NearestNeighbour) {
 		exargs.eResampleAlg = alg;
 	}
-	CPLErr ret = GDALDatasetRasterIOEx(ds, rw, nDSXOff, nDSYOff, nDSXSize, nDSYSize, pBuffer, nBXSize, nBYSize,
-									 eBDataType, nBandCount, panBandCount, nPixelSpace, nLineSpace, nBandSpace, &exargs);
+	CPLErr ret = GDALRasterIOEx(bnd, rw, w->nDSXOff, w->nDSYOff, w->nDSXSize, w->nDSYSize, (void *)w->pBuffer, w->nBXSize, w->nBYSize,
+								w->eBDataType, w->nPixelSpace, w->nLineSpace, &exargs);
 	if(ret!=0){
-		forceCPLError(ctx,ret);
+		forceCPLError(&wctx,ret);
 	}
 	godalUnwrap();
+	w->errMessage = wctx.errMessage;
+	w->failed = failed(&wctx);
 }
 
-void godalFillRaster(cctx *ctx, GDALRasterBandH bnd, double real, double imag) {
-	godalWrap(ctx);
-	CPLErr ret = GDALFillRaster(bnd,real,imag);
-	if(ret!=0){
-		forceCPLError(ctx,ret);
+/* godalIOWindowOrder returns the order in which the windows of a read batch should be
+   processed: by increasing offset of their first block in the file if the driver
+   exposes it (i.e. GTiff), or by block row and column otherwise */
+static std::vector<int> godalIOWindowOrder(GDALRasterBandH bnd, int nWindows, const godalIOWindow *windows) {
+	int bsx, bsy;
+	GDALGetBlockSize(bnd, &bsx, &bsy);
+	int nBlocksX = (GDALGetRasterBandXSize(bnd) + bsx - 1) / bsx;
+	std::vector<std::pair<unsigned long long, int>> keys(nWindows);
+	bool offsets = true;
+	for (int i = 0; i < nWindows; i++) {
+		int bx = windows[i].nDSXOff / bsx, by = windows[i].nDSYOff / bsy;
+		const char *off = nullptr;
+		if (offsets) {
+			char name[64];
+			snprintf(name, sizeof(name), "BLOCK_OFFSET_%d_%d", bx, by);
+			off = GDALGetMetadataItem(bnd, name, "TIFF");
+			offsets = (off != nullptr);
+		}
+		keys[i].first = off ? strtoull(off, nullptr, 10) : (unsigned long long)by * nBlocksX + bx;
+		keys[i].second = i;
 	}
-	godalUnwrap();
-
+	if (!offsets) {
+		for (int i = 0; i < nWindows; i++) {
+			keys[i].first = (unsigned long long)(windows[i].nDSYOff / bsy) * nBlocksX + windows[i].nDSXOff / bsx;
+		}
+	}
+	std::stable_sort(keys.begin(), keys.end());
+	std::vector<int> order(nWindows);
+	for (int i = 0; i < nWindows; i++) {
+		order[i] = keys[i].second;
+	}
+	return order;
 }
 
-void godalPolygonize(cctx *ctx, GDALRasterBandH in, GDALRasterBandH mask, OGRLayerH layer,int fieldIndex, char **opts) {
+void godalBandRasterIOBatch(cctx *ctx, GDALRasterBandH bnd, GDALRWFlag rw, int nWindows, godalIOWindow *windows, GDALRIOResampleAlg alg, int nThreads) {
 	godalWrap(ctx);
-	if (fieldIndex >= OGR_FD_GetFieldCount(OGR_L_GetLayerDefn(layer))) {
-		CPLError(CE_Failure, CPLE_AppDefined, "invalid fieldIndex");
+	if (rw != GF_Read) {
+		//writes are applied in order, as windows may overlap
+		for (int i = 0; i < nWindows; i++) {
+			godalIOWindowRun(ctx, bnd, rw, &windows[i], alg);
+		}
 		godalUnwrap();
 		return;
 	}
-	CPLErr ret = GDALPolygonize(in,mask,layer,fieldIndex,opts,nullptr,nullptr);
-	if(ret!=0){
-		forceCPLError(ctx,ret);
+	std::vector<int> order = godalIOWindowOrder(bnd, nWindows, windows);
+
+	/* gdal handles cannot be used concurrently, so each additional thread reads from its
+	   own handle on the dataset */
+	std::vector<GDALDatasetH> handles;
+	GDALDatasetH ds = GDALGetBandDataset(bnd);
+	int iBand = GDALGetBandNumber(bnd);
+	if (nThreads > nWindows) {
+		nThreads = nWindows;
+	}
+	if (ds != nullptr && iBand > 0 && GDALGetRasterBand(ds, iBand) == bnd) {
+		handles = godalReopenDataset(ds, nThreads - 1);
+	}
+
+	std::atomic<int> next(0);
+	auto worker = [&](GDALRasterBandH wbnd) {
+		for (int i = next++; i < nWindows; i = next++) {
+			godalIOWindowRun(ctx, wbnd, rw, &windows[order[i]], alg);
+		}
+	};
+	std::vector<std::thread> threads;
+	for (GDALDatasetH h : handles) {
+		threads.emplace_back(worker, GDALGetRasterBand(h, iBand));
+	}
+	worker(bnd);
+	for (std::thread &t : threads) {
+		t.join();
+	}
+	for (GDALDatasetH h : handles) {
+		GDALClose(h);
 	}
 	godalUnwrap();
 }
 
-void godalSieveFilter(cctx *ctx, GDALRasterBandH bnd, GDALRasterBandH mask, GDALRasterBandH dst, int sizeThreshold, int connectedNess) {
+void godalDatasetRasterIO(cctx *ctx, GDALDatasetH ds, GDALRWFlag rw, int nDSXOff, int nDSYOff, int nDSXSize, int nDSYSize, void *pBuffer,
+		int nBXSize, int nBYSize, GDALDataType eBDataType, int nBandCount, int *panBandCount,
+		int nPixelSpace, int nLineSpace, int nBandSpace, GDALRIOResampleAlg alg) {
 	godalWrap(ctx);
-	CPLErr ret = GDALSieveFilter(bnd,mask,dst,sizeThreshold,connectedNess,nullptr,nullptr,nullptr);
+	GDALRasterIOExtraArg exargs;
+	INIT_RASTERIO_EXTRA_ARG(exargs);
+	if (alg != GRIORA_NearestNeighbour) {
+		exargs.eResampleAlg = alg;
+	}
+	CPLErr ret = GDALDatasetRasterIOEx(ds, rw, nDSXOff, nDSYOff, nDSXSize, nDSYSize, pBuffer, nBXSize, nBYSize,
+									 eBDataType, nBandCount, panBandCount, nPixelSpace, nLineSpace, nBandSpace, &exargs);
 	if(ret!=0){
 		forceCPLError(ctx,ret);
 	}
 	godalUnwrap();
 }
 
-void godalFillNoData(cctx *ctx, GDALRasterBandH in, GDALRasterBandH mask, int maxDistance, int iterations, char **opts) {
+void godalBandBlockIO(cctx *ctx, GDALRasterBandH bnd, GDALRWFlag rw, int nXBlockOff, int nYBlockOff, void *pBuffer) {
 	godalWrap(ctx);
-	CPLErr ret = GDALFillNodata(in,mask,maxDistance,0,iterations,opts,nullptr,nullptr);
+	CPLErr ret = (rw == GF_Read) ? GDALReadBlock(bnd, nXBlockOff, nYBlockOff, pBuffer) : GDALWriteBlock(bnd, nXBlockOff, nYBlockOff, pBuffer);
 	if(ret!=0){
 		forceCPLError(ctx,ret);
 	}
 	godalUnwrap();
 }
 
-GDALDatasetH godalRasterize(cctx *ctx, char *dstName, GDALDatasetH ds, char **switches) {
+/* godalBandLockBlock returns the locked block of the band's block cache, and its data in ppData.
+   The block must be released with godalUnlockBlock */
+void *godalBandLockBlock(cctx *ctx, GDALRasterBandH bnd, int nXBlockOff, int nYBlockOff, void **ppData) {
 	godalWrap(ctx);
-	GDALRasterizeOptions *ropts = GDALRasterizeOptionsNew(switches,nullptr);
-	if(failed(ctx)) {
-		GDALRasterizeOptionsFree(ropts);
-		godalUnwrap();
-		return nullptr;
-	}
-	int usageErr=0;
-	GDALDatasetH ret = GDALRasterize(dstName, nullptr, ds, ropts, &usageErr);
-	GDALRasterizeOptionsFree(ropts);
-	if(ret==nullptr || usageErr!=0) {
+	GDALRasterBlock *block = GDALRasterBand::FromHandle(bnd)->GetLockedBlockRef(nXBlockOff, nYBlockOff);
+	if (block == nullptr) {
 		forceError(ctx);
+	} else {
+		*ppData = block->GetDataRef();
 	}
 	godalUnwrap();
-	return ret;
+	return block;
 }
 
-void godalRasterizeGeometry(cctx *ctx, GDALDatasetH ds, OGRGeometryH geom, int *bands, int nBands, double *vals, int allTouched) {
-	const char *opts[2] = { "ALL_TOUCHED=TRUE",nullptr };
-	char **copts=(char**)opts;
-	if (!allTouched) {
-		copts=nullptr;
+void godalUnlockBlock(void *block, int dirty) {
+	GDALRasterBlock *poBlock = (GDALRasterBlock *)block;
+	if (dirty) {
+		poBlock->MarkDirty();
+	}
+	poBlock->DropLock();
+}
+
+static bool godalIsGTiffBand(GDALRasterBandH bnd) {
+	GDALDatasetH ds = GDALGetBandDataset(bnd);
+	if (ds == nullptr || GDALGetDatasetDriver(ds) == nullptr || !EQUAL(GDALGetDriverShortName(GDALGetDatasetDriver(ds)), "GTiff")) {
+		CPLError(CE_Failure, CPLE_NotSupported, "raw tiles are only available for GTiff datasets");
+		return false;
 	}
+	return true;
+}
+
+/* godalBandRawTiles fills offsets and sizes with the location of the compressed tiles (or strips)
+   of the nXBlocks*nYBlocks blocks starting at block nXBlockOff,nYBlockOff, in row major order.
+   Blocks that have not been written are returned with a 0 offset and size */
+void godalBandRawTiles(cctx *ctx, GDALRasterBandH bnd, int nXBlockOff, int nYBlockOff, int nXBlocks, int nYBlocks, long long *offsets, long long *sizes) {
 	godalWrap(ctx);
-	CPLErr ret = GDALRasterizeGeometries(ds,nBands,bands,1,&geom,nullptr,nullptr,vals,copts,nullptr,nullptr);
-	if(ret!=0){
-		forceCPLError(ctx,ret);
+	if (godalIsGTiffBand(bnd)) {
+		char name[64];
+		for (int y = 0; y < nYBlocks; y++) {
+			for (int x = 0; x < nXBlocks; x++) {
+				int i = y * nXBlocks + x;
+				snprintf(name, sizeof(name), "BLOCK_OFFSET_%d_%d", nXBlockOff + x, nYBlockOff + y);
+				const char *off = GDALGetMetadataItem(bnd, name, "TIFF");
+				snprintf(name, sizeof(name), "BLOCK_SIZE_%d_%d", nXBlockOff + x, nYBlockOff + y);
+				const char *size = off ? GDALGetMetadataItem(bnd, name, "TIFF") : nullptr;
+				offsets[i] = off ? CPLAtoGIntBig(off) : 0;
+				sizes[i] = size ? CPLAtoGIntBig(size) : 0;
+			}
+		}
 	}
 	godalUnwrap();
 }
 
-void godalLayerDeleteFeature(cctx *ctx, OGRLayerH layer, OGRFeatureH feat) {
+/* godalBandReadRawTiles reads the nTiles byte ranges from the file of the band's dataset, in a single
+   multi-range request, into the consecutive sizes[i] bytes of buffer */
+void godalBandReadRawTiles(cctx *ctx, GDALRasterBandH bnd, int nTiles, unsigned long long *offsets, size_t *sizes, void *buffer) {
 	godalWrap(ctx);
-	GIntBig fid = OGR_F_GetFID(feat);
-	if (fid == OGRNullFID) {
-		CPLError(CE_Failure, CPLE_AppDefined, "cannot delete feature with no FID");
+	if (!godalIsGTiffBand(bnd)) {
 		godalUnwrap();
 		return;
 	}
-	OGRErr gret = OGR_L_DeleteFeature(layer,fid);
-	if(gret!=0){
-		forceOGRError(ctx,gret);
+	const char *filename = GDALGetDescription(GDALGetBandDataset(bnd));
+	VSILFILE *fp = VSIFOpenExL(filename, "rb", TRUE);
+	if (fp == nullptr) {
+		forceError(ctx);
+		godalUnwrap();
+		return;
+	}
+	std::vector<void *> data(nTiles);
+	char *cur = (char *)buffer;
+	for (int i = 0; i < nTiles; i++) {
+		data[i] = cur;
+		cur += sizes[i];
+	}
+	if (nTiles > 0 && VSIFReadMultiRangeL(nTiles, data.data(), (const vsi_l_offset *)offsets, sizes, fp) != 0) {
+		if (!failed(ctx)) {
+			CPLError(CE_Failure, CPLE_FileIO, "failed to read raw tiles from %s", filename);
+		}
 	}
+	VSIFCloseL(fp);
 	godalUnwrap();
 }
 
-void godalLayerSetFeature(cctx *ctx, OGRLayerH layer, OGRFeatureH feat) {
+void godalFillRaster(cctx *ctx, GDALRasterBandH bnd, double real, double imag) {
 	godalWrap(ctx);
-	OGRErr gret = OGR_L_SetFeature(layer,feat);
-	if(gret!=0){
-		forceOGRError(ctx,gret);
+	CPLErr ret = GDALFillRaster(bnd,real,imag);
+	if(ret!=0){
+		forceCPLError(ctx,ret);
 	}
 	godalUnwrap();
+
 }
 
-void godalFeatureSetGeometry(cctx *ctx, OGRFeatureH feat, OGRGeometryH geom) {
+void godalPolygonize(cctx *ctx, GDALRasterBandH in, GDALRasterBandH mask, OGRLayerH layer,int fieldIndex, char **opts) {
 	godalWrap(ctx);
-	OGRErr gret = OGR_F_SetGeometry(feat,geom);
-	if(gret!=0){
-		forceOGRError(ctx,gret);
+	if (fieldIndex >= OGR_FD_GetFieldCount(OGR_L_GetLayerDefn(layer))) {
+		CPLError(CE_Failure, CPLE_AppDefined, "invalid fieldIndex");
+		godalUnwrap();
+		return;
+	}
+	CPLErr ret = GDALPolygonize(in,mask,layer,fieldIndex,opts,godalProgressFunc(ctx),godalProgressArg(ctx));
+	if(ret!=0){
+		forceCPLError(ctx,ret);
 	}
 	godalUnwrap();
 }
 
-OGRGeometryH godal_OGR_G_Simplify(cctx *ctx, OGRGeometryH in, double tolerance) {
-	godalWrap(ctx);
-	OGRGeometryH ret = OGR_G_Simplify(in,tolerance);
-	if(ret==nullptr) {
-		forceError(ctx);
-	}
-	godalUnwrap();
-	return ret;
+/* godalWorkerContext initializes the context of a worker thread of an operation running
+   with ctx. Its errors are then moved to ctx by godalMergeWorkerContexts */
+static void godalWorkerContext(cctx *wctx, const cctx *ctx) {
+	wctx->errMessage = nullptr;
+	wctx->handlerIdx = ctx->handlerIdx;
+	wctx->failed = 0;
+	wctx->configOptions = ctx->configOptions;
+	wctx->progressIdx = 0;
 }
 
-OGRGeometryH godal_OGR_G_Buffer(cctx *ctx, OGRGeometryH in, double tolerance, int segments) {
-	godalWrap(ctx);
+static void godalMergeWorkerContexts(cctx *ctx, std::vector<cctx> &wctxs) {
+	for (cctx &wctx : wctxs) {
+		if (wctx.errMessage != nullptr) {
+			if (ctx->errMessage == nullptr) {
+				ctx->errMessage = wctx.errMessage;
+			} else {
+				free(wctx.errMessage);
+			}
+			wctx.errMessage = nullptr;
+		}
+		if (wctx.failed) {
+			ctx->failed = 1;
+		}
+	}
+}
+
+/* godalRasterTile is a window of a band copied to a MEM dataset with a pixel coordinates
+   geotransform, along with its mask as second band */
+struct godalRasterTile {
+	int x0, y0, w, h;
+	GDALDatasetH ds = nullptr;
+	~godalRasterTile() {
+		if (ds != nullptr) {
+			GDALClose(ds);
+		}
+	}
+	CPLErr read(GDALRasterBandH bnd, GDALRasterBandH mask, std::mutex &ioMutex) {
+		size_t n = (size_t)w * h;
+		std::vector<GInt32> vals(n);
+		std::vector<GByte> valid;
+		{
+			std::lock_guard<std::mutex> lock(ioMutex);
+			CPLErr ret = GDALRasterIO(bnd, GF_Read, x0, y0, w, h, vals.data(), w, h, GDT_Int32, 0, 0);
+			if (ret == CE_None && mask != nullptr) {
+				valid.resize(n);
+				ret = GDALRasterIO(mask, GF_Read, x0, y0, w, h, valid.data(), w, h, GDT_Byte, 0, 0);
+			}
+			if (ret != CE_None) {
+				return ret;
+			}
+		}
+		ds = GDALCreate(GDALGetDriverByName("MEM"), "", w, h, 1, GDT_Int32, nullptr);
+		if (ds == nullptr) {
+			return CE_Failure;
+		}
+		double gt[6] = {(double)x0, 1, 0, (double)y0, 0, 1};
+		GDALSetGeoTransform(ds, gt);
+		CPLErr ret = GDALRasterIO(GDALGetRasterBand(ds, 1), GF_Write, 0, 0, w, h, vals.data(), w, h, GDT_Int32, 0, 0);
+		if (ret == CE_None && mask != nullptr) {
+			ret = GDALAddBand(ds, GDT_Byte, nullptr);
+			if (ret == CE_None) {
+				ret = GDALRasterIO(GDALGetRasterBand(ds, 2), GF_Write, 0, 0, w, h, valid.data(), w, h, GDT_Byte, 0, 0);
+			}
+		}
+		return ret;
+	}
+	GDALRasterBandH band() { return GDALGetRasterBand(ds, 1); }
+	GDALRasterBandH mask() { return GDALGetRasterCount(ds) > 1 ? GDALGetRasterBand(ds, 2) : nullptr; }
+};
+
+/* godalTiling splits a raster in tiles, processed by threads that pass their results to the
+   calling thread through a queue */
+template <typename R>
+struct godalTiling {
+	int sx, sy, tileX, tileY, ntx, nty;
+	std::atomic<int> next{0};
+	std::atomic<bool> abort{false};
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<std::unique_ptr<R>> results;
+	int running = 0;
+
+	godalTiling(int sx, int sy, int tileX, int tileY)
+		: sx(sx), sy(sy), tileX(tileX), tileY(tileY), ntx((sx + tileX - 1) / tileX), nty((sy + tileY - 1) / tileY) {}
+	int count() const { return ntx * nty; }
+	void window(int i, int &x0, int &y0, int &x1, int &y1) const {
+		x0 = (i % ntx) * tileX;
+		y0 = (i / ntx) * tileY;
+		x1 = std::min(sx, x0 + tileX);
+		y1 = std::min(sy, y0 + tileY);
+	}
+	/* run processes the tiles with nThreads threads that call process(wctx, i) for each tile,
+	   and calls consume(result) on the calling thread for each processed tile, until all the
+	   tiles have been processed or consume returns false. function is the name of the entry
+	   point the worker calls are instrumented as. Workers wait for the calling thread when
+	   2*nThreads results are queued, so that at most 3*nThreads tiles are held in memory. */
+	template <typename P, typename C>
+	void run(cctx *ctx, const char *function, int nThreads, P process, C consume) {
+		nThreads = std::max(1, std::min(nThreads, count()));
+		const size_t maxQueued = 2 * (size_t)nThreads;
+		std::vector<cctx> wctxs(nThreads);
+		std::vector<std::thread> threads;
+		running = nThreads;
+		for (int t = 0; t < nThreads; t++) {
+			godalWorkerContext(&wctxs[t], ctx);
+			threads.emplace_back([this, t, &wctxs, &process, function, maxQueued]() {
+				cctx *wctx = &wctxs[t];
+				godalWrapCall(wctx, function);
+				for (int i = next++; i < count() && !abort; i = next++) {
+					std::unique_ptr<R> res = process(wctx, i);
+					if (failed(wctx)) {
+						std::lock_guard<std::mutex> lock(mutex);
+						abort = true;
+						cv.notify_all();
+						break;
+					}
+					std::unique_lock<std::mutex> lock(mutex);
+					cv.wait(lock, [this, maxQueued]() { return results.size() < maxQueued || abort; });
+					results.push_back(std::move(res));
+					cv.notify_all();
+				}
+				godalUnwrap();
+				std::lock_guard<std::mutex> lock(mutex);
+				running--;
+				cv.notify_all();
+			});
+		}
+		for (;;) {
+			std::unique_ptr<R> res;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cv.wait(lock, [this]() { return !results.empty() || running == 0; });
+				if (results.empty()) {
+					break;
+				}
+				res = std::move(results.front());
+				results.pop_front();
+				cv.notify_all();
+			}
+			if (!abort && !consume(std::move(res))) {
+				std::lock_guard<std::mutex> lock(mutex);
+				abort = true;
+				cv.notify_all();
+			}
+		}
+		for (std::thread &t : threads) {
+			t.join();
+		}
+		godalMergeWorkerContexts(ctx, wctxs);
+	}
+};
+
+/* godalProgressTiles reports the progress of a tiled operation, and returns false if it
+   must be interrupted */
+static bool godalProgressTiles(cctx *ctx, double complete) {
+	GDALProgressFunc fn = godalProgressFunc(ctx);
+	if (fn != nullptr && !fn(complete, nullptr, godalProgressArg(ctx))) {
+		CPLError(CE_Failure, CPLE_UserInterrupt, "User terminated");
+		return false;
+	}
+	return true;
+}
+
+/* godalAffineGeometry applies the geotransform gt to the coordinates of geom */
+static void godalAffineGeometry(OGRGeometryH geom, const double *gt) {
+	int n = OGR_G_GetGeometryCount(geom);
+	for (int i = 0; i < n; i++) {
+		godalAffineGeometry(OGR_G_GetGeometryRef(geom, i), gt);
+	}
+	n = OGR_G_GetPointCount(geom);
+	for (int i = 0; i < n; i++) {
+		double x = OGR_G_GetX(geom, i), y = OGR_G_GetY(geom, i);
+		OGR_G_SetPoint_2D(geom, i, gt[0] + x * gt[1] + y * gt[2], gt[3] + x * gt[4] + y * gt[5]);
+	}
+}
+
+struct godalPolygonizeTile {
+	int index;
+	std::vector<std::pair<OGRGeometryH, int>> polygons;
+	~godalPolygonizeTile() {
+		for (auto &p : polygons) {
+			if (p.first != nullptr) {
+				OGR_G_DestroyGeometry(p.first);
+			}
+		}
+	}
+};
+
+/* godalSeamPolygon is a polygon touching an inner tile boundary, that must be dissolved with
+   the polygons of the same value it shares an edge with in the neighbouring tiles. Polygons
+   that only share a corner are not dissolved, even if 8-connected, as their union would not
+   be a polygon */
+struct godalSeamPolygon {
+	OGRGeometryH geom;
+	int value, tile;
+	OGREnvelope env;
+};
+
+static int godalFindRoot(std::vector<int> &parents, int i) {
+	while (parents[i] != i) {
+		parents[i] = parents[parents[i]];
+		i = parents[i];
+	}
+	return i;
+}
+
+void godalPolygonizeTiled(cctx *ctx, GDALRasterBandH in, GDALRasterBandH mask, OGRLayerH layer, int fieldIndex, char **opts,
+						  int tileX, int tileY, int nThreads) {
+	godalWrap(ctx);
+	OGRFeatureDefnH defn = OGR_L_GetLayerDefn(layer);
+	if (fieldIndex >= OGR_FD_GetFieldCount(defn)) {
+		CPLError(CE_Failure, CPLE_AppDefined, "invalid fieldIndex");
+		godalUnwrap();
+		return;
+	}
+	double gt[6];
+	GDALGetGeoTransform(GDALGetBandDataset(in), gt);
+	godalTiling<godalPolygonizeTile> tiling(GDALGetRasterBandXSize(in), GDALGetRasterBandYSize(in), tileX, tileY);
+	std::mutex ioMutex;
+
+	auto process = [&](cctx *wctx, int i) {
+		std::unique_ptr<godalPolygonizeTile> res(new godalPolygonizeTile);
+		res->index = i;
+		int x0, y0, x1, y1;
+		tiling.window(i, x0, y0, x1, y1);
+		godalRasterTile tile;
+		tile.x0 = x0, tile.y0 = y0, tile.w = x1 - x0, tile.h = y1 - y0;
+		CPLErr ret = tile.read(in, mask, ioMutex);
+		if (ret != CE_None) {
+			forceCPLError(wctx, ret);
+			return res;
+		}
+		GDALDatasetH vds = GDALCreate(GDALGetDriverByName("Memory"), "", 0, 0, 0, GDT_Unknown, nullptr);
+		if (vds == nullptr) {
+			forceError(wctx);
+			return res;
+		}
+		OGRLayerH vl = GDALDatasetCreateLayer(vds, "tile", nullptr, wkbPolygon, nullptr);
+		OGRFieldDefnH fld = OGR_Fld_Create("value", OFTInteger);
+		OGR_L_CreateField(vl, fld, TRUE);
+		OGR_Fld_Destroy(fld);
+		ret = GDALPolygonize(tile.band(), tile.mask(), vl, 0, opts, nullptr, nullptr);
+		if (ret != CE_None) {
+			forceCPLError(wctx, ret);
+		} else {
+			OGR_L_ResetReading(vl);
+			OGRFeatureH feat;
+			while ((feat = OGR_L_GetNextFeature(vl)) != nullptr) {
+				res->polygons.push_back(std::make_pair(OGR_F_StealGeometry(feat), OGR_F_GetFieldAsInteger(feat, 0)));
+				OGR_F_Destroy(feat);
+			}
+		}
+		GDALClose(vds);
+		return res;
+	};
+
+	auto write = [&](OGRGeometryH geom, int value) {
+		godalAffineGeometry(geom, gt);
+		OGRFeatureH feat = OGR_F_Create(defn);
+		OGR_F_SetGeometryDirectly(feat, geom);
+		if (fieldIndex >= 0) {
+			OGR_F_SetFieldInteger(feat, fieldIndex, value);
+		}
+		OGRErr oe = OGR_L_CreateFeature(layer, feat);
+		OGR_F_Destroy(feat);
+		if (oe != OGRERR_NONE) {
+			forceOGRError(ctx, oe);
+			return false;
+		}
+		return true;
+	};
+
+	std::vector<godalSeamPolygon> seams;
+	int done = 0;
+	auto consume = [&](std::unique_ptr<godalPolygonizeTile> res) {
+		int x0, y0, x1, y1;
+		tiling.window(res->index, x0, y0, x1, y1);
+		for (auto &p : res->polygons) {
+			OGRGeometryH geom = p.first;
+			p.first = nullptr;
+			if (geom == nullptr) {
+				continue;
+			}
+			godalSeamPolygon sp;
+			OGR_G_GetEnvelope(geom, &sp.env);
+			if ((sp.env.MinX == x0 && x0 > 0) || (sp.env.MaxX == x1 && x1 < tiling.sx) ||
+				(sp.env.MinY == y0 && y0 > 0) || (sp.env.MaxY == y1 && y1 < tiling.sy)) {
+				sp.geom = geom;
+				sp.value = p.second;
+				sp.tile = res->index;
+				seams.push_back(sp);
+			} else if (!write(geom, p.second)) {
+				return false;
+			}
+		}
+		done++;
+		return godalProgressTiles(ctx, 0.9 * done / tiling.count());
+	};
+	tiling.run(ctx, __func__, nThreads, process, consume);
+
+	if (!failed(ctx)) {
+		/* candidate pairs are the seam polygons of the same value of two neighbouring tiles
+		   whose envelopes touch */
+		std::vector<int> parents(seams.size());
+		std::unordered_map<int, std::vector<int>> byTile;
+		for (size_t i = 0; i < seams.size(); i++) {
+			parents[i] = (int)i;
+			byTile[seams[i].tile].push_back((int)i);
+		}
+		auto link = [&](int a, int b) {
+			const godalSeamPolygon &pa = seams[a], &pb = seams[b];
+			if (pa.value != pb.value || pa.env.MaxX < pb.env.MinX || pb.env.MaxX < pa.env.MinX ||
+				pa.env.MaxY < pb.env.MinY || pb.env.MaxY < pa.env.MinY) {
+				return;
+			}
+			int ra = godalFindRoot(parents, a), rb = godalFindRoot(parents, b);
+			if (ra == rb) {
+				return;
+			}
+			OGRGeometryH inter = OGR_G_Intersection(pa.geom, pb.geom);
+			if (inter == nullptr) {
+				return;
+			}
+			if (!OGR_G_IsEmpty(inter) && OGR_G_GetDimension(inter) >= 1) {
+				parents[ra] = rb;
+			}
+			OGR_G_DestroyGeometry(inter);
+		};
+		for (auto &it : byTile) {
+			int t = it.first, tx = t % tiling.ntx, ty = t / tiling.ntx;
+			//diagonal tiles only share a corner
+			const int neighbours[2][2] = {{1, 0}, {0, 1}};
+			for (const auto &d : neighbours) {
+				int nx = tx + d[0], ny = ty + d[1];
+				if (nx >= tiling.ntx || ny >= tiling.nty) {
+					continue;
+				}
+				auto nit = byTile.find(ny * tiling.ntx + nx);
+				if (nit == byTile.end()) {
+					continue;
+				}
+				for (int a : it.second) {
+					for (int b : nit->second) {
+						link(a, b);
+					}
+				}
+			}
+		}
+		std::unordered_map<int, std::vector<int>> groups;
+		for (size_t i = 0; i < seams.size(); i++) {
+			groups[godalFindRoot(parents, (int)i)].push_back((int)i);
+		}
+		for (auto &g : groups) {
+			if (failed(ctx)) {
+				break;
+			}
+			OGRGeometryH geom;
+			if (g.second.size() == 1) {
+				geom = seams[g.second[0]].geom;
+				seams[g.second[0]].geom = nullptr;
+			} else {
+				OGRGeometryH parts = OGR_G_CreateGeometry(wkbMultiPolygon);
+				for (int i : g.second) {
+					OGR_G_AddGeometryDirectly(parts, seams[i].geom);
+					seams[i].geom = nullptr;
+				}
+				geom = OGR_G_UnionCascaded(parts);
+				OGR_G_DestroyGeometry(parts);
+				if (geom == nullptr) {
+					forceError(ctx);
+					break;
+				}
+				//the parts share edges, so this is not expected to happen
+				if (wkbFlatten(OGR_G_GetGeometryType(geom)) == wkbMultiPolygon) {
+					OGRGeometryH multi = geom;
+					for (int i = 0; i < OGR_G_GetGeometryCount(multi) && !failed(ctx); i++) {
+						write(OGR_G_Clone(OGR_G_GetGeometryRef(multi, i)), seams[g.second[0]].value);
+					}
+					OGR_G_DestroyGeometry(multi);
+					continue;
+				}
+			}
+			write(geom, seams[g.second[0]].value);
+		}
+		if (!failed(ctx)) {
+			godalProgressTiles(ctx, 1.0);
+		}
+	}
+	for (godalSeamPolygon &sp : seams) {
+		if (sp.geom != nullptr) {
+			OGR_G_DestroyGeometry(sp.geom);
+		}
+	}
+	godalUnwrap();
+}
+
+void godalSieveFilter(cctx *ctx, GDALRasterBandH bnd, GDALRasterBandH mask, GDALRasterBandH dst, int sizeThreshold, int connectedNess) {
+	godalWrap(ctx);
+	CPLErr ret = GDALSieveFilter(bnd,mask,dst,sizeThreshold,connectedNess,nullptr,godalProgressFunc(ctx),godalProgressArg(ctx));
+	if(ret!=0){
+		forceCPLError(ctx,ret);
+	}
+	godalUnwrap();
+}
+
+struct godalSieveTile {
+	int index;
+	std::vector<GInt32> core;
+};
+
+void godalSieveFilterTiled(cctx *ctx, GDALRasterBandH bnd, GDALRasterBandH mask, GDALRasterBandH dst, int sizeThreshold, int connectedNess,
+						   int tileX, int tileY, int overlap, int nThreads) {
+	godalWrap(ctx);
+	godalTiling<godalSieveTile> tiling(GDALGetRasterBandXSize(bnd), GDALGetRasterBandYSize(bnd), tileX, tileY);
+	std::mutex ioMutex;
+	/* when sieving in place, a tile can only be written once all the tiles whose read
+	   window overlaps it have been read */
+	bool inPlace = (dst == bnd);
+	int rowsDep = (overlap + tileY - 1) / tileY, colsDep = (overlap + tileX - 1) / tileX;
+	std::vector<char> read(tiling.count(), 0);
+
+	auto process = [&](cctx *wctx, int i) {
+		std::unique_ptr<godalSieveTile> res(new godalSieveTile);
+		res->index = i;
+		int x0, y0, x1, y1;
+		tiling.window(i, x0, y0, x1, y1);
+		godalRasterTile tile;
+		tile.x0 = std::max(0, x0 - overlap);
+		tile.y0 = std::max(0, y0 - overlap);
+		tile.w = std::min(tiling.sx, x1 + overlap) - tile.x0;
+		tile.h = std::min(tiling.sy, y1 + overlap) - tile.y0;
+		CPLErr ret = tile.read(bnd, mask, ioMutex);
+		{
+			std::lock_guard<std::mutex> lock(ioMutex);
+			read[i] = 1;
+		}
+		if (ret == CE_None) {
+			ret = GDALSieveFilter(tile.band(), tile.mask(), tile.band(), sizeThreshold, connectedNess, nullptr, nullptr, nullptr);
+		}
+		if (ret == CE_None) {
+			res->core.resize((size_t)(x1 - x0) * (y1 - y0));
+			ret = GDALRasterIO(tile.band(), GF_Read, x0 - tile.x0, y0 - tile.y0, x1 - x0, y1 - y0,
+							   res->core.data(), x1 - x0, y1 - y0, GDT_Int32, 0, 0);
+		}
+		if (ret != CE_None) {
+			forceCPLError(wctx, ret);
+		}
+		return res;
+	};
+
+	auto writable = [&](int i) {
+		if (!inPlace) {
+			return true;
+		}
+		int tx = i % tiling.ntx, ty = i / tiling.ntx;
+		for (int y = std::max(0, ty - rowsDep); y <= std::min(tiling.nty - 1, ty + rowsDep); y++) {
+			for (int x = std::max(0, tx - colsDep); x <= std::min(tiling.ntx - 1, tx + colsDep); x++) {
+				if (!read[y * tiling.ntx + x]) {
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+	auto write = [&](const godalSieveTile &res) {
+		int x0, y0, x1, y1;
+		tiling.window(res.index, x0, y0, x1, y1);
+		CPLErr ret = GDALRasterIO(dst, GF_Write, x0, y0, x1 - x0, y1 - y0, (void *)res.core.data(), x1 - x0, y1 - y0, GDT_Int32, 0, 0);
+		if (ret != CE_None) {
+			forceCPLError(ctx, ret);
+			return false;
+		}
+		return true;
+	};
+
+	std::list<std::unique_ptr<godalSieveTile>> pending;
+	int done = 0;
+	auto flush = [&](bool all) {
+		std::lock_guard<std::mutex> lock(ioMutex);
+		for (auto it = pending.begin(); it != pending.end();) {
+			if (!all && !writable((*it)->index)) {
+				++it;
+				continue;
+			}
+			if (!write(**it)) {
+				return false;
+			}
+			it = pending.erase(it);
+			done++;
+		}
+		return true;
+	};
+	auto consume = [&](std::unique_ptr<godalSieveTile> res) {
+		pending.push_back(std::move(res));
+		if (!flush(false)) {
+			return false;
+		}
+		return godalProgressTiles(ctx, (double)done / tiling.count());
+	};
+	tiling.run(ctx, __func__, nThreads, process, consume);
+	if (!failed(ctx) && flush(true)) {
+		godalProgressTiles(ctx, 1.0);
+	}
+	godalUnwrap();
+}
+
+void godalFillNoData(cctx *ctx, GDALRasterBandH in, GDALRasterBandH mask, int maxDistance, int iterations, char **opts) {
+	godalWrap(ctx);
+	CPLErr ret = GDALFillNodata(in,mask,maxDistance,0,iterations,opts,nullptr,nullptr);
+	if(ret!=0){
+		forceCPLError(ctx,ret);
+	}
+	godalUnwrap();
+}
+
+GDALDatasetH godalRasterize(cctx *ctx, char *dstName, GDALDatasetH ds, char **switches) {
+	godalWrap(ctx);
+	GDALRasterizeOptions *ropts = GDALRasterizeOptionsNew(switches,nullptr);
+	if(failed(ctx)) {
+		GDALRasterizeOptionsFree(ropts);
+		godalUnwrap();
+		return nullptr;
+	}
+	GDALRasterizeOptionsSetProgress(ropts,godalProgressFunc(ctx),godalProgressArg(ctx));
+	int usageErr=0;
+	GDALDatasetH ret = GDALRasterize(dstName, nullptr, ds, ropts, &usageErr);
+	GDALRasterizeOptionsFree(ropts);
+	if(ret==nullptr || usageErr!=0) {
+		forceError(ctx);
+	}
+	godalUnwrap();
+	return ret;
+}
+
+void godalRasterizeGeometry(cctx *ctx, GDALDatasetH ds, OGRGeometryH geom, int *bands, int nBands, double *vals, int allTouched) {
+	const char *opts[2] = { "ALL_TOUCHED=TRUE",nullptr };
+	char **copts=(char**)opts;
+	if (!allTouched) {
+		copts=nullptr;
+	}
+	godalWrap(ctx);
+	CPLErr ret = GDALRasterizeGeometries(ds,nBands,bands,1,&geom,nullptr,nullptr,vals,copts,nullptr,nullptr);
+	if(ret!=0){
+		forceCPLError(ctx,ret);
+	}
+	godalUnwrap();
+}
+
+/* godalRasterizeChunk holds the rows of the burnt bands of a chunk of a dataset */
+struct godalRasterizeChunk {
+	int index;
+	std::vector<GByte> data;
+};
+
+void godalRasterizeGeometries(cctx *ctx, GDALDatasetH ds, int nGeoms, OGRGeometryH *geoms, int *bands, int nBands, double *vals,
+							  int allTouched, int nThreads) {
+	const char *opts[2] = { "ALL_TOUCHED=TRUE",nullptr };
+	char **copts=(char**)opts;
+	if (!allTouched) {
+		copts=nullptr;
+	}
+	godalWrap(ctx);
+	std::vector<OGRGeometryH> hGeoms;
+	std::vector<double> hVals;
+	for (int i = 0; i < nGeoms; i++) {
+		if (geoms[i] != nullptr) {
+			hGeoms.push_back(geoms[i]);
+			hVals.insert(hVals.end(), vals + (size_t)i * nBands, vals + (size_t)(i + 1) * nBands);
+		}
+	}
+	if (hGeoms.empty()) {
+		godalUnwrap();
+		return;
+	}
+	if (nThreads <= 1) {
+		CPLErr ret = GDALRasterizeGeometries(ds, nBands, bands, (int)hGeoms.size(), hGeoms.data(), nullptr, nullptr, hVals.data(), copts,
+											 godalProgressFunc(ctx), godalProgressArg(ctx));
+		if (ret != 0) {
+			forceCPLError(ctx, ret);
+		}
+		godalUnwrap();
+		return;
+	}
+
+	double gt[6];
+	if (GDALGetGeoTransform(ds, gt) != CE_None) {
+		CPLError(CE_Failure, CPLE_AppDefined, "cannot rasterize in parallel on a dataset without a geotransform");
+		godalUnwrap();
+		return;
+	}
+	int sx = GDALGetRasterXSize(ds), sy = GDALGetRasterYSize(ds);
+	std::vector<GDALRasterBandH> hBands(nBands);
+	std::vector<GDALDataType> dtypes(nBands);
+	size_t pixelSize = 0;
+	for (int b = 0; b < nBands; b++) {
+		hBands[b] = GDALGetRasterBand(ds, bands[b]);
+		if (hBands[b] == nullptr) {
+			CPLError(CE_Failure, CPLE_AppDefined, "invalid band %d", bands[b]);
+			godalUnwrap();
+			return;
+		}
+		dtypes[b] = GDALGetRasterDataType(hBands[b]);
+		pixelSize += GDALGetDataTypeSizeBytes(dtypes[b]);
+	}
+
+	/* chunks are whole rows of blocks, small enough to give a few of them to each
+	   thread and to keep their buffers under 64MB. Rows of blocks that do not fit in 64MB
+	   are split, in which case more than one chunk reads and writes each block. At most
+	   3*nThreads chunks are held in memory, as bounded by godalTiling::run */
+	int bx, by;
+	GDALGetBlockSize(hBands[0], &bx, &by);
+	by = std::max(1, std::min(by, sy));
+	int chunkRows = by * std::max(1, (sy + by * nThreads * 4 - 1) / (by * nThreads * 4));
+	size_t maxRows = std::max((size_t)1, ((size_t)64 << 20) / (pixelSize * sx));
+	if ((size_t)chunkRows > maxRows) {
+		chunkRows = maxRows >= (size_t)by ? (int)(maxRows / by) * by : (int)maxRows;
+	}
+	godalTiling<godalRasterizeChunk> tiling(sx, sy, sx, chunkRows);
+
+	/* the rows covered by each geometry, when they can be computed from a north-up
+	   geotransform. Other geometries are burnt in all the chunks */
+	std::vector<std::pair<int, int>> rows(hGeoms.size(), std::make_pair(0, sy));
+	if (gt[2] == 0 && gt[4] == 0 && gt[5] != 0) {
+		for (size_t i = 0; i < hGeoms.size(); i++) {
+			OGREnvelope env;
+			OGR_G_GetEnvelope(hGeoms[i], &env);
+			double r0 = (env.MaxY - gt[3]) / gt[5], r1 = (env.MinY - gt[3]) / gt[5];
+			if (r0 > r1) {
+				std::swap(r0, r1);
+			}
+			//one pixel margin for all touched and rounding
+			rows[i].first = (int)std::max(-1.0, std::floor(r0) - 1);
+			rows[i].second = (int)std::min((double)sy + 1, std::ceil(r1) + 1);
+		}
+	}
+
+	std::mutex ioMutex;
+	auto process = [&](cctx *wctx, int i) {
+		std::unique_ptr<godalRasterizeChunk> res(new godalRasterizeChunk);
+		res->index = i;
+		int x0, y0, x1, y1;
+		tiling.window(i, x0, y0, x1, y1);
+		std::vector<OGRGeometryH> cGeoms;
+		std::vector<double> cVals;
+		for (size_t g = 0; g < hGeoms.size(); g++) {
+			if (rows[g].second >= y0 && rows[g].first <= y1) {
+				cGeoms.push_back(hGeoms[g]);
+				cVals.insert(cVals.end(), hVals.begin() + g * nBands, hVals.begin() + (g + 1) * nBands);
+			}
+		}
+		if (cGeoms.empty()) {
+			return res;
+		}
+		int h = y1 - y0;
+		res->data.resize(pixelSize * sx * h);
+		std::vector<GByte *> planes(nBands);
+		{
+			std::lock_guard<std::mutex> lock(ioMutex);
+			size_t off = 0;
+			for (int b = 0; b < nBands; b++) {
+				planes[b] = res->data.data() + off;
+				off += (size_t)GDALGetDataTypeSizeBytes(dtypes[b]) * sx * h;
+				CPLErr ret = GDALRasterIO(hBands[b], GF_Read, 0, y0, sx, h, planes[b], sx, h, dtypes[b], 0, 0);
+				if (ret != CE_None) {
+					forceCPLError(wctx, ret);
+					return res;
+				}
+			}
+		}
+		GDALDatasetH mds = GDALCreate(GDALGetDriverByName("MEM"), "", sx, h, 0, GDT_Byte, nullptr);
+		if (mds == nullptr) {
+			forceError(wctx);
+			return res;
+		}
+		double cgt[6] = {gt[0] + y0 * gt[2], gt[1], gt[2], gt[3] + y0 * gt[5], gt[4], gt[5]};
+		GDALSetGeoTransform(mds, cgt);
+		std::vector<int> mBands(nBands);
+		for (int b = 0; b < nBands && !failed(wctx); b++) {
+			char ptr[64];
+			snprintf(ptr, sizeof(ptr), "DATAPOINTER=%p", (void *)planes[b]);
+			const char *bopts[2] = {ptr, nullptr};
+			if (GDALAddBand(mds, dtypes[b], (char **)bopts) != CE_None) {
+				forceError(wctx);
+			}
+			mBands[b] = b + 1;
+		}
+		if (!failed(wctx)) {
+			CPLErr ret = GDALRasterizeGeometries(mds, nBands, mBands.data(), (int)cGeoms.size(), cGeoms.data(), nullptr, nullptr,
+												 cVals.data(), copts, nullptr, nullptr);
+			if (ret != CE_None) {
+				forceCPLError(wctx, ret);
+			}
+		}
+		//flushes the burnt values to the data buffer
+		GDALClose(mds);
+		return res;
+	};
+
+	int done = 0;
+	auto consume = [&](std::unique_ptr<godalRasterizeChunk> res) {
+		if (!res->data.empty()) {
+			int x0, y0, x1, y1;
+			tiling.window(res->index, x0, y0, x1, y1);
+			std::lock_guard<std::mutex> lock(ioMutex);
+			size_t off = 0;
+			for (int b = 0; b < nBands; b++) {
+				CPLErr ret = GDALRasterIO(hBands[b], GF_Write, 0, y0, sx, y1 - y0, res->data.data() + off, sx, y1 - y0, dtypes[b], 0, 0);
+				if (ret != CE_None) {
+					forceCPLError(ctx, ret);
+					return false;
+				}
+				off += (size_t)GDALGetDataTypeSizeBytes(dtypes[b]) * sx * (y1 - y0);
+			}
+		}
+		done++;
+		return godalProgressTiles(ctx, (double)done / tiling.count());
+	};
+	tiling.run(ctx, __func__, nThreads, process, consume);
+	godalUnwrap();
+}
+
+void godalLayerDeleteFeature(cctx *ctx, OGRLayerH layer, OGRFeatureH feat) {
+	godalWrap(ctx);
+	GIntBig fid = OGR_F_GetFID(feat);
+	if (fid == OGRNullFID) {
+		CPLError(CE_Failure, CPLE_AppDefined, "cannot delete feature with no FID");
+		godalUnwrap();
+		return;
+	}
+	OGRErr gret = OGR_L_DeleteFeature(layer,fid);
+	if(gret!=0){
+		forceOGRError(ctx,gret);
+	}
+	godalUnwrap();
+}
+
+/* godalFeatureBatchData owns the buffers a godalFeatureBatch points to */
+struct godalFeatureBatchData {
+	struct column {
+		std::vector<unsigned char> nulls;
+		std::vector<long long> ints;
+		std::vector<double> doubles;
+		std::vector<char> bytes;
+		std::vector<long long> offsets;
+		std::vector<long long> listOffsets;
+		void addString(const char *str, size_t len) {
+			bytes.insert(bytes.end(), str, str + len);
+			offsets.push_back(bytes.size());
+		}
+	};
+	std::vector<long long> fids;
+	std::vector<unsigned char> wkb;
+	std::vector<long long> wkbOffsets;
+	std::vector<column> columns;
+	std::vector<godalFieldColumn> ccolumns;
+	godalFeatureBatch batch;
+};
+
+static void godalAddFeatureFields(godalFeatureBatchData::column &col, OGRFeatureH feat, int i, OGRFieldType type) {
+	bool isSet = OGR_F_IsFieldSetAndNotNull(feat, i);
+	col.nulls.push_back(isSet ? 0 : 1);
+	int n = 0;
+	switch (type) {
+	case OFTInteger:
+	case OFTInteger64:
+		col.ints.push_back(isSet ? OGR_F_GetFieldAsInteger64(feat, i) : 0);
+		break;
+	case OFTReal:
+		col.doubles.push_back(isSet ? OGR_F_GetFieldAsDouble(feat, i) : 0);
+		break;
+	case OFTString: {
+		const char *str = isSet ? OGR_F_GetFieldAsString(feat, i) : "";
+		col.addString(str, strlen(str));
+		break;
+	}
+	case OFTBinary: {
+		const GByte *bin = isSet ? OGR_F_GetFieldAsBinary(feat, i, &n) : nullptr;
+		col.addString((const char *)bin, bin ? n : 0);
+		break;
+	}
+	case OFTDate:
+	case OFTTime:
+	case OFTDateTime: {
+		int dt[6] = {0, 0, 0, 0, 0, 0};
+		float sec = 0;
+		if (isSet) {
+			OGR_F_GetFieldAsDateTimeEx(feat, i, &dt[0], &dt[1], &dt[2], &dt[3], &dt[4], &sec, &dt[5]);
+		}
+		col.ints.insert(col.ints.end(), dt, dt + 6);
+		col.doubles.push_back(sec);
+		break;
+	}
+	case OFTIntegerList: {
+		const int *vals = isSet ? OGR_F_GetFieldAsIntegerList(feat, i, &n) : nullptr;
+		col.ints.insert(col.ints.end(), vals, vals + (vals ? n : 0));
+		col.listOffsets.push_back(col.ints.size());
+		break;
+	}
+	case OFTInteger64List: {
+		const GIntBig *vals = isSet ? OGR_F_GetFieldAsInteger64List(feat, i, &n) : nullptr;
+		col.ints.insert(col.ints.end(), vals, vals + (vals ? n : 0));
+		col.listOffsets.push_back(col.ints.size());
+		break;
+	}
+	case OFTRealList: {
+		const double *vals = isSet ? OGR_F_GetFieldAsDoubleList(feat, i, &n) : nullptr;
+		col.doubles.insert(col.doubles.end(), vals, vals + (vals ? n : 0));
+		col.listOffsets.push_back(col.doubles.size());
+		break;
+	}
+	case OFTStringList: {
+		char **vals = isSet ? OGR_F_GetFieldAsStringList(feat, i) : nullptr;
+		for (char **val = vals; val && *val; val++) {
+			col.addString(*val, strlen(*val));
+		}
+		col.listOffsets.push_back(col.offsets.size() - 1);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+godalFeatureBatch *godalLayerNextFeatureBatch(cctx *ctx, OGRLayerH layer, int maxFeatures) {
+	godalWrap(ctx);
+	OGRFeatureDefnH defn = OGR_L_GetLayerDefn(layer);
+	int nFields = OGR_FD_GetFieldCount(defn);
+	std::vector<OGRFieldType> types(nFields);
+	godalFeatureBatchData *data = new godalFeatureBatchData;
+	data->columns.resize(nFields);
+	for (int i = 0; i < nFields; i++) {
+		types[i] = OGR_Fld_GetType(OGR_FD_GetFieldDefn(defn, i));
+		data->columns[i].offsets.push_back(0);
+		data->columns[i].listOffsets.push_back(0);
+	}
+	data->wkbOffsets.push_back(0);
+	int nFeatures = 0;
+	while (nFeatures < maxFeatures) {
+		OGRFeatureH feat = OGR_L_GetNextFeature(layer);
+		if (feat == nullptr) {
+			break;
+		}
+		nFeatures++;
+		data->fids.push_back(OGR_F_GetFID(feat));
+		OGRGeometryH geom = OGR_F_GetGeometryRef(feat);
+		if (geom != nullptr) {
+			size_t off = data->wkb.size();
+			data->wkb.resize(off + OGR_G_WkbSize(geom));
+			OGRErr gret = OGR_G_ExportToIsoWkb(geom, wkbNDR, data->wkb.data() + off);
+			if (gret != 0) {
+				forceOGRError(ctx, gret);
+				data->wkb.resize(off);
+			}
+		}
+		data->wkbOffsets.push_back(data->wkb.size());
+		for (int i = 0; i < nFields; i++) {
+			godalAddFeatureFields(data->columns[i], feat, i, types[i]);
+		}
+		OGR_F_Destroy(feat);
+	}
+	data->ccolumns.resize(nFields);
+	for (int i = 0; i < nFields; i++) {
+		godalFeatureBatchData::column &col = data->columns[i];
+		godalFieldColumn &ccol = data->ccolumns[i];
+		ccol.name = OGR_Fld_GetNameRef(OGR_FD_GetFieldDefn(defn, i));
+		ccol.type = types[i];
+		ccol.nulls = col.nulls.data();
+		ccol.ints = col.ints.data();
+		ccol.nInts = (int)col.ints.size();
+		ccol.doubles = col.doubles.data();
+		ccol.nDoubles = (int)col.doubles.size();
+		ccol.bytes = col.bytes.data();
+		ccol.offsets = col.offsets.data();
+		ccol.nOffsets = (int)col.offsets.size();
+		ccol.listOffsets = col.listOffsets.size() > 1 ? col.listOffsets.data() : nullptr;
+	}
+	godalFeatureBatch *batch = &data->batch;
+	batch->nFeatures = nFeatures;
+	batch->fids = data->fids.data();
+	batch->wkb = data->wkb.data();
+	batch->wkbOffsets = data->wkbOffsets.data();
+	batch->nFields = nFields;
+	batch->columns = data->ccolumns.data();
+	batch->priv = data;
+	godalUnwrap();
+	return batch;
+}
+
+void godalFreeFeatureBatch(godalFeatureBatch *batch) {
+	delete (godalFeatureBatchData *)batch->priv;
+}
+
+static void godalSetFeatureField(OGRFeatureH feat, const godalWriteColumn &col, int i) {
+	const long long *ints = (const long long *)col.ints;
+	const double *doubles = (const double *)col.doubles;
+	const char *bytes = (const char *)col.bytes;
+	const long long *offsets = (const long long *)col.offsets;
+	const long long *listOffsets = (const long long *)col.listOffsets;
+	if (col.nulls != 0 && ((const unsigned char *)col.nulls)[i]) {
+		OGR_F_SetFieldNull(feat, col.field);
+		return;
+	}
+	switch (col.type) {
+	case OFTInteger:
+	case OFTInteger64:
+		OGR_F_SetFieldInteger64(feat, col.field, ints[i]);
+		break;
+	case OFTReal:
+		OGR_F_SetFieldDouble(feat, col.field, doubles[i]);
+		break;
+	case OFTString:
+		OGR_F_SetFieldString(feat, col.field, std::string(bytes + offsets[i], offsets[i + 1] - offsets[i]).c_str());
+		break;
+	case OFTBinary:
+		OGR_F_SetFieldBinary(feat, col.field, (int)(offsets[i + 1] - offsets[i]), (const void *)(bytes + offsets[i]));
+		break;
+	case OFTDate:
+	case OFTTime:
+	case OFTDateTime: {
+		const long long *dt = ints + 6 * i;
+		OGR_F_SetFieldDateTimeEx(feat, col.field, (int)dt[0], (int)dt[1], (int)dt[2], (int)dt[3], (int)dt[4], (float)doubles[i], (int)dt[5]);
+		break;
+	}
+	case OFTIntegerList: {
+		std::vector<int> vals(ints + listOffsets[i], ints + listOffsets[i + 1]);
+		OGR_F_SetFieldIntegerList(feat, col.field, (int)vals.size(), vals.data());
+		break;
+	}
+	case OFTInteger64List:
+		OGR_F_SetFieldInteger64List(feat, col.field, (int)(listOffsets[i + 1] - listOffsets[i]), (const GIntBig *)(ints + listOffsets[i]));
+		break;
+	case OFTRealList:
+		OGR_F_SetFieldDoubleList(feat, col.field, (int)(listOffsets[i + 1] - listOffsets[i]), doubles + listOffsets[i]);
+		break;
+	case OFTStringList: {
+		std::vector<std::string> strs;
+		for (long long j = listOffsets[i]; j < listOffsets[i + 1]; j++) {
+			strs.emplace_back(bytes + offsets[j], offsets[j + 1] - offsets[j]);
+		}
+		std::vector<char *> cstrs;
+		for (std::string &str : strs) {
+			cstrs.push_back(&str[0]);
+		}
+		cstrs.push_back(nullptr);
+		OGR_F_SetFieldStringList(feat, col.field, cstrs.data());
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+/* godalLayerWriteFeatureBatch creates nFeatures features, committing a transaction every
+   transactionSize features if transactionSize>0. Returns the number of features that have
+   been written, i.e. the ones of the committed transactions if it fails */
+int godalLayerWriteFeatureBatch(cctx *ctx, OGRLayerH layer, int nFeatures, uintptr_t fids, uintptr_t wkb, uintptr_t wkbOffsets,
+								int nColumns, godalWriteColumn *columns, int transactionSize) {
+	godalWrap(ctx);
+	OGRFeatureDefnH defn = OGR_L_GetLayerDefn(layer);
+	const long long *pFIDs = (const long long *)fids;
+	const long long *pWKBOffsets = (const long long *)wkbOffsets;
+	int nWritten = 0;
+	bool inTransaction = false;
+	for (int i = 0; i < nFeatures; i++) {
+		if (transactionSize > 0 && !inTransaction) {
+			OGRErr oe = OGR_L_StartTransaction(layer);
+			if (oe != OGRERR_NONE) {
+				forceOGRError(ctx, oe);
+				break;
+			}
+			inTransaction = true;
+		}
+		OGRFeatureH feat = OGR_F_Create(defn);
+		OGR_F_SetFID(feat, pFIDs[i]);
+		OGRErr oe = OGRERR_NONE;
+		if (pWKBOffsets != nullptr && pWKBOffsets[i + 1] > pWKBOffsets[i]) {
+			OGRGeometryH geom = nullptr;
+			oe = OGR_G_CreateFromWkb((const unsigned char *)wkb + pWKBOffsets[i], nullptr, &geom, (int)(pWKBOffsets[i + 1] - pWKBOffsets[i]));
+			if (oe == OGRERR_NONE) {
+				oe = OGR_F_SetGeometryDirectly(feat, geom);
+			}
+		}
+		for (int c = 0; c < nColumns && oe == OGRERR_NONE; c++) {
+			godalSetFeatureField(feat, columns[c], i);
+		}
+		if (oe == OGRERR_NONE) {
+			oe = OGR_L_CreateFeature(layer, feat);
+		}
+		OGR_F_Destroy(feat);
+		if (oe != OGRERR_NONE) {
+			forceOGRError(ctx, oe);
+		}
+		if (failed(ctx)) {
+			break;
+		}
+		if (transactionSize > 0 && ((i + 1) % transactionSize == 0 || i + 1 == nFeatures)) {
+			inTransaction = false;
+			oe = OGR_L_CommitTransaction(layer);
+			if (oe != OGRERR_NONE) {
+				forceOGRError(ctx, oe);
+				break;
+			}
+			nWritten = i + 1;
+		} else if (transactionSize <= 0) {
+			nWritten = i + 1;
+		}
+	}
+	if (inTransaction) {
+		OGR_L_RollbackTransaction(layer);
+	}
+	godalUnwrap();
+	return nWritten;
+}
+
+void godalLayerSetFeature(cctx *ctx, OGRLayerH layer, OGRFeatureH feat) {
+	godalWrap(ctx);
+	OGRErr gret = OGR_L_SetFeature(layer,feat);
+	if(gret!=0){
+		forceOGRError(ctx,gret);
+	}
+	godalUnwrap();
+}
+
+void godalFeatureSetGeometry(cctx *ctx, OGRFeatureH feat, OGRGeometryH geom) {
+	godalWrap(ctx);
+	OGRErr gret = OGR_F_SetGeometry(feat,geom);
+	if(gret!=0){
+		forceOGRError(ctx,gret);
+	}
+	godalUnwrap();
+}
+
+OGRGeometryH godal_OGR_G_Simplify(cctx *ctx, OGRGeometryH in, double tolerance) {
+	godalWrap(ctx);
+	OGRGeometryH ret = OGR_G_Simplify(in,tolerance);
+	if(ret==nullptr) {
+		forceError(ctx);
+	}
+	godalUnwrap();
+	return ret;
+}
+
+OGRGeometryH godal_OGR_G_Buffer(cctx *ctx, OGRGeometryH in, double tolerance, int segments) {
+	godalWrap(ctx);
 	OGRGeometryH ret = OGR_G_Buffer(in,tolerance,segments);
 	if(ret==nullptr) {
 		forceError(ctx);
@@ -806,6 +2480,345 @@ void godalRasterHistogram(cctx *ctx, GDALRasterBandH bnd, double *min, double *m
 	godalUnwrap();
 }
 
+/* godalStatsAccumulator holds the running statistics of a band */
+struct godalStatsAccumulator {
+	unsigned long long count = 0;
+	double min = std::numeric_limits<double>::infinity();
+	double max = -std::numeric_limits<double>::infinity();
+	double mean = 0, m2 = 0; /* m2 is the sum of the squared differences to the mean */
+	std::vector<unsigned long long> hist;
+
+	/* merge adds the statistics of n other values, with Chan et al.'s pairwise formula */
+	void merge(unsigned long long n, double nmin, double nmax, double nmean, double nm2) {
+		if (n == 0) {
+			return;
+		}
+		unsigned long long total = count + n;
+		double delta = nmean - mean;
+		mean += delta * (double)n / (double)total;
+		m2 += nm2 + delta * delta * (double)count * (double)n / (double)total;
+		count = total;
+		min = std::min(min, nmin);
+		max = std::max(max, nmax);
+	}
+	void merge(const godalStatsAccumulator &o) {
+		merge(o.count, o.min, o.max, o.mean, o.m2);
+		for (size_t i = 0; i < hist.size(); i++) {
+			hist[i] += o.hist[i];
+		}
+	}
+};
+
+/* godalValidity sets valid[i] to 0 for the values that are nodata or NaN */
+template <typename T>
+static void godalValidity(const T *vals, size_t n, bool hasNodata, double nodata, GByte *valid) {
+	if (std::is_floating_point<T>::value) {
+		for (size_t i = 0; i < n; i++) {
+			valid[i] &= !std::isnan((double)vals[i]);
+		}
+		if (std::isnan(nodata)) {
+			return;
+		}
+	}
+	if (hasNodata) {
+		for (size_t i = 0; i < n; i++) {
+			valid[i] &= (double)vals[i] != nodata;
+		}
+	}
+}
+
+/* godalBlockMoments computes the count, min, max, mean and m2 of the valid values of a window.
+   The loops are kept branchless so that they are vectorized by the compiler. 8 and 16 bit
+   values are summed exactly in 64 bit integers, in a single pass */
+template <typename T, bool small = std::is_integral<T>::value && sizeof(T) <= 2>
+struct godalBlockMoments {
+	static void compute(const T *vals, const GByte *valid, size_t n, godalStatsAccumulator &acc) {
+		typedef typename std::conditional<std::is_signed<T>::value, long long, unsigned long long>::type sum_t;
+		sum_t sum = 0;
+		unsigned long long sumsq = 0, count = 0;
+		T vmin = std::numeric_limits<T>::max(), vmax = std::numeric_limits<T>::lowest();
+		if (valid == nullptr) {
+			for (size_t i = 0; i < n; i++) {
+				T v = vals[i];
+				vmin = v < vmin ? v : vmin;
+				vmax = v > vmax ? v : vmax;
+				sum += v;
+				sumsq += (unsigned long long)((long long)v * v);
+			}
+			count = n;
+		} else {
+			for (size_t i = 0; i < n; i++) {
+				T v = vals[i];
+				sum_t m = valid[i];
+				vmin = (valid[i] && v < vmin) ? v : vmin;
+				vmax = (valid[i] && v > vmax) ? v : vmax;
+				sum += m * v;
+				sumsq += (unsigned long long)(m * ((long long)v * v));
+				count += valid[i];
+			}
+		}
+		if (count == 0) {
+			return;
+		}
+		double mean = (double)sum / (double)count;
+		double m2 = (double)sumsq - (double)sum * mean;
+		acc.merge(count, vmin, vmax, mean, m2 > 0 ? m2 : 0);
+	}
+};
+
+template <typename T>
+struct godalBlockMoments<T, false> {
+	static void compute(const T *vals, const GByte *valid, size_t n, godalStatsAccumulator &acc) {
+		double sum = 0;
+		unsigned long long count = 0;
+		double vmin = std::numeric_limits<double>::infinity(), vmax = -std::numeric_limits<double>::infinity();
+		for (size_t i = 0; i < n; i++) {
+			if (valid == nullptr || valid[i]) {
+				double v = (double)vals[i];
+				vmin = std::min(vmin, v);
+				vmax = std::max(vmax, v);
+				sum += v;
+				count++;
+			}
+		}
+		if (count == 0) {
+			return;
+		}
+		double mean = sum / (double)count;
+		double m2 = 0;
+		for (size_t i = 0; i < n; i++) {
+			if (valid == nullptr || valid[i]) {
+				double d = (double)vals[i] - mean;
+				m2 += d * d;
+			}
+		}
+		acc.merge(count, vmin, vmax, mean, m2);
+	}
+};
+
+/* godalBlockHistogram adds the valid values of a window to the histogram of acc, with the
+   same bucketing as GDALGetRasterHistogramEx: buckets span [histMin,histMax), i.e. a value
+   equal to histMax is out of range */
+template <typename T>
+static void godalBlockHistogram(const T *vals, const GByte *valid, size_t n, const godalBandStats &bs, bool includeOut,
+								godalStatsAccumulator &acc) {
+	double scale = bs.nBuckets / (bs.histMax - bs.histMin);
+	unsigned long long *hist = acc.hist.data();
+	for (size_t i = 0; i < n; i++) {
+		if (valid != nullptr && !valid[i]) {
+			continue;
+		}
+		//compared as a double, as out of range values may not fit in an int
+		double b = std::floor(((double)vals[i] - bs.histMin) * scale);
+		int idx;
+		if (b < 0) {
+			if (!includeOut) {
+				continue;
+			}
+			idx = 0;
+		} else if (b >= bs.nBuckets) {
+			if (!includeOut) {
+				continue;
+			}
+			idx = bs.nBuckets - 1;
+		} else {
+			idx = (int)b;
+		}
+		hist[idx]++;
+	}
+}
+
+/* godalBlockStats adds the values of a window to acc. valid is nullptr if all the values are
+   known to be valid, or else holds the mask of the window that is updated with the nodata
+   and NaN values */
+template <typename T>
+static void godalBlockStats(const void *buf, GByte *valid, size_t n, bool hasNodata, double nodata,
+							const godalBandStats &bs, bool includeOut, godalStatsAccumulator &acc) {
+	const T *vals = (const T *)buf;
+	if (valid != nullptr) {
+		godalValidity<T>(vals, n, hasNodata, nodata, valid);
+	}
+	godalBlockMoments<T>::compute(vals, valid, n, acc);
+	if (bs.nBuckets > 0) {
+		godalBlockHistogram<T>(vals, valid, n, bs, includeOut, acc);
+	}
+}
+
+/* godalStatsBand describes how the values of a band are read and validated */
+struct godalStatsBand {
+	GDALDataType type;		/* type the values are read as */
+	bool readMask;			/* the mask band must be read */
+	bool useValid;			/* values must be validated */
+	bool hasNodata;
+	double nodata;
+};
+
+static CPLErr godalStatsWindow(GDALDatasetH ds, int nBands, const godalBandStats *stats, const godalStatsBand *bands,
+							 int x, int y, int w, int h, bool includeOut, std::vector<GByte> &buf, std::vector<GByte> &valid,
+							 std::vector<godalStatsAccumulator> &accs) {
+	size_t n = (size_t)w * h;
+	valid.resize(n);
+	for (int b = 0; b < nBands; b++) {
+		const godalStatsBand &sb = bands[b];
+		GDALRasterBandH bnd = GDALGetRasterBand(ds, stats[b].band);
+		buf.resize(n * GDALGetDataTypeSizeBytes(sb.type));
+		CPLErr ret = GDALRasterIO(bnd, GF_Read, x, y, w, h, buf.data(), w, h, sb.type, 0, 0);
+		if (ret != CE_None) {
+			return ret;
+		}
+		GByte *pValid = nullptr;
+		if (sb.readMask) {
+			ret = GDALRasterIO(GDALGetMaskBand(bnd), GF_Read, x, y, w, h, valid.data(), w, h, GDT_Byte, 0, 0);
+			if (ret != CE_None) {
+				return ret;
+			}
+			for (size_t i = 0; i < n; i++) {
+				valid[i] = valid[i] != 0;
+			}
+			pValid = valid.data();
+		} else if (sb.useValid) {
+			std::fill(valid.begin(), valid.end(), 1);
+			pValid = valid.data();
+		}
+		switch (sb.type) {
+		case GDT_Byte:
+			godalBlockStats<GByte>(buf.data(), pValid, n, sb.hasNodata, sb.nodata, stats[b], includeOut, accs[b]);
+			break;
+		case GDT_UInt16:
+			godalBlockStats<GUInt16>(buf.data(), pValid, n, sb.hasNodata, sb.nodata, stats[b], includeOut, accs[b]);
+			break;
+		case GDT_Int16:
+			godalBlockStats<GInt16>(buf.data(), pValid, n, sb.hasNodata, sb.nodata, stats[b], includeOut, accs[b]);
+			break;
+		case GDT_UInt32:
+			godalBlockStats<GUInt32>(buf.data(), pValid, n, sb.hasNodata, sb.nodata, stats[b], includeOut, accs[b]);
+			break;
+		case GDT_Int32:
+			godalBlockStats<GInt32>(buf.data(), pValid, n, sb.hasNodata, sb.nodata, stats[b], includeOut, accs[b]);
+			break;
+		case GDT_Float32:
+			godalBlockStats<float>(buf.data(), pValid, n, sb.hasNodata, sb.nodata, stats[b], includeOut, accs[b]);
+			break;
+		default:
+			godalBlockStats<double>(buf.data(), pValid, n, sb.hasNodata, sb.nodata, stats[b], includeOut, accs[b]);
+			break;
+		}
+	}
+	return CE_None;
+}
+
+void godalDatasetStatistics(cctx *ctx, GDALDatasetH ds, int nBands, godalBandStats *stats, int bIncludeOutOfRange, int nThreads) {
+	godalWrap(ctx);
+	std::vector<godalStatsBand> bands(nBands);
+	for (int b = 0; b < nBands; b++) {
+		GDALRasterBandH bnd = GDALGetRasterBand(ds, stats[b].band);
+		if (bnd == nullptr) {
+			CPLError(CE_Failure, CPLE_AppDefined, "invalid band %d", stats[b].band);
+			godalUnwrap();
+			return;
+		}
+		GDALDataType dtype = GDALGetRasterDataType(bnd);
+		if (GDALDataTypeIsComplex(dtype)) {
+			CPLError(CE_Failure, CPLE_NotSupported, "statistics of complex band %d are not supported", stats[b].band);
+			godalUnwrap();
+			return;
+		}
+		if (stats[b].nBuckets > 0 && !(stats[b].histMax > stats[b].histMin)) {
+			CPLError(CE_Failure, CPLE_IllegalArg, "histogram range [%g,%g] is empty", stats[b].histMin, stats[b].histMax);
+			godalUnwrap();
+			return;
+		}
+		godalStatsBand &sb = bands[b];
+		switch (dtype) {
+		case GDT_Byte:
+		case GDT_UInt16:
+		case GDT_Int16:
+		case GDT_UInt32:
+		case GDT_Int32:
+		case GDT_Float32:
+		case GDT_Float64:
+			sb.type = dtype;
+			break;
+		default:
+			sb.type = GDT_Float64;
+			break;
+		}
+		int flags = GDALGetMaskFlags(bnd);
+		int hasNodata = 0;
+		sb.nodata = GDALGetRasterNoDataValue(bnd, &hasNodata);
+		sb.hasNodata = (flags & GMF_NODATA) && hasNodata;
+		sb.readMask = !(flags & GMF_ALL_VALID) && !sb.hasNodata;
+		sb.useValid = sb.readMask || sb.hasNodata || sb.type == GDT_Float32 || sb.type == GDT_Float64;
+	}
+
+	int sx = GDALGetRasterXSize(ds), sy = GDALGetRasterYSize(ds);
+	int bsx = 256, bsy = 256;
+	if (nBands > 0) {
+		GDALGetBlockSize(GDALGetRasterBand(ds, stats[0].band), &bsx, &bsy);
+	}
+	//windows are made of whole blocks, and span at least 512x512 pixels when possible
+	int wx = std::min(sx, bsx * std::max(1, 512 / bsx));
+	int wy = std::min(sy, bsy * std::max(1, (512 * 512) / (wx * bsy)));
+	int nwx = (sx + wx - 1) / wx, nwy = (sy + wy - 1) / wy;
+	int nWindows = nwx * nwy;
+	if (nThreads > nWindows) {
+		nThreads = nWindows;
+	}
+	bool includeOut = bIncludeOutOfRange != 0;
+
+	std::vector<GDALDatasetH> handles = godalReopenDataset(ds, nThreads - 1);
+	std::vector<std::vector<godalStatsAccumulator>> accs(handles.size() + 1, std::vector<godalStatsAccumulator>(nBands));
+	std::vector<cctx> wctxs(handles.size() + 1);
+	std::atomic<int> next(0);
+	auto worker = [&](GDALDatasetH wds, size_t t) {
+		cctx &wctx = wctxs[t];
+		godalWorkerContext(&wctx, ctx);
+		godalWrapCall(&wctx, "godalDatasetStatistics");
+		for (int b = 0; b < nBands; b++) {
+			accs[t][b].hist.resize(stats[b].nBuckets);
+		}
+		std::vector<GByte> buf, valid;
+		for (int i = next++; i < nWindows && !failed(&wctx); i = next++) {
+			int x = (i % nwx) * wx, y = (i / nwx) * wy;
+			CPLErr ret = godalStatsWindow(wds, nBands, stats, bands.data(), x, y, std::min(wx, sx - x), std::min(wy, sy - y),
+										  includeOut, buf, valid, accs[t]);
+			if (ret != CE_None) {
+				forceCPLError(&wctx, ret);
+			}
+		}
+		godalUnwrap();
+	};
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < handles.size(); t++) {
+		threads.emplace_back(worker, handles[t], t + 1);
+	}
+	worker(ds, 0);
+	for (std::thread &t : threads) {
+		t.join();
+	}
+	for (GDALDatasetH h : handles) {
+		GDALClose(h);
+	}
+
+	godalMergeWorkerContexts(ctx, wctxs);
+	for (int b = 0; b < nBands; b++) {
+		godalStatsAccumulator &acc = accs[0][b];
+		for (size_t t = 1; t < accs.size(); t++) {
+			acc.merge(accs[t][b]);
+		}
+		godalBandStats &bs = stats[b];
+		bs.count = acc.count;
+		bs.min = acc.count > 0 ? acc.min : 0;
+		bs.max = acc.count > 0 ? acc.max : 0;
+		bs.mean = acc.mean;
+		bs.stdDev = acc.count > 0 ? std::sqrt(acc.m2 / (double)acc.count) : 0;
+		if (bs.nBuckets > 0) {
+			std::copy(acc.hist.begin(), acc.hist.end(), (unsigned long long *)bs.buckets);
+		}
+	}
+	godalUnwrap();
+}
+
 OGRGeometryH godalNewGeometryFromWKT(cctx *ctx, char *wkt, OGRSpatialReferenceH sr) {
 	godalWrap(ctx);
 	OGRGeometryH gptr = nullptr;
@@ -915,6 +2928,219 @@ void godalGeometryTransform(cctx *ctx, OGRGeometryH geom, OGRCoordinateTransform
 	godalUnwrap();
 }
 
+struct godalGeometryBatchData {
+	std::vector<std::string> encoded;
+	std::vector<char> data;
+	std::vector<long long> offsets;
+	std::vector<char *> errMessages;
+	std::vector<int> failed;
+	godalGeometryBatch batch;
+};
+
+/* godalGeometryRun applies the operations to a single geometry of a batch, recording its
+   errors in the batch data. trns holds the (thread specific) transformations used by the
+   godalGeomTransform operations */
+static void godalGeometryRun(cctx *ctx, godalGeometryBatchData *data, int i, OGRGeometryH in, const unsigned char *wkb, int wkbLen,
+							 int nOps, const godalGeometryOp *ops, const OGRCoordinateTransformationH *trns,
+							 godalGeometryEncoding encoding, int precision) {
+	cctx wctx;
+	wctx.errMessage = nullptr;
+	wctx.handlerIdx = ctx->handlerIdx;
+	wctx.failed = 0;
+	wctx.configOptions = ctx->configOptions;
+	wctx.progressIdx = 0;
+	godalWrapCall(&wctx, "godalProcessGeometries");
+	OGRGeometryH owned = nullptr;
+	if (in == nullptr && wkbLen > 0) {
+		OGRErr gret = OGR_G_CreateFromWkb(wkb, nullptr, &owned, wkbLen);
+		if (gret != OGRERR_NONE) {
+			forceOGRError(&wctx, gret);
+			owned = nullptr;
+		}
+	}
+	OGRGeometryH geom = in != nullptr ? in : owned;
+	for (int o = 0; o < nOps && geom != nullptr && !failed(&wctx); o++) {
+		OGRGeometryH next = nullptr;
+		switch (ops[o].op) {
+		case godalGeomTransform: {
+			//transformations are done in place, the input geometries must be left untouched
+			if (owned == nullptr) {
+				owned = OGR_G_Clone(geom);
+				geom = owned;
+			}
+			OGRErr gret = OGR_G_Transform(geom, trns[o]);
+			if (gret != OGRERR_NONE) {
+				forceOGRError(&wctx, gret);
+			}
+			continue;
+		}
+		case godalGeomSimplify:
+			next = OGR_G_Simplify(geom, ops[o].distance);
+			break;
+		case godalGeomBuffer:
+			next = OGR_G_Buffer(geom, ops[o].distance, ops[o].segments);
+			break;
+		}
+		if (next == nullptr) {
+			forceError(&wctx);
+			break;
+		}
+		if (owned != nullptr) {
+			OGR_G_DestroyGeometry(owned);
+		}
+		owned = next;
+		geom = next;
+	}
+	std::string &out = data->encoded[i];
+	if (geom != nullptr && !failed(&wctx)) {
+		switch (encoding) {
+		case godalEncodeWKB: {
+			out.resize(OGR_G_WkbSize(geom));
+			OGRErr gret = OGR_G_ExportToIsoWkb(geom, wkbNDR, (unsigned char *)&out[0]);
+			if (gret != OGRERR_NONE) {
+				forceOGRError(&wctx, gret);
+			}
+			break;
+		}
+		case godalEncodeWKT: {
+			char *wkt = nullptr;
+			OGRErr gret = OGR_G_ExportToWkt(geom, &wkt);
+			if (gret != OGRERR_NONE) {
+				forceOGRError(&wctx, gret);
+			} else if (wkt == nullptr) {
+				forceError(&wctx);
+			} else {
+				out = wkt;
+			}
+			CPLFree(wkt);
+			break;
+		}
+		case godalEncodeGeoJSON: {
+			char precOpt[64];
+			snprintf(precOpt, 64, "COORDINATE_PRECISION=%d", precision);
+			char *opts[2] = {precOpt, nullptr};
+			char *gj = OGR_G_ExportToJsonEx(geom, opts);
+			if (gj == nullptr) {
+				forceError(&wctx);
+			} else {
+				out = gj;
+			}
+			CPLFree(gj);
+			break;
+		}
+		}
+		if (failed(&wctx)) {
+			out.clear();
+		}
+	}
+	if (owned != nullptr) {
+		OGR_G_DestroyGeometry(owned);
+	}
+	godalUnwrap();
+	data->errMessages[i] = wctx.errMessage;
+	data->failed[i] = failed(&wctx);
+}
+
+godalGeometryBatch *godalProcessGeometries(cctx *ctx, int nGeometries, OGRGeometryH *geoms, uintptr_t wkb, uintptr_t wkbOffsets,
+										   int nOps, godalGeometryOp *ops, godalGeometryEncoding encoding, int precision, int nThreads) {
+	godalWrap(ctx);
+	const unsigned char *pWKB = (const unsigned char *)wkb;
+	const long long *pWKBOffsets = (const long long *)wkbOffsets;
+	godalGeometryBatchData *data = new godalGeometryBatchData;
+	data->encoded.resize(nGeometries);
+	data->errMessages.resize(nGeometries, nullptr);
+	data->failed.resize(nGeometries, 0);
+	if (nThreads > nGeometries) {
+		nThreads = nGeometries;
+	}
+
+	/* coordinate transformations cannot be used concurrently, so each additional thread
+	   transforms with its own copy of the transformations */
+	std::vector<std::vector<OGRCoordinateTransformationH>> trns(1, std::vector<OGRCoordinateTransformationH>(nOps, nullptr));
+	bool transforms = false;
+	for (int o = 0; o < nOps; o++) {
+		trns[0][o] = ops[o].trn;
+		transforms = transforms || ops[o].op == godalGeomTransform;
+	}
+	if (transforms) {
+#if GDAL_VERSION_NUM >= GDAL_COMPUTE_VERSION(3, 1, 0)
+		for (int t = 1; t < nThreads; t++) {
+			std::vector<OGRCoordinateTransformationH> ttrns(nOps, nullptr);
+			bool ok = true;
+			for (int o = 0; o < nOps && ok; o++) {
+				if (ops[o].op == godalGeomTransform) {
+					ttrns[o] = OCTClone(ops[o].trn);
+					ok = ttrns[o] != nullptr;
+				}
+			}
+			if (!ok) {
+				for (OGRCoordinateTransformationH trn : ttrns) {
+					if (trn != nullptr) {
+						OCTDestroyCoordinateTransformation(trn);
+					}
+				}
+				break;
+			}
+			trns.push_back(ttrns);
+		}
+#endif
+		nThreads = (int)trns.size();
+	}
+
+	std::atomic<int> next(0);
+	auto worker = [&](const OGRCoordinateTransformationH *wtrns) {
+		for (int i = next++; i < nGeometries; i = next++) {
+			if (geoms != nullptr) {
+				godalGeometryRun(ctx, data, i, geoms[i], nullptr, 0, nOps, ops, wtrns, encoding, precision);
+			} else {
+				godalGeometryRun(ctx, data, i, nullptr, pWKB + pWKBOffsets[i], (int)(pWKBOffsets[i + 1] - pWKBOffsets[i]),
+								 nOps, ops, wtrns, encoding, precision);
+			}
+		}
+	};
+	std::vector<std::thread> threads;
+	for (int t = 1; t < nThreads; t++) {
+		threads.emplace_back(worker, trns[t].data());
+	}
+	worker(trns[0].data());
+	for (std::thread &t : threads) {
+		t.join();
+	}
+	for (size_t t = 1; t < trns.size(); t++) {
+		for (OGRCoordinateTransformationH trn : trns[t]) {
+			if (trn != nullptr) {
+				OCTDestroyCoordinateTransformation(trn);
+			}
+		}
+	}
+
+	size_t size = 0;
+	for (const std::string &s : data->encoded) {
+		size += s.size();
+	}
+	data->data.reserve(size);
+	data->offsets.reserve(nGeometries + 1);
+	data->offsets.push_back(0);
+	for (std::string &s : data->encoded) {
+		data->data.insert(data->data.end(), s.begin(), s.end());
+		data->offsets.push_back(data->data.size());
+		std::string().swap(s);
+	}
+	godalGeometryBatch *batch = &data->batch;
+	batch->nGeometries = nGeometries;
+	batch->data = data->data.data();
+	batch->offsets = data->offsets.data();
+	batch->errMessages = data->errMessages.data();
+	batch->failed = data->failed.data();
+	batch->priv = data;
+	godalUnwrap();
+	return batch;
+}
+
+void godalFreeGeometryBatch(godalGeometryBatch *batch) {
+	delete (godalGeometryBatchData *)batch->priv;
+}
+
 OGRFeatureH godalLayerNewFeature(cctx *ctx, OGRLayerH layer, OGRGeometryH geom) {
 	godalWrap(ctx);
 	OGRFeatureH hFeature = OGR_F_Create( OGR_L_GetLayerDefn( layer ) );
@@ -924,11 +3150,11 @@ OGRFeatureH godalLayerNewFeature(cctx *ctx, OGRLayerH layer, OGRGeometryH geom)
 		return nullptr;
 	}
 	OGRErr oe=OGRERR_NONE;
-	if (hFeature!=nullptr && geom!=nullptr) {
+	if (geom!=nullptr) {
 		oe = OGR_F_SetGeometry(hFeature,geom);
-		if (oe != OGRERR_NONE) {
-			oe = OGR_L_SetFeature(layer,hFeature);
-		}
+	}
+	if (oe == OGRERR_NONE) {
+		oe = OGR_L_CreateFeature(layer,hFeature);
 	}
 	if(oe != OGRERR_NONE) {
 		forceOGRError(ctx,oe);
@@ -941,32 +3167,307 @@ OGRFeatureH godalLayerNewFeature(cctx *ctx, OGRLayerH layer, OGRGeometryH geom)
 	return hFeature;
 }
 
-GDALDatasetH godalBuildVRT(cctx *ctx, char *dstName, char **sources, char **switches) {
-	godalWrap(ctx);
-	GDALBuildVRTOptions *ropts = GDALBuildVRTOptionsNew(switches,nullptr);
-	if(failed(ctx)) {
-		GDALBuildVRTOptionsFree(ropts);
-		godalUnwrap();
-		return nullptr;
-	}
-	int usageErr=0;
-	int nSources = 0;
-	char **src = sources;
-	for( char **src = sources; *src; src++) {
-		nSources++;
-	}
+GDALDatasetH godalBuildVRT(cctx *ctx, char *dstName, char **sources, char **switches) {
+	godalWrap(ctx);
+	GDALBuildVRTOptions *ropts = GDALBuildVRTOptionsNew(switches,nullptr);
+	if(failed(ctx)) {
+		GDALBuildVRTOptionsFree(ropts);
+		godalUnwrap();
+		return nullptr;
+	}
+	GDALBuildVRTOptionsSetProgress(ropts,godalProgressFunc(ctx),godalProgressArg(ctx));
+	int usageErr=0;
+	int nSources = 0;
+	char **src = sources;
+	for( char **src = sources; *src; src++) {
+		nSources++;
+	}
+
+	GDALDatasetH ret = GDALBuildVRT(dstName, nSources, nullptr, sources, ropts, &usageErr);
+	GDALBuildVRTOptionsFree(ropts);
+	if(ret==nullptr || usageErr!=0) {
+		forceError(ctx);
+	}
+	godalUnwrap();
+	return ret;
+}
+
+namespace cpl
+{
+
+    /************************************************************************/
+    /*                         VSIGoBlockCache                            */
+    /************************************************************************/
+
+    /* VSIGoBlockCache is a LRU cache of fixed-size blocks shared by all the handles
+       opened through a given VSIGoFilesystemHandler. It is safe for concurrent use.
+       Blocks are reference counted so that a block returned by Get() remains valid
+       after it has been evicted. */
+    class VSIGoBlockCache
+    {
+        CPL_DISALLOW_COPY_ASSIGN(VSIGoBlockCache)
+    public:
+        typedef std::shared_ptr<const std::string> Block;
+
+        VSIGoBlockCache(size_t blockSize, size_t budget);
+
+        size_t BlockSize() const { return m_blockSize; }
+        Block Get(const std::string &filename, vsi_l_offset block);
+        void Put(const std::string &filename, vsi_l_offset block, const Block &data);
+        void Invalidate(const std::string &prefix);
+
+    private:
+        typedef std::pair<std::string, vsi_l_offset> Key;
+        struct KeyHash
+        {
+            size_t operator()(const Key &k) const
+            {
+                size_t h = std::hash<std::string>()(k.first);
+                return h ^ (std::hash<vsi_l_offset>()(k.second) + 0x9e3779b9 + (h << 6) + (h >> 2));
+            }
+        };
+        typedef std::list<std::pair<Key, Block>> LRU;
+
+        size_t m_blockSize, m_budget, m_used;
+        std::mutex m_mutex;
+        LRU m_lru; /* most recently used first */
+        std::unordered_map<Key, LRU::iterator, KeyHash> m_index;
+    };
+
+    VSIGoBlockCache::VSIGoBlockCache(size_t blockSize, size_t budget)
+        : m_blockSize(blockSize), m_budget(budget), m_used(0) {}
+
+    VSIGoBlockCache::Block VSIGoBlockCache::Get(const std::string &filename, vsi_l_offset block)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(Key(filename, block));
+        if (it == m_index.end())
+        {
+            return Block();
+        }
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+        return it->second->second;
+    }
+
+    void VSIGoBlockCache::Put(const std::string &filename, vsi_l_offset block, const Block &data)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Key key(filename, block);
+        auto it = m_index.find(key);
+        if (it != m_index.end())
+        {
+            m_used -= it->second->second->size();
+            m_lru.erase(it->second);
+            m_index.erase(it);
+        }
+        m_lru.emplace_front(key, data);
+        m_index[key] = m_lru.begin();
+        m_used += data->size();
+        while (m_used > m_budget && !m_lru.empty())
+        {
+            m_used -= m_lru.back().second->size();
+            m_index.erase(m_lru.back().first);
+            m_lru.pop_back();
+        }
+    }
+
+    /* Invalidate drops all the cached blocks of the files whose name starts with prefix */
+    void VSIGoBlockCache::Invalidate(const std::string &prefix)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_lru.begin(); it != m_lru.end();)
+        {
+            if (it->first.first.compare(0, prefix.size(), prefix) == 0)
+            {
+                m_used -= it->second->size();
+                m_index.erase(it->first);
+                it = m_lru.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    /************************************************************************/
+    /*                            VSIGoStats                              */
+    /************************************************************************/
+
+    /* VSIGoStats holds the i/o counters of a handler or of a single file, indexed by
+       the GODAL_VSI_* constants */
+    struct VSIGoStats
+    {
+        std::atomic<long long> counters[GODAL_VSI_NSTATS];
+        VSIGoStats()
+        {
+            for (int i = 0; i < GODAL_VSI_NSTATS; i++)
+            {
+                counters[i] = 0;
+            }
+        }
+    };
+
+    /* VSIGoStatsRef updates both the counters of a handler and of the file a handle was opened on */
+    class VSIGoStatsRef
+    {
+    public:
+        VSIGoStatsRef(VSIGoStats *handler, const std::shared_ptr<VSIGoStats> &file)
+            : m_handler(handler), m_file(file) {}
+
+        void Add(int counter, long long value = 1)
+        {
+            m_handler->counters[counter].fetch_add(value, std::memory_order_relaxed);
+            m_file->counters[counter].fetch_add(value, std::memory_order_relaxed);
+        }
+
+        /* AddRequest records a request made to the go reader, started at start */
+        void AddRequest(std::chrono::steady_clock::time_point start, int nRanges, size_t nBytes, bool failed)
+        {
+            long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            int bucket = 0;
+            for (long long limit = 1; bucket < GODAL_VSI_LATENCY_BUCKETS - 1 && ms >= limit; limit <<= 1)
+            {
+                bucket++;
+            }
+            Add(GODAL_VSI_GO_READS);
+            Add(GODAL_VSI_GO_RANGES, nRanges);
+            Add(GODAL_VSI_GO_BYTES, (long long)nBytes);
+            Add(GODAL_VSI_LATENCY + bucket);
+            if (failed)
+            {
+                Add(GODAL_VSI_ERRORS);
+            }
+        }
+
+        /* AddMultiRange records a ReadMultiRange call issued by gdal */
+        void AddMultiRange(int nRanges, const size_t *panSizes)
+        {
+            size_t nBytes = 0;
+            for (int i = 0; i < nRanges; i++)
+            {
+                nBytes += panSizes[i];
+            }
+            Add(GODAL_VSI_MULTIREADS);
+            Add(GODAL_VSI_RANGES, nRanges);
+            Add(GODAL_VSI_BYTES_REQUESTED, (long long)nBytes);
+        }
+
+    private:
+        VSIGoStats *m_handler;
+        std::shared_ptr<VSIGoStats> m_file;
+    };
 
-	GDALDatasetH ret = GDALBuildVRT(dstName, nSources, nullptr, sources, ropts, &usageErr);
-	GDALBuildVRTOptionsFree(ropts);
-	if(ret==nullptr || usageErr!=0) {
-		forceError(ctx);
-	}
-	godalUnwrap();
-	return ret;
-}
+    /* VSIGoStatsHandle counts the requests issued by gdal on a handle that wraps a VSIGoHandle,
+       i.e. before they are served by the VSICreateCachedFile layer */
+    class VSIGoStatsHandle : public VSIVirtualHandle
+    {
+        CPL_DISALLOW_COPY_ASSIGN(VSIGoStatsHandle)
+    private:
+        VSIVirtualHandle *m_handle;
+        VSIGoStatsRef m_stats;
 
-namespace cpl
-{
+    public:
+        VSIGoStatsHandle(VSIVirtualHandle *handle, const VSIGoStatsRef &stats) : m_handle(handle), m_stats(stats) {}
+        ~VSIGoStatsHandle() override { delete m_handle; }
+
+        vsi_l_offset Tell() override { return m_handle->Tell(); }
+        int Seek(vsi_l_offset nOffset, int nWhence) override { return m_handle->Seek(nOffset, nWhence); }
+        size_t Read(void *pBuffer, size_t nSize, size_t nCount) override
+        {
+            m_stats.Add(GODAL_VSI_READS);
+            m_stats.Add(GODAL_VSI_BYTES_REQUESTED, (long long)(nSize * nCount));
+            return m_handle->Read(pBuffer, nSize, nCount);
+        }
+        int ReadMultiRange(int nRanges, void **ppData, const vsi_l_offset *panOffsets, const size_t *panSizes) override
+        {
+            m_stats.AddMultiRange(nRanges, panSizes);
+            return m_handle->ReadMultiRange(nRanges, ppData, panOffsets, panSizes);
+        }
+        VSIRangeStatus GetRangeStatus(vsi_l_offset nOffset, vsi_l_offset nLength) override { return m_handle->GetRangeStatus(nOffset, nLength); }
+        int Eof() override { return m_handle->Eof(); }
+        int Close() override { return m_handle->Close(); }
+        size_t Write(const void *pBuffer, size_t nSize, size_t nCount) override { return m_handle->Write(pBuffer, nSize, nCount); }
+        int Flush() override { return m_handle->Flush(); }
+        int Truncate(vsi_l_offset nNewSize) override { return m_handle->Truncate(nNewSize); }
+    };
+
+    /************************************************************************/
+    /*                          VSIGoWorkerPool                           */
+    /************************************************************************/
+
+    /* VSIGoWorkerPool runs the background reads of the handles of a handler on at most
+       nThreads persistent threads, which are started on demand */
+    class VSIGoWorkerPool
+    {
+        CPL_DISALLOW_COPY_ASSIGN(VSIGoWorkerPool)
+    public:
+        explicit VSIGoWorkerPool(int nThreads) : m_max(nThreads), m_idle(0), m_stop(false) {}
+        ~VSIGoWorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cond.notify_all();
+            for (std::thread &t : m_threads)
+            {
+                t.join();
+            }
+        }
+
+        /* Submit queues task, and returns false if there is no thread to run it */
+        bool Submit(std::function<void()> task)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_idle <= (int)m_tasks.size() && (int)m_threads.size() < m_max)
+            {
+                try
+                {
+                    m_threads.emplace_back(&VSIGoWorkerPool::run, this);
+                }
+                catch (const std::exception &)
+                {
+                    /* queue the task on the existing threads, if any */
+                }
+            }
+            if (m_threads.empty())
+            {
+                return false;
+            }
+            m_tasks.push_back(std::move(task));
+            m_cond.notify_one();
+            return true;
+        }
+
+    private:
+        int m_max, m_idle;
+        bool m_stop;
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::deque<std::function<void()>> m_tasks;
+        std::vector<std::thread> m_threads;
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            for (;;)
+            {
+                m_idle++;
+                m_cond.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+                m_idle--;
+                if (m_tasks.empty())
+                {
+                    return;
+                }
+                std::function<void()> task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                lock.unlock();
+                task();
+                lock.lock();
+            }
+        }
+    };
 
     /************************************************************************/
     /*                     VSIGoFilesystemHandler                         */
@@ -976,12 +3477,45 @@ namespace cpl
     {
         CPL_DISALLOW_COPY_ASSIGN(VSIGoFilesystemHandler)
     private:
-        size_t m_buffer, m_cache;
+        std::string m_prefix;
+        int m_id; /* index of the go VSIKeyReader */
+        size_t m_buffer, m_cache, m_gap, m_prefetch, m_partSize;
+        int m_readahead;
+        VSIGoBlockCache *m_blocks;
+        VSIGoWorkerPool *m_workers; /* runs the read-ahead fetches of all the handles */
+
+        /* cached results of _gogdalSizeCallback. A size of -1 denotes a missing key, in which
+           case err holds the error message returned by the go handler */
+        struct statEntry
+        {
+            long long size;
+            std::string err;
+            std::chrono::steady_clock::time_point expires;
+        };
+        std::chrono::nanoseconds m_statTTL, m_negStatTTL;
+        std::mutex m_statMutex;
+        std::unordered_map<std::string, statEntry> m_stats;
+
+        /* i/o counters of the whole handler, and of each file */
+        VSIGoStats m_ioStats;
+        std::mutex m_fileStatsMutex;
+        std::unordered_map<std::string, std::shared_ptr<VSIGoStats>> m_fileStats;
+        VSIGoStatsRef statsRef(const std::string &filename);
+
+        bool cachedSize(const std::string &filename, long long *size, char **err);
+        void cacheSize(const std::string &filename, long long size, const char *err);
+        long long getSize(const char *pszFilename, char **err);
+        /* goKey returns the key passed to the go handler, i.e. pszFilename without the prefix */
+        char *goKey(const char *pszFilename) { return (char *)pszFilename + m_prefix.size(); }
 
     public:
-        VSIGoFilesystemHandler(size_t bufferSize, size_t cacheSize);
+        VSIGoFilesystemHandler(const char *pszPrefix, int handlerID, size_t bufferSize, size_t cacheSize, size_t mergeGap, size_t sharedCacheSize,
+                               long long statTTL, long long negStatTTL, size_t prefetch, size_t partSize, int readAhead);
         ~VSIGoFilesystemHandler() override;
 
+        void Invalidate(const char *pszPrefix);
+        void GetStats(const char *pszPath, long long *stats);
+
 		VSIVirtualHandle *Open(const char *pszFilename,
 							   const char *pszAccess,
 							   bool bSetError
@@ -995,22 +3529,50 @@ namespace cpl
         char **SiblingFiles(const char *pszFilename) override;
 #endif
         int HasOptimizedReadMultiRange(const char *pszPath) override;
+#if GDAL_VERSION_NUM >= 3020000
+        bool SupportsSequentialWrite(const char *pszPath, bool bAllowLocalTempFile) override;
+        bool SupportsRandomWrite(const char *pszPath, bool bAllowLocalTempFile) override;
+#endif
     };
 
     /************************************************************************/
     /*                           VSIGoHandle                              */
     /************************************************************************/
 
+    class VSIGoReadAhead;
+    class VSIGoWorkerPool;
+
     class VSIGoHandle : public VSIVirtualHandle
     {
         CPL_DISALLOW_COPY_ASSIGN(VSIGoHandle)
     private:
         char *m_filename;
+        int m_id; /* id of the go VSIReader */
         vsi_l_offset m_cur, m_size;
+        size_t m_gap;
+        VSIGoBlockCache *m_blocks;
+        VSIGoReadAhead *m_readahead;
+        std::string m_head; /* bytes prefetched from the start of the file */
         int m_eof;
+        VSIGoStatsRef m_stats;
+        bool m_countRequests; /* false if requests are counted by a wrapping VSIGoStatsHandle */
+
+        /* sorted (offset,length) ranges of the file that contain data, as reported by a go
+           VSIExtentsReader. Loaded on first use, and never looked up for readers that do not
+           implement VSIExtentsReader. m_hasExtents is false if not available */
+        std::vector<std::pair<vsi_l_offset, vsi_l_offset>> m_extents;
+        bool m_extentsLoaded, m_hasExtents;
+
+        int fetchRanges(int nRanges, void **ppData, const vsi_l_offset *panOffsets, const size_t *panSizes);
+        int goMultiRead(int nRanges, void **ppData, const vsi_l_offset *panOffsets, const size_t *panSizes, char **err);
+        int readCached(int nRanges, void **ppData, const vsi_l_offset *panOffsets, const size_t *panSizes);
+        void loadExtents();
+        bool isHole(vsi_l_offset nOffset, vsi_l_offset nLength);
 
     public:
-        VSIGoHandle(const char *filename, vsi_l_offset size);
+        VSIGoHandle(const char *filename, int readerID, vsi_l_offset size, size_t mergeGap, VSIGoBlockCache *blocks, std::string head,
+                    size_t readAheadBlockSize, int readAheadBlocks, VSIGoWorkerPool *workers, const VSIGoStatsRef &stats, bool countRequests,
+                    bool extents);
         ~VSIGoHandle() override;
 
         vsi_l_offset Tell() override;
@@ -1025,16 +3587,414 @@ namespace cpl
         int Truncate(vsi_l_offset nNewSize) override;
     };
 
-    VSIGoHandle::VSIGoHandle(const char *filename, vsi_l_offset size)
+    /* goReadErr reads len bytes at off from the go reader, setting err on failure */
+    static size_t goReadErr(int readerID, void *pBuffer, vsi_l_offset off, size_t len, char **err, VSIGoStatsRef *stats)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        size_t n = _gogdalReadCallback(readerID, pBuffer, off, len, err);
+        stats->AddRequest(start, 1, len, *err != nullptr);
+        return n;
+    }
+
+    /* goRead reads len bytes at off from the go reader, returning (size_t)-1 on error */
+    static size_t goRead(int readerID, void *pBuffer, vsi_l_offset off, size_t len, VSIGoStatsRef *stats)
+    {
+        char *err = nullptr;
+        size_t n = goReadErr(readerID, pBuffer, off, len, &err, stats);
+        if (err)
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "%s", err);
+            errno = EIO;
+            free(err);
+            return (size_t)-1;
+        }
+        return n;
+    }
+
+    /************************************************************************/
+    /*                          VSIGoReadAhead                            */
+    /************************************************************************/
+
+    /* VSIGoReadAhead detects sequential reads on a handle, and then keeps fetching the
+       nBlocks blocks following the current position on the worker threads of its handler */
+    class VSIGoReadAhead
+    {
+        CPL_DISALLOW_COPY_ASSIGN(VSIGoReadAhead)
+    public:
+        VSIGoReadAhead(int readerID, vsi_l_offset size, size_t blockSize, int nBlocks, VSIGoWorkerPool *workers, VSIGoStatsRef *stats);
+        ~VSIGoReadAhead();
+
+        /* Read returns the number of bytes read at off, or (size_t)-1 on error */
+        size_t Read(void *pBuffer, vsi_l_offset off, size_t len);
+
+    private:
+        struct block
+        {
+            vsi_l_offset off;
+            std::string data;
+            size_t nread;
+            std::string err;
+            bool done;
+        };
+
+        int m_id;
+        VSIGoWorkerPool *m_workers;
+        VSIGoStatsRef *m_stats;
+        vsi_l_offset m_size, m_lastEnd, m_next;
+        size_t m_blockSize;
+        int m_nBlocks, m_sequential;
+        std::deque<std::shared_ptr<block>> m_ring;
+
+        std::mutex m_mutex; /* protects the done, nread and err fields of the blocks, m_inflight and m_closing */
+        std::condition_variable m_cond;
+        int m_inflight;
+        bool m_closing; /* set once the handle is closed, so that queued fetches are skipped */
+
+        void schedule();
+        void fetch(std::shared_ptr<block> b);
+    };
+
+    VSIGoReadAhead::VSIGoReadAhead(int readerID, vsi_l_offset size, size_t blockSize, int nBlocks, VSIGoWorkerPool *workers, VSIGoStatsRef *stats)
+        : m_id(readerID), m_workers(workers), m_stats(stats), m_size(size), m_lastEnd(0), m_next(0), m_blockSize(blockSize),
+          m_nBlocks(nBlocks), m_sequential(0), m_inflight(0), m_closing(false) {}
+
+    VSIGoReadAhead::~VSIGoReadAhead()
+    {
+        /* the go reader must not be released while it is still being read from, and the
+           queued fetches must have run before this is destroyed */
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_closing = true;
+        m_cond.wait(lock, [this] { return m_inflight == 0; });
+    }
+
+    void VSIGoReadAhead::fetch(std::shared_ptr<block> b)
+    {
+        char *err = nullptr;
+        size_t n = 0;
+        bool closing;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            closing = m_closing;
+        }
+        if (!closing)
+        {
+            n = goReadErr(m_id, &b->data[0], b->off, b->data.size(), &err, m_stats);
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        b->nread = n;
+        if (err)
+        {
+            b->err = err;
+            free(err);
+        }
+        b->done = true;
+        m_inflight--;
+        m_cond.notify_all();
+    }
+
+    /* schedule starts fetching blocks until m_nBlocks are queued */
+    void VSIGoReadAhead::schedule()
+    {
+        while ((int)m_ring.size() < m_nBlocks && m_next < m_size)
+        {
+            std::shared_ptr<block> b = std::make_shared<block>();
+            b->off = m_next;
+            b->data.resize((m_size - m_next < m_blockSize) ? (size_t)(m_size - m_next) : m_blockSize);
+            b->nread = 0;
+            b->done = false;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_inflight++;
+            }
+            if (!m_workers->Submit([this, b] { fetch(b); }))
+            {
+                /* no worker thread available, the next reads will be synchronous */
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_inflight--;
+                return;
+            }
+            m_ring.push_back(b);
+            m_next += b->data.size();
+        }
+    }
+
+    size_t VSIGoReadAhead::Read(void *pBuffer, vsi_l_offset off, size_t len)
+    {
+        bool sequential = (off == m_lastEnd);
+        m_lastEnd = off + len;
+        if (!sequential)
+        {
+            /* blocks that are still in flight will complete in the background */
+            m_sequential = 0;
+            m_ring.clear();
+            return goRead(m_id, pBuffer, off, len, m_stats);
+        }
+        if (m_ring.empty() && ++m_sequential < 2)
+        {
+            return goRead(m_id, pBuffer, off, len, m_stats);
+        }
+        size_t done = 0;
+        while (done < len)
+        {
+            vsi_l_offset pos = off + done;
+            if (!m_ring.empty() && (pos < m_ring.front()->off || pos >= m_ring.front()->off + m_ring.front()->data.size()))
+            {
+                m_ring.clear();
+            }
+            if (m_ring.empty())
+            {
+                m_next = pos;
+            }
+            schedule();
+            if (m_ring.empty())
+            {
+                if (m_next < m_size)
+                {
+                    /* no background thread available */
+                    size_t n = goRead(m_id, (char *)pBuffer + done, pos, len - done, m_stats);
+                    return (n == (size_t)-1) ? n : done + n;
+                }
+                break;
+            }
+            std::shared_ptr<block> b = m_ring.front();
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cond.wait(lock, [&b] { return b->done; });
+            }
+            if (!b->err.empty())
+            {
+                CPLError(CE_Failure, CPLE_AppDefined, "%s", b->err.c_str());
+                errno = EIO;
+                m_ring.clear();
+                return (size_t)-1;
+            }
+            size_t boff = (size_t)(pos - b->off);
+            if (boff >= b->nread)
+            {
+                /* short read */
+                m_ring.clear();
+                break;
+            }
+            size_t n = b->nread - boff;
+            if (n > len - done)
+            {
+                n = len - done;
+            }
+            memcpy((char *)pBuffer + done, b->data.data() + boff, n);
+            done += n;
+            if (boff + n == b->data.size())
+            {
+                m_ring.pop_front();
+            }
+            else if (boff + n == b->nread)
+            {
+                m_ring.clear();
+                break;
+            }
+        }
+        /* keep the following blocks in flight while the caller processes this one */
+        schedule();
+        return done;
+    }
+
+    /************************************************************************/
+    /*                         VSIGoWriteHandle                           */
+    /************************************************************************/
+
+    /* VSIGoWriteHandle buffers sequential writes into parts of a fixed size that are
+       handed over to a go writer as soon as they are filled */
+    class VSIGoWriteHandle : public VSIVirtualHandle
+    {
+        CPL_DISALLOW_COPY_ASSIGN(VSIGoWriteHandle)
+    private:
+        VSIGoFilesystemHandler *m_handler;
+        char *m_filename;
+        long long m_id;
+        std::string m_part;
+        size_t m_partSize;
+        vsi_l_offset m_cur;
+        bool m_failed, m_closed;
+
+        int flushPart();
+
+    public:
+        VSIGoWriteHandle(VSIGoFilesystemHandler *handler, const char *filename, long long writerID, size_t partSize);
+        ~VSIGoWriteHandle() override;
+
+        vsi_l_offset Tell() override;
+        int Seek(vsi_l_offset nOffset, int nWhence) override;
+        size_t Read(void *pBuffer, size_t nSize, size_t nCount) override;
+        int Eof() override;
+        int Close() override;
+        size_t Write(const void *pBuffer, size_t nSize, size_t nCount) override;
+        int Flush() override;
+        int Truncate(vsi_l_offset nNewSize) override;
+    };
+
+    VSIGoWriteHandle::VSIGoWriteHandle(VSIGoFilesystemHandler *handler, const char *filename, long long writerID, size_t partSize)
+    {
+        m_handler = handler;
+        m_filename = strdup(filename);
+        m_id = writerID;
+        m_partSize = partSize;
+        m_part.reserve(partSize);
+        m_cur = 0;
+        m_failed = false;
+        m_closed = false;
+    }
+
+    VSIGoWriteHandle::~VSIGoWriteHandle()
+    {
+        Close();
+        free(m_filename);
+    }
+
+    int VSIGoWriteHandle::flushPart()
+    {
+        if (m_part.empty())
+        {
+            return 0;
+        }
+        char *err = nullptr;
+        int ret = _gogdalWriteCallback(m_id, &m_part[0], m_part.size(), &err);
+        m_part.clear();
+        if (err)
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "%s", err);
+            errno = EIO;
+            free(err);
+            ret = -1;
+        }
+        if (ret != 0)
+        {
+            m_failed = true;
+        }
+        return ret;
+    }
+
+    size_t VSIGoWriteHandle::Write(const void *pBuffer, size_t nSize, size_t nCount)
+    {
+        if (m_failed || m_closed)
+        {
+            return 0;
+        }
+        const char *src = (const char *)pBuffer;
+        size_t len = nSize * nCount;
+        while (len > 0)
+        {
+            size_t n = m_partSize - m_part.size();
+            if (n > len)
+            {
+                n = len;
+            }
+            m_part.append(src, n);
+            src += n;
+            len -= n;
+            m_cur += n;
+            if (m_part.size() == m_partSize && flushPart() != 0)
+            {
+                return 0;
+            }
+        }
+        return nCount;
+    }
+
+    int VSIGoWriteHandle::Seek(vsi_l_offset nOffset, int nWhence)
+    {
+        /* the end of file is always the current position */
+        vsi_l_offset target = (nWhence == SEEK_SET) ? nOffset : m_cur + nOffset;
+        if (target == m_cur)
+        {
+            return 0;
+        }
+        CPLError(CE_Failure, CPLE_NotSupported, "Seek not supported on go handlers opened for writing, only sequential writes are allowed");
+        return -1;
+    }
+
+    vsi_l_offset VSIGoWriteHandle::Tell()
+    {
+        return m_cur;
+    }
+
+    size_t VSIGoWriteHandle::Read(void *pBuffer, size_t nSize, size_t nCount)
+    {
+        CPLError(CE_Failure, CPLE_NotSupported, "Read not supported on go handlers opened for writing");
+        return 0;
+    }
+
+    int VSIGoWriteHandle::Eof()
+    {
+        return 0;
+    }
+
+    int VSIGoWriteHandle::Flush()
+    {
+        /* parts are only sent once they are full, or when the handle is closed */
+        return m_failed ? -1 : 0;
+    }
+
+    int VSIGoWriteHandle::Truncate(vsi_l_offset nNewSize)
+    {
+        if (nNewSize == m_cur)
+        {
+            return 0;
+        }
+        CPLError(CE_Failure, CPLE_NotSupported, "Truncate not supported on go handlers opened for writing");
+        return -1;
+    }
+
+    int VSIGoWriteHandle::Close()
+    {
+        if (m_closed)
+        {
+            return m_failed ? -1 : 0;
+        }
+        m_closed = true;
+        if (!m_failed)
+        {
+            flushPart();
+        }
+        /* the go writer is closed even after a failure so that it is released */
+        char *err = nullptr;
+        int ret = _gogdalCloseWriterCallback(m_id, &err);
+        if (err)
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "%s", err);
+            errno = EIO;
+            free(err);
+            ret = -1;
+        }
+        if (ret != 0)
+        {
+            m_failed = true;
+        }
+        m_handler->Invalidate(m_filename);
+        return m_failed ? -1 : 0;
+    }
+
+    VSIGoHandle::VSIGoHandle(const char *filename, int readerID, vsi_l_offset size, size_t mergeGap, VSIGoBlockCache *blocks, std::string head,
+                             size_t readAheadBlockSize, int readAheadBlocks, VSIGoWorkerPool *workers, const VSIGoStatsRef &stats, bool countRequests,
+                             bool extents)
+        : m_head(std::move(head)), m_stats(stats), m_countRequests(countRequests), m_extentsLoaded(!extents), m_hasExtents(false)
     {
+        m_readahead = nullptr;
+        if (readAheadBlocks > 0 && blocks == nullptr && workers != nullptr)
+        {
+            m_readahead = new VSIGoReadAhead(readerID, size, readAheadBlockSize, readAheadBlocks, workers, &m_stats);
+        }
         m_filename = strdup(filename);
+        m_id = readerID;
         m_cur = 0;
         m_eof = 0;
         m_size = size;
+        m_gap = mergeGap;
+        m_blocks = blocks;
     }
 
     VSIGoHandle::~VSIGoHandle()
     {
+        delete m_readahead;
+        _gogdalCloseCallback(m_id);
         free(m_filename);
     }
 
@@ -1088,18 +4048,61 @@ namespace cpl
 
     size_t VSIGoHandle::Read(void *pBuffer, size_t nSize, size_t nCount)
     {
+        if (m_countRequests)
+        {
+            m_stats.Add(GODAL_VSI_READS);
+            m_stats.Add(GODAL_VSI_BYTES_REQUESTED, (long long)(nSize * nCount));
+        }
         if (nSize * nCount == 0)
         {
             return 0;
         }
-        char *err = nullptr;
-        size_t read = _gogdalReadCallback(m_filename, pBuffer, m_cur, nSize * nCount, &err);
-        if (err)
+        size_t read;
+        if (m_blocks != nullptr)
         {
-            CPLError(CE_Failure, CPLE_AppDefined, "%s", err);
-            errno = EIO;
-            free(err);
-            return 0;
+            read = (m_cur < m_size) ? nSize * nCount : 0;
+            if (m_cur + read > m_size)
+            {
+                read = m_size - m_cur;
+            }
+            if (read > 0 && readCached(1, &pBuffer, &m_cur, &read) != 0)
+            {
+                return 0;
+            }
+        }
+        else
+        {
+            size_t len = nSize * nCount;
+            read = 0;
+            if (m_cur < m_head.size())
+            {
+                read = (size_t)(m_head.size() - m_cur);
+                if (read > len)
+                {
+                    read = len;
+                }
+                memcpy(pBuffer, m_head.data() + m_cur, read);
+            }
+            if (read < len && m_cur + read < m_size && isHole(m_cur + read, len - read))
+            {
+                size_t n = len - read;
+                if (m_cur + read + n > m_size)
+                {
+                    n = (size_t)(m_size - m_cur - read);
+                }
+                memset((char *)pBuffer + read, 0, n);
+                read += n;
+            }
+            else if (read < len && m_cur + read < m_size)
+            {
+                size_t n = (m_readahead != nullptr) ? m_readahead->Read((char *)pBuffer + read, m_cur + read, len - read)
+                                                    : goRead(m_id, (char *)pBuffer + read, m_cur + read, len - read, &m_stats);
+                if (n == (size_t)-1)
+                {
+                    return 0;
+                }
+                read += n;
+            }
         }
         if (read != nSize * nCount)
         {
@@ -1112,19 +4115,200 @@ namespace cpl
 
     int VSIGoHandle::ReadMultiRange(int nRanges, void **ppData, const vsi_l_offset *panOffsets, const size_t *panSizes)
     {
-        int iRange;
-        int nMergedRanges = 1;
-        for (iRange = 0; iRange < nRanges - 1; iRange++)
+        if (nRanges <= 0)
+        {
+            return 0;
+        }
+        if (m_countRequests)
+        {
+            m_stats.AddMultiRange(nRanges, panSizes);
+        }
+        if (m_blocks != nullptr)
+        {
+            return readCached(nRanges, ppData, panOffsets, panSizes);
+        }
+        loadExtents();
+        if (m_head.empty() && !m_hasExtents)
+        {
+            return fetchRanges(nRanges, ppData, panOffsets, panSizes);
+        }
+        /* serve the ranges that are entirely contained in the prefetched header or in a hole */
+        std::vector<void *> mData;
+        std::vector<vsi_l_offset> mOffsets;
+        std::vector<size_t> mSizes;
+        for (int iRange = 0; iRange < nRanges; iRange++)
+        {
+            if (panOffsets[iRange] + panSizes[iRange] <= m_head.size())
+            {
+                memcpy(ppData[iRange], m_head.data() + panOffsets[iRange], panSizes[iRange]);
+                continue;
+            }
+            if (isHole(panOffsets[iRange], panSizes[iRange]))
+            {
+                memset(ppData[iRange], 0, panSizes[iRange]);
+                continue;
+            }
+            mData.push_back(ppData[iRange]);
+            mOffsets.push_back(panOffsets[iRange]);
+            mSizes.push_back(panSizes[iRange]);
+        }
+        if (mData.empty())
+        {
+            return 0;
+        }
+        return fetchRanges((int)mData.size(), mData.data(), mOffsets.data(), mSizes.data());
+    }
+
+    /* readCached fills the requested ranges from the shared block cache, fetching all the
+       missing blocks with a single call to fetchRanges */
+    int VSIGoHandle::readCached(int nRanges, void **ppData, const vsi_l_offset *panOffsets, const size_t *panSizes)
+    {
+        const std::string filename(m_filename);
+        const size_t bs = m_blocks->BlockSize();
+
+        /* pin the blocks covering the requested ranges so they can't be evicted while in use */
+        std::map<vsi_l_offset, VSIGoBlockCache::Block> blocks;
+        for (int iRange = 0; iRange < nRanges; iRange++)
+        {
+            if (panSizes[iRange] == 0)
+            {
+                continue;
+            }
+            if (panOffsets[iRange] + panSizes[iRange] > m_size)
+            {
+                CPLError(CE_Failure, CPLE_AppDefined, "read past end of file");
+                errno = EIO;
+                return -1;
+            }
+            vsi_l_offset last = (panOffsets[iRange] + panSizes[iRange] - 1) / bs;
+            for (vsi_l_offset b = panOffsets[iRange] / bs; b <= last; b++)
+            {
+                if (blocks.find(b) == blocks.end())
+                {
+                    blocks[b] = m_blocks->Get(filename, b);
+                    m_stats.Add(blocks[b] ? GODAL_VSI_CACHE_HITS : GODAL_VSI_CACHE_MISSES);
+                }
+            }
+        }
+
+        std::vector<vsi_l_offset> missing, mOffsets;
+        std::vector<size_t> mSizes;
+        std::vector<void *> mData;
+        std::vector<std::shared_ptr<std::string>> fetched;
+        for (auto &it : blocks)
+        {
+            if (it.second)
+            {
+                continue;
+            }
+            vsi_l_offset off = it.first * bs;
+            size_t len = (m_size - off < bs) ? (size_t)(m_size - off) : bs;
+            std::shared_ptr<std::string> data = std::make_shared<std::string>(len, '\0');
+            if (isHole(off, len))
+            {
+                it.second = data;
+                continue;
+            }
+            missing.push_back(it.first);
+            mOffsets.push_back(off);
+            mSizes.push_back(len);
+            mData.push_back(&(*data)[0]);
+            fetched.push_back(data);
+        }
+        if (!missing.empty())
+        {
+            /* blocks are sorted, so contiguous missing blocks will be merged into a single range */
+            if (fetchRanges((int)missing.size(), mData.data(), mOffsets.data(), mSizes.data()) != 0)
+            {
+                return -1;
+            }
+            for (size_t i = 0; i < missing.size(); i++)
+            {
+                m_blocks->Put(filename, missing[i], fetched[i]);
+                blocks[missing[i]] = fetched[i];
+            }
+        }
+
+        for (int iRange = 0; iRange < nRanges; iRange++)
+        {
+            char *dst = (char *)ppData[iRange];
+            vsi_l_offset off = panOffsets[iRange];
+            size_t remaining = panSizes[iRange];
+            while (remaining > 0)
+            {
+                const std::string &block = *blocks[off / bs];
+                size_t boff = (size_t)(off % bs);
+                if (boff >= block.size())
+                {
+                    /* block was cached by a handle that saw a different file size */
+                    CPLError(CE_Failure, CPLE_AppDefined, "short read");
+                    errno = EIO;
+                    return -1;
+                }
+                size_t n = block.size() - boff;
+                if (n > remaining)
+                {
+                    n = remaining;
+                }
+                memcpy(dst, block.data() + boff, n);
+                dst += n;
+                off += n;
+                remaining -= n;
+            }
+        }
+        return 0;
+    }
+
+    int VSIGoHandle::goMultiRead(int nRanges, void **ppData, const vsi_l_offset *panOffsets, const size_t *panSizes, char **err)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int ret = _gogdalMultiReadCallback(m_id, nRanges, (void *)ppData, (void *)panOffsets, (void *)panSizes, err);
+        size_t nBytes = 0;
+        for (int i = 0; i < nRanges; i++)
+        {
+            nBytes += panSizes[i];
+        }
+        m_stats.AddRequest(start, nRanges, nBytes, ret != 0 || *err != nullptr);
+        return ret;
+    }
+
+    int VSIGoHandle::fetchRanges(int nRanges, void **ppData, const vsi_l_offset *panOffsets, const size_t *panSizes)
+    {
+        /* coalesce ranges that are contiguous, overlapping, or separated by less than m_gap bytes.
+           mFirst[i] is the index of the first requested range that was merged into range i,
+           and mCount[i] is the number of requested ranges that were merged into range i */
+        std::vector<vsi_l_offset> mOffsets;
+        std::vector<size_t> mSizes;
+        std::vector<int> mFirst, mCount;
+        mOffsets.push_back(panOffsets[0]);
+        mSizes.push_back(panSizes[0]);
+        mFirst.push_back(0);
+        mCount.push_back(1);
+        for (int iRange = 1; iRange < nRanges; iRange++)
         {
-            if (panOffsets[iRange] + panSizes[iRange] != panOffsets[iRange + 1])
+            vsi_l_offset curEnd = mOffsets.back() + mSizes.back();
+            vsi_l_offset rngEnd = panOffsets[iRange] + panSizes[iRange];
+            if (panOffsets[iRange] >= mOffsets.back() && panOffsets[iRange] <= curEnd + m_gap)
             {
-                nMergedRanges++;
+                if (rngEnd > curEnd)
+                {
+                    mSizes.back() = rngEnd - mOffsets.back();
+                }
+                mCount.back()++;
+            }
+            else
+            {
+                mOffsets.push_back(panOffsets[iRange]);
+                mSizes.push_back(panSizes[iRange]);
+                mFirst.push_back(iRange);
+                mCount.push_back(1);
             }
         }
+        int nMergedRanges = (int)mOffsets.size();
         char *err = nullptr;
         if (nMergedRanges == nRanges)
         {
-            int ret = _gogdalMultiReadCallback(m_filename, nRanges, (void *)ppData, (void *)panOffsets, (void *)panSizes, &err);
+            int ret = goMultiRead(nRanges, ppData, panOffsets, panSizes, &err);
             if (err)
             {
                 CPLError(CE_Failure, CPLE_AppDefined, "%s", err);
@@ -1135,82 +4319,274 @@ namespace cpl
             return ret;
         }
 
-        vsi_l_offset *mOffsets = new vsi_l_offset[nMergedRanges];
-        size_t *mSizes = new size_t[nMergedRanges];
-        char **mData = new char *[nMergedRanges];
-
-        int curRange = 0;
-        mSizes[curRange] = panSizes[0];
-        mOffsets[curRange] = panOffsets[0];
-        for (iRange = 0; iRange < nRanges - 1; iRange++)
+        /* merged ranges that correspond to a single requested range are read directly into the
+           caller's buffer, the others go through a temporary buffer */
+        std::vector<void *> mData(nMergedRanges, nullptr);
+        int ret = 0;
+        for (int i = 0; i < nMergedRanges; i++)
         {
-            if (panOffsets[iRange] + panSizes[iRange] == panOffsets[iRange + 1])
+            if (mCount[i] == 1)
             {
-                mSizes[curRange] += panSizes[iRange + 1];
+                mData[i] = ppData[mFirst[i]];
+                continue;
             }
-            else
+            mData[i] = VSIMalloc(mSizes[i]);
+            if (mData[i] == nullptr)
             {
-                mData[curRange] = new char[mSizes[curRange]];
-                //start a new range
-                curRange++;
-                mSizes[curRange] = panSizes[iRange + 1];
-                mOffsets[curRange] = panOffsets[iRange + 1];
+                CPLError(CE_Failure, CPLE_OutOfMemory, "cannot allocate %llu bytes for merged range",
+                         (unsigned long long)mSizes[i]);
+                ret = -1;
+                break;
             }
         }
-        mData[curRange] = new char[mSizes[curRange]];
 
-        int ret = _gogdalMultiReadCallback(m_filename, nRanges, (void *)ppData, (void *)panOffsets, (void *)panSizes, &err);
-
-        if (err == nullptr)
+        if (ret == 0)
         {
-            curRange = 0;
-            size_t curOffset = panSizes[0];
-            memcpy(ppData[0], mData[0], panSizes[0]);
-            for (iRange = 0; iRange < nRanges - 1; iRange++)
+            ret = goMultiRead(nMergedRanges, mData.data(), mOffsets.data(), mSizes.data(), &err);
+            if (err == nullptr)
             {
-                if (panOffsets[iRange] + panSizes[iRange] == panOffsets[iRange + 1])
-                {
-                    memcpy(ppData[iRange + 1], mData[curRange] + curOffset, panSizes[iRange + 1]);
-                    curOffset += panSizes[iRange + 1];
-                }
-                else
+                for (int i = 0; i < nMergedRanges; i++)
                 {
-                    curRange++;
-                    memcpy(ppData[iRange + 1], mData[curRange], panSizes[iRange + 1]);
-                    curOffset = panSizes[iRange + 1];
+                    if (mCount[i] == 1)
+                    {
+                        continue;
+                    }
+                    for (int iRange = mFirst[i]; iRange < mFirst[i] + mCount[i]; iRange++)
+                    {
+                        memcpy(ppData[iRange], (char *)mData[i] + (panOffsets[iRange] - mOffsets[i]), panSizes[iRange]);
+                    }
                 }
             }
+            else
+            {
+                CPLError(CE_Failure, CPLE_AppDefined, "%s", err);
+                errno = EIO;
+                free(err);
+                ret = -1;
+            }
         }
-        else
+
+        for (int i = 0; i < nMergedRanges; i++)
         {
-            CPLError(CE_Failure, CPLE_AppDefined, "%s", err);
-            errno = EIO;
-            free(err);
-            ret = -1;
+            if (mCount[i] > 1)
+            {
+                VSIFree(mData[i]);
+            }
         }
+        return ret;
+    }
 
-        delete[] mOffsets;
-        delete[] mSizes;
-        for (int i = 0; i < nMergedRanges; i++)
+    void VSIGoHandle::loadExtents()
+    {
+        if (m_extentsLoaded)
+        {
+            return;
+        }
+        m_extentsLoaded = true;
+        char *err = nullptr;
+        int nExtents = -1;
+        unsigned long long *extents = (unsigned long long *)_gogdalExtentsCallback(m_id, &nExtents, &err);
+        if (err != nullptr)
+        {
+            /* not fatal, we just won't be able to skip holes */
+            CPLDebug("godal", "failed to get extents of %s: %s", m_filename, err);
+            free(err);
+        }
+        else if (nExtents >= 0)
         {
-            delete[] mData[i];
+            m_hasExtents = true;
+            for (int i = 0; i < nExtents; i++)
+            {
+                if (extents[2 * i + 1] > 0)
+                {
+                    m_extents.push_back(std::make_pair(extents[2 * i], extents[2 * i + 1]));
+                }
+            }
+            std::sort(m_extents.begin(), m_extents.end());
         }
-        delete[] mData;
+        free(extents);
+    }
 
-        return ret;
+    /* isHole returns true if the go handler reported that the given range contains no data */
+    bool VSIGoHandle::isHole(vsi_l_offset nOffset, vsi_l_offset nLength)
+    {
+        loadExtents();
+        if (!m_hasExtents)
+        {
+            return false;
+        }
+        /* first extent ending after nOffset */
+        auto it = std::upper_bound(m_extents.begin(), m_extents.end(), nOffset,
+                                   [](vsi_l_offset off, const std::pair<vsi_l_offset, vsi_l_offset> &e) {
+                                       return off < e.first + e.second;
+                                   });
+        return it == m_extents.end() || it->first >= nOffset + nLength;
     }
 
     VSIRangeStatus VSIGoHandle::GetRangeStatus(vsi_l_offset nOffset, vsi_l_offset nLength)
     {
-        return VSI_RANGE_STATUS_UNKNOWN;
+        loadExtents();
+        if (!m_hasExtents)
+        {
+            return VSI_RANGE_STATUS_UNKNOWN;
+        }
+        return isHole(nOffset, nLength) ? VSI_RANGE_STATUS_HOLE : VSI_RANGE_STATUS_DATA;
     }
 
-    VSIGoFilesystemHandler::VSIGoFilesystemHandler(size_t bufferSize, size_t cacheSize)
+    VSIGoFilesystemHandler::VSIGoFilesystemHandler(const char *pszPrefix, int handlerID, size_t bufferSize, size_t cacheSize, size_t mergeGap, size_t sharedCacheSize,
+                                                   long long statTTL, long long negStatTTL, size_t prefetch, size_t partSize, int readAhead)
+        : m_prefix(pszPrefix), m_id(handlerID), m_statTTL(statTTL), m_negStatTTL(negStatTTL)
     {
+        m_readahead = readAhead;
+        m_prefetch = prefetch;
+        m_partSize = (partSize > 0) ? partSize : 8 * 1024 * 1024;
         m_buffer = bufferSize;
         m_cache = (cacheSize < bufferSize) ? bufferSize : cacheSize;
+        m_gap = mergeGap;
+        m_blocks = nullptr;
+        if (sharedCacheSize > 0)
+        {
+            m_blocks = new VSIGoBlockCache(bufferSize > 0 ? bufferSize : 64 * 1024, sharedCacheSize);
+        }
+        m_workers = nullptr;
+        if (readAhead > 0)
+        {
+            m_workers = new VSIGoWorkerPool(readAhead);
+        }
+    }
+    VSIGoFilesystemHandler::~VSIGoFilesystemHandler()
+    {
+        delete m_workers;
+        delete m_blocks;
+    }
+
+    /* cachedSize looks up the size of filename in the stat cache. A cached size of -1 denotes
+       a missing key, in which case err is set to the error that was returned by the go handler */
+    bool VSIGoFilesystemHandler::cachedSize(const std::string &filename, long long *size, char **err)
+    {
+        if (m_statTTL.count() <= 0 && m_negStatTTL.count() <= 0)
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(m_statMutex);
+        auto it = m_stats.find(filename);
+        if (it == m_stats.end())
+        {
+            return false;
+        }
+        if (it->second.expires <= std::chrono::steady_clock::now())
+        {
+            m_stats.erase(it);
+            return false;
+        }
+        *size = it->second.size;
+        if (it->second.size == -1)
+        {
+            *err = strdup(it->second.err.c_str());
+        }
+        return true;
+    }
+
+    void VSIGoFilesystemHandler::cacheSize(const std::string &filename, long long size, const char *err)
+    {
+        std::chrono::nanoseconds ttl = (size == -1) ? m_negStatTTL : m_statTTL;
+        if (ttl.count() <= 0)
+        {
+            return;
+        }
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_statMutex);
+        if (m_stats.size() >= 10000)
+        {
+            for (auto it = m_stats.begin(); it != m_stats.end();)
+            {
+                it = (it->second.expires <= now) ? m_stats.erase(it) : std::next(it);
+            }
+        }
+        statEntry &e = m_stats[filename];
+        e.size = size;
+        e.err = (size == -1 && err != nullptr) ? err : "";
+        e.expires = now + ttl;
+    }
+
+    /* getSize wraps _gogdalSizeCallback with the stat cache */
+    long long VSIGoFilesystemHandler::getSize(const char *pszFilename, char **err)
+    {
+        const std::string filename(pszFilename);
+        long long s;
+        if (cachedSize(filename, &s, err))
+        {
+            return s;
+        }
+        s = _gogdalSizeCallback(m_id, goKey(pszFilename), err);
+        cacheSize(filename, s, *err);
+        return s;
+    }
+
+    /* statsRef returns the counters to be updated by a handle opened on filename */
+    VSIGoStatsRef VSIGoFilesystemHandler::statsRef(const std::string &filename)
+    {
+        std::lock_guard<std::mutex> lock(m_fileStatsMutex);
+        std::shared_ptr<VSIGoStats> &fileStats = m_fileStats[filename];
+        if (!fileStats)
+        {
+            if (m_fileStats.size() > 10000)
+            {
+                /* forget about the files that are not currently opened */
+                for (auto it = m_fileStats.begin(); it != m_fileStats.end();)
+                {
+                    it = (it->second && it->second.use_count() == 1) ? m_fileStats.erase(it) : std::next(it);
+                }
+            }
+            std::shared_ptr<VSIGoStats> created = std::make_shared<VSIGoStats>();
+            m_fileStats[filename] = created;
+            return VSIGoStatsRef(&m_ioStats, created);
+        }
+        return VSIGoStatsRef(&m_ioStats, fileStats);
+    }
+
+    /* GetStats copies the counters of the handler if pszPath is its prefix, or those of
+       file pszPath otherwise */
+    void VSIGoFilesystemHandler::GetStats(const char *pszPath, long long *stats)
+    {
+        const VSIGoStats *src = nullptr;
+        std::shared_ptr<VSIGoStats> fileStats;
+        if (m_prefix == pszPath)
+        {
+            src = &m_ioStats;
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(m_fileStatsMutex);
+            auto it = m_fileStats.find(pszPath);
+            if (it != m_fileStats.end())
+            {
+                fileStats = it->second;
+                src = fileStats.get();
+            }
+        }
+        for (int i = 0; i < GODAL_VSI_NSTATS; i++)
+        {
+            stats[i] = src ? src->counters[i].load(std::memory_order_relaxed) : 0;
+        }
+    }
+
+    /* Invalidate drops the cached sizes and blocks of the files whose name starts with pszPrefix */
+    void VSIGoFilesystemHandler::Invalidate(const char *pszPrefix)
+    {
+        const std::string prefix(pszPrefix);
+        {
+            std::lock_guard<std::mutex> lock(m_statMutex);
+            for (auto it = m_stats.begin(); it != m_stats.end();)
+            {
+                it = (it->first.compare(0, prefix.size(), prefix) == 0) ? m_stats.erase(it) : std::next(it);
+            }
+        }
+        if (m_blocks != nullptr)
+        {
+            m_blocks->Invalidate(prefix);
+        }
     }
-    VSIGoFilesystemHandler::~VSIGoFilesystemHandler() {}
 
 	VSIVirtualHandle *VSIGoFilesystemHandler::Open(const char *pszFilename,
 												   const char *pszAccess,
@@ -1220,31 +4596,84 @@ namespace cpl
 #endif
 	)
 	{
-		if (strchr(pszAccess, 'w') != NULL ||
+		if (strchr(pszAccess, 'a') != NULL ||
             strchr(pszAccess, '+') != NULL)
         {
-            CPLError(CE_Failure, CPLE_AppDefined, "Only read-only mode is supported");
+            CPLError(CE_Failure, CPLE_AppDefined, "Only read-only and sequential write-only modes are supported");
             return NULL;
         }
+        if (strchr(pszAccess, 'w') != NULL)
+        {
+            char *err = nullptr;
+            long long id = _gogdalOpenWriterCallback(m_id, goKey(pszFilename), &err);
+            if (id == -1)
+            {
+                CPLError(CE_Failure, CPLE_AppDefined, "%s", err != nullptr ? err : "cannot open file for writing");
+                free(err);
+                errno = EACCES;
+                return NULL;
+            }
+            Invalidate(pszFilename);
+            return new VSIGoWriteHandle(this, pszFilename, id, m_partSize);
+        }
+        const std::string filename(pszFilename);
         char *err = nullptr;
-        long long s = _gogdalSizeCallback((char *)pszFilename, &err);
-
-        if (s == -1)
+        long long s = -1;
+        if (cachedSize(filename, &s, &err) && s == -1)
+        {
+            CPLError(CE_Failure, CPLE_AppDefined, "%s", err);
+            free(err);
+            errno = ENOENT;
+            return NULL;
+        }
+        bool bPrefetch = m_prefetch > 0 &&
+                         (m_blocks == nullptr || !m_blocks->Get(filename, 0));
+        std::string head(bPrefetch ? m_prefetch : 0, '\0');
+        size_t nread = 0;
+        int extents = 0;
+        /* resolve the go reader once for the lifetime of the handle. s is passed in so that the
+           go handler does not query the size again if it was cached */
+        int id = _gogdalOpenCallback(m_id, goKey(pszFilename), bPrefetch ? &head[0] : nullptr, head.size(), &nread, &s, &extents, &err);
+        if (id == -1)
         {
+            if (s == -1)
+            {
+                cacheSize(filename, -1, err);
+            }
             if (err != nullptr)
             {
                 CPLError(CE_Failure, CPLE_AppDefined, "%s", err);
+                free(err);
             }
             errno = ENOENT;
             return NULL;
         }
+        head.resize(nread);
+        cacheSize(filename, s, nullptr);
+        VSIGoStatsRef stats = statsRef(filename);
+        stats.Add(GODAL_VSI_OPENS);
+        if (m_blocks != nullptr)
+        {
+            /* seed the shared cache with the complete blocks that were prefetched */
+            const size_t bs = m_blocks->BlockSize();
+            for (size_t off = 0; off < head.size(); off += bs)
+            {
+                if (off + bs > head.size() && head.size() != (size_t)s)
+                {
+                    break;
+                }
+                m_blocks->Put(pszFilename, off / bs, std::make_shared<std::string>(head, off, bs));
+            }
+            return new VSIGoHandle(pszFilename, id, s, m_gap, m_blocks, std::string(), 0, 0, nullptr, stats, true, extents != 0);
+        }
         if (m_buffer == 0)
         {
-            return new VSIGoHandle(pszFilename, s);
+            return new VSIGoHandle(pszFilename, id, s, m_gap, nullptr, std::move(head), 64 * 1024, m_readahead, m_workers, stats, true, extents != 0);
         }
         else
         {
-            return VSICreateCachedFile(new VSIGoHandle(pszFilename, s), m_buffer, m_cache);
+            VSIVirtualHandle *poHandle = new VSIGoHandle(pszFilename, id, s, m_gap, nullptr, std::move(head), m_buffer, m_readahead, m_workers, stats, false, extents != 0);
+            return new VSIGoStatsHandle(VSICreateCachedFile(poHandle, m_buffer, m_cache), stats);
         }
 	}
 
@@ -1252,15 +4681,17 @@ namespace cpl
                                      VSIStatBufL *pStatBuf,
                                      int nFlags)
     {
+        m_ioStats.counters[GODAL_VSI_STATS].fetch_add(1, std::memory_order_relaxed);
         char *err = nullptr;
-        long long s = _gogdalSizeCallback((char *)pszFilename, &err);
+        long long s = getSize(pszFilename, &err);
         if (s == -1)
         {
             if (nFlags & VSI_STAT_SET_ERROR_FLAG)
             {
-                CPLError(CE_Failure, CPLE_AppDefined, "%s", err);
+                CPLError(CE_Failure, CPLE_AppDefined, "%s", err != nullptr ? err : "no such file");
                 errno = ENOENT;
             }
+            free(err);
             return -1;
         }
         memset(pStatBuf, 0, sizeof(VSIStatBufL));
@@ -1283,11 +4714,22 @@ namespace cpl
     {
         return (char **)calloc(1, sizeof(char *));
     }
+
+    bool VSIGoFilesystemHandler::SupportsSequentialWrite(const char * /*pszPath*/, bool /*bAllowLocalTempFile*/)
+    {
+        return true;
+    }
+
+    bool VSIGoFilesystemHandler::SupportsRandomWrite(const char * /*pszPath*/, bool /*bAllowLocalTempFile*/)
+    {
+        return false;
+    }
 #endif
 
 } // namespace cpl
 
-void VSIInstallGoHandler(cctx *ctx, const char *pszPrefix, size_t bufferSize, size_t cacheSize)
+void VSIInstallGoHandler(cctx *ctx, const char *pszPrefix, int handlerID, size_t bufferSize, size_t cacheSize, size_t mergeGap, size_t sharedCacheSize,
+						 long long statTTL, long long negStatTTL, size_t prefetch, size_t partSize, int readAhead)
 {
 	godalWrap(ctx);
     CSLConstList papszPrefix = VSIFileManager::GetPrefixes();
@@ -1298,12 +4740,36 @@ void VSIInstallGoHandler(cctx *ctx, const char *pszPrefix, size_t bufferSize, si
 			return;
         }
     }
-    VSIFilesystemHandler *poHandler = new cpl::VSIGoFilesystemHandler(bufferSize, cacheSize);
+    VSIFilesystemHandler *poHandler = new cpl::VSIGoFilesystemHandler(pszPrefix, handlerID, bufferSize, cacheSize, mergeGap, sharedCacheSize, statTTL, negStatTTL, prefetch, partSize, readAhead);
     const std::string sPrefix(pszPrefix);
     VSIFileManager::InstallHandler(sPrefix, poHandler);
 	godalUnwrap();
 }
 
+void VSIGoHandlerStats(cctx *ctx, const char *pszPath, long long *stats)
+{
+	godalWrap(ctx);
+	cpl::VSIGoFilesystemHandler *poHandler = dynamic_cast<cpl::VSIGoFilesystemHandler *>(VSIFileManager::GetHandler(pszPath));
+	if (poHandler == nullptr) {
+		CPLError(CE_Failure, CPLE_AppDefined, "%s is not handled by a go handler", pszPath);
+	} else {
+		poHandler->GetStats(pszPath, stats);
+	}
+	godalUnwrap();
+}
+
+void VSIInvalidateGoHandler(cctx *ctx, const char *pszPrefix)
+{
+	godalWrap(ctx);
+	cpl::VSIGoFilesystemHandler *poHandler = dynamic_cast<cpl::VSIGoFilesystemHandler *>(VSIFileManager::GetHandler(pszPrefix));
+	if (poHandler == nullptr) {
+		CPLError(CE_Failure, CPLE_AppDefined, "%s is not handled by a go handler", pszPrefix);
+	} else {
+		poHandler->Invalidate(pszPrefix);
+	}
+	godalUnwrap();
+}
+
 
 void test_godal_error_handling(cctx *ctx) {
 	godalWrap(ctx);
@@ -28,10 +28,14 @@ import (
 	"fmt"
 	"io"
 	"path/filepath"
+	"reflect"
+	"runtime"
+	"sort"
 	"strconv"
 	"strings"
 	"sync"
 	"sync/atomic"
+	"time"
 	"unsafe"
 
 	"github.com/airbusgeo/osio"
@@ -306,10 +310,287 @@ func (band Band) IO(rw IOOperation, srcX, srcY int, buffer interface{}, bufWidth
 	return cgc.close()
 }
 
+// checkBlockBuffer returns an error if buffer cannot hold a block of the band
+func (band Band) checkBlockBuffer(buffer interface{}) (unsafe.Pointer, error) {
+	st := band.Structure()
+	_, dtype, cBuf := cBuffer(buffer)
+	if dtype != st.DataType {
+		return nil, fmt.Errorf("buffer of type %s does not match band type %s", dtype, st.DataType)
+	}
+	if reflect.ValueOf(buffer).Len() < st.BlockSizeX*st.BlockSizeY {
+		return nil, fmt.Errorf("buffer must hold at least %dx%d pixels", st.BlockSizeX, st.BlockSizeY)
+	}
+	return cBuf, nil
+}
+
+// ReadBlock reads the block at block offsets (bx,by) into buffer, without going through
+// the resampling and type conversion machinery of Read. The buffer must be of the band's
+// data type and hold BlockSizeX*BlockSizeY pixels (c.f. Structure). Blocks on the right
+// and bottom edges of the band are full sized, the pixels outside the band being undefined.
+func (band Band) ReadBlock(bx, by int, buffer interface{}, opts ...BlockIOOption) error {
+	return band.blockIO(IORead, bx, by, buffer, opts...)
+}
+
+// WriteBlock writes buffer to the block at block offsets (bx,by), c.f. ReadBlock
+func (band Band) WriteBlock(bx, by int, buffer interface{}, opts ...BlockIOOption) error {
+	return band.blockIO(IOWrite, bx, by, buffer, opts...)
+}
+
+func (band Band) blockIO(rw IOOperation, bx, by int, buffer interface{}, opts ...BlockIOOption) error {
+	bo := blockIOOpts{}
+	for _, opt := range opts {
+		opt.setBlockIOOpt(&bo)
+	}
+	cBuf, err := band.checkBlockBuffer(buffer)
+	if err != nil {
+		return err
+	}
+	cgc := createCGOContext(bo.config, bo.errorHandler)
+	C.godalBandBlockIO(cgc.cPointer(), band.handle(), C.GDALRWFlag(rw), C.int(bx), C.int(by), cBuf)
+	return cgc.close()
+}
+
+// LockedBlock is a block of a band's block cache, as returned by Band.LockBlock
+type LockedBlock struct {
+	block unsafe.Pointer
+	data  []byte
+	dirty bool
+}
+
+// LockBlock returns the block at block offsets (bx,by) from the band's block cache,
+// loading it if needed, without copying it. The block stays locked in the cache (and its
+// data valid) until Release is called, which must happen before the dataset is closed.
+func (band Band) LockBlock(bx, by int, opts ...BlockIOOption) (*LockedBlock, error) {
+	bo := blockIOOpts{}
+	for _, opt := range opts {
+		opt.setBlockIOOpt(&bo)
+	}
+	st := band.Structure()
+	var data unsafe.Pointer
+	cgc := createCGOContext(bo.config, bo.errorHandler)
+	block := C.godalBandLockBlock(cgc.cPointer(), band.handle(), C.int(bx), C.int(by), &data)
+	if err := cgc.close(); err != nil {
+		if block != nil {
+			C.godalUnlockBlock(block, 0)
+		}
+		return nil, err
+	}
+	l := st.BlockSizeX * st.BlockSizeY * st.DataType.Size()
+	return &LockedBlock{
+		block: block,
+		data:  (*[1 << 30]byte)(data)[:l:l],
+	}, nil
+}
+
+// Data returns the raw pixels of the block, in the band's data type and native byte
+// order. The returned slice must not be used once the block has been released.
+func (lb *LockedBlock) Data() []byte {
+	return lb.data
+}
+
+// MarkDirty flags the block as modified, so that the changes made to Data are written
+// to the dataset when the block is flushed from the cache.
+func (lb *LockedBlock) MarkDirty() {
+	lb.dirty = true
+}
+
+// Release unlocks the block. It is a no-op if the block has already been released.
+func (lb *LockedBlock) Release() {
+	if lb.block == nil {
+		return
+	}
+	dirty := C.int(0)
+	if lb.dirty {
+		dirty = 1
+	}
+	C.godalUnlockBlock(lb.block, dirty)
+	lb.block = nil
+	lb.data = nil
+}
+
+// RawTile locates the compressed bytes of a block (tile or strip) of a GTiff band
+type RawTile struct {
+	// X and Y are the block offsets of the tile
+	X, Y int
+	// Offset and Size locate the compressed tile in the file. Both are 0 for tiles that
+	// have not been written (i.e. in sparse files)
+	Offset, Size int64
+}
+
+// RawTiles returns the location in the file of the nx*ny blocks starting at block offsets
+// (bx,by), in row major order. It is only available for GTiff datasets. For pixel
+// interleaved datasets, all the bands share the same tiles. The compression method of
+// the tiles is given by the dataset's
+//  Metadata("COMPRESSION", Domain("IMAGE_STRUCTURE"))
+func (band Band) RawTiles(bx, by, nx, ny int, opts ...RawTileOption) ([]RawTile, error) {
+	ro := rawTileOpts{}
+	for _, opt := range opts {
+		opt.setRawTileOpt(&ro)
+	}
+	if nx <= 0 || ny <= 0 {
+		return nil, nil
+	}
+	offsets := make([]C.longlong, nx*ny)
+	sizes := make([]C.longlong, nx*ny)
+	cgc := createCGOContext(ro.config, ro.errorHandler)
+	C.godalBandRawTiles(cgc.cPointer(), band.handle(), C.int(bx), C.int(by), C.int(nx), C.int(ny),
+		&offsets[0], &sizes[0])
+	if err := cgc.close(); err != nil {
+		return nil, err
+	}
+	tiles := make([]RawTile, nx*ny)
+	for i := range tiles {
+		tiles[i] = RawTile{
+			X:      bx + i%nx,
+			Y:      by + i/nx,
+			Offset: int64(offsets[i]),
+			Size:   int64(sizes[i]),
+		}
+	}
+	return tiles, nil
+}
+
+// ReadRawTiles returns the compressed bytes of the given tiles (as returned by RawTiles),
+// fetched from the dataset's file with a single multi-range request. The returned slices
+// share a single allocation. A nil slice is returned for tiles that have not been written.
+func (band Band) ReadRawTiles(tiles []RawTile, opts ...RawTileOption) ([][]byte, error) {
+	ro := rawTileOpts{}
+	for _, opt := range opts {
+		opt.setRawTileOpt(&ro)
+	}
+	ret := make([][]byte, len(tiles))
+	offsets := make([]C.ulonglong, 0, len(tiles))
+	sizes := make([]C.size_t, 0, len(tiles))
+	total := int64(0)
+	for _, t := range tiles {
+		if t.Size > 0 {
+			offsets = append(offsets, C.ulonglong(t.Offset))
+			sizes = append(sizes, C.size_t(t.Size))
+			total += t.Size
+		}
+	}
+	if total == 0 {
+		return ret, nil
+	}
+	buf := make([]byte, total)
+	cgc := createCGOContext(ro.config, ro.errorHandler)
+	C.godalBandReadRawTiles(cgc.cPointer(), band.handle(), C.int(len(offsets)), &offsets[0], &sizes[0],
+		unsafe.Pointer(&buf[0]))
+	if err := cgc.close(); err != nil {
+		return nil, err
+	}
+	off := int64(0)
+	for i, t := range tiles {
+		if t.Size > 0 {
+			ret[i] = buf[off : off+t.Size : off+t.Size]
+			off += t.Size
+		}
+	}
+	return ret, nil
+}
+
+// BandIOWindow is one of the windows transferred by Band.IOBatch
+type BandIOWindow struct {
+	// X, Y, Width and Height define the window of the band. Width and Height default
+	// to BufWidth and BufHeight, i.e. no resampling.
+	X, Y, Width, Height int
+	// Buffer is a slice of one of the types accepted by Band.IO
+	Buffer              interface{}
+	BufWidth, BufHeight int
+	// Err is set by IOBatch if the transfer of this window failed
+	Err error
+}
+
+// ReadBatch populates the buffers of the supplied windows, c.f. IOBatch
+func (band Band) ReadBatch(windows []BandIOWindow, opts ...BandIOOption) error {
+	return band.IOBatch(IORead, windows, opts...)
+}
+
+// WriteBatch writes the buffers of the supplied windows to the band, c.f. IOBatch
+func (band Band) WriteBatch(windows []BandIOWindow, opts ...BandIOOption) error {
+	return band.IOBatch(IOWrite, windows, opts...)
+}
+
+// IOBatch reads or writes multiple windows with a single cgo call, which is cheaper
+// than calling IO for each window when many small windows are to be transferred.
+//
+// Reads are processed in the order of the windows' offsets in the file (when exposed by
+// the driver, i.e. GTiff) so that the underlying VSI handler can merge neighboring
+// reads, and can be spread over multiple threads with the IOThreads option. Additional
+// threads read from their own handles on the dataset, which are only opened for datasets
+// opened read-only by name (i.e. not for MEM or update-mode datasets, which are then read
+// sequentially), with the same driver and open options. Writes are processed in the order
+// of the windows slice.
+//
+// The Window and Stride options are ignored, the error of each failed window is set in
+// its Err field and all of them are returned combined.
+func (band Band) IOBatch(rw IOOperation, windows []BandIOWindow, opts ...BandIOOption) error {
+	if len(windows) == 0 {
+		return nil
+	}
+	ro := bandIOOpts{}
+	for _, opt := range opts {
+		opt.setBandIOOpt(&ro)
+	}
+	ralg, err := ro.resampling.rioAlg()
+	if err != nil {
+		return err
+	}
+	cwindows := make([]C.godalIOWindow, len(windows))
+	for i := range windows {
+		w := &windows[i]
+		w.Err = nil
+		dsize, dtype, cBuf := cBuffer(w.Buffer)
+		pixelSpacing := C.int(dsize)
+		if ro.pixelSpacing > 0 {
+			pixelSpacing = C.int(ro.pixelSpacing)
+		}
+		lineSpacing := C.int(w.BufWidth) * pixelSpacing
+		if ro.lineSpacing > 0 {
+			lineSpacing = C.int(ro.lineSpacing)
+		}
+		cw := &cwindows[i]
+		cw.nDSXOff, cw.nDSYOff = C.int(w.X), C.int(w.Y)
+		cw.nDSXSize, cw.nDSYSize = C.int(w.Width), C.int(w.Height)
+		if w.Width == 0 {
+			cw.nDSXSize = C.int(w.BufWidth)
+		}
+		if w.Height == 0 {
+			cw.nDSYSize = C.int(w.BufHeight)
+		}
+		cw.pBuffer = C.uintptr_t(uintptr(cBuf))
+		cw.nBXSize, cw.nBYSize = C.int(w.BufWidth), C.int(w.BufHeight)
+		cw.eBDataType = C.GDALDataType(dtype)
+		cw.nPixelSpace, cw.nLineSpace = pixelSpacing, lineSpacing
+	}
+	cgc := createCGOContext(ro.config, ro.errorHandler)
+	C.godalBandRasterIOBatch(cgc.cPointer(), band.handle(), C.GDALRWFlag(rw), C.int(len(windows)),
+		&cwindows[0], ralg, C.int(ro.threads))
+	//the buffers are only referenced by address in cwindows
+	runtime.KeepAlive(windows)
+	err = cgc.close()
+	for i := range cwindows {
+		cw := &cwindows[i]
+		switch {
+		case cw.errMessage != nil:
+			windows[i].Err = errors.New(C.GoString(cw.errMessage))
+			C.free(unsafe.Pointer(cw.errMessage))
+			if ro.errorHandler == nil {
+				err = combine(err, windows[i].Err)
+			}
+		case cw.failed != 0:
+			//the error has been returned by the ErrorHandler, and is already in err
+			windows[i].Err = fmt.Errorf("window %d failed", i)
+		}
+	}
+	return err
+}
+
 // Polygonize wraps GDALPolygonize
 func (band Band) Polygonize(dstLayer Layer, opts ...PolygonizeOption) error {
 	popt := polygonizeOpts{
 		pixFieldIndex: -1,
+		workers:       runtime.NumCPU(),
 	}
 	maskBand := band.MaskBand()
 	popt.mask = &maskBand
@@ -325,7 +606,13 @@ func (band Band) Polygonize(dstLayer Layer, opts ...PolygonizeOption) error {
 	}
 
 	cgc := createCGOContext(nil, popt.errorHandler)
-	C.godalPolygonize(cgc.cPointer(), band.handle(), cMaskBand, dstLayer.handle(), C.int(popt.pixFieldIndex), copts.cPointer())
+	cgc.setProgress(popt.progress)
+	if popt.tileX > 0 && popt.tileY > 0 {
+		C.godalPolygonizeTiled(cgc.cPointer(), band.handle(), cMaskBand, dstLayer.handle(), C.int(popt.pixFieldIndex), copts.cPointer(),
+			C.int(popt.tileX), C.int(popt.tileY), C.int(popt.workers))
+	} else {
+		C.godalPolygonize(cgc.cPointer(), band.handle(), cMaskBand, dstLayer.handle(), C.int(popt.pixFieldIndex), copts.cPointer())
+	}
 	return cgc.close()
 }
 
@@ -356,6 +643,8 @@ func (band Band) SieveFilter(sizeThreshold int, opts ...SieveFilterOption) error
 	sfopt := sieveFilterOpts{
 		dstBand:       &band,
 		connectedness: 4,
+		overlap:       -1,
+		workers:       runtime.NumCPU(),
 	}
 	maskBand := band.MaskBand()
 	sfopt.mask = &maskBand
@@ -368,8 +657,18 @@ func (band Band) SieveFilter(sizeThreshold int, opts ...SieveFilterOption) error
 		cMaskBand = sfopt.mask.handle()
 	}
 	cgc := createCGOContext(nil, sfopt.errorHandler)
-	C.godalSieveFilter(cgc.cPointer(), band.handle(), cMaskBand, sfopt.dstBand.handle(),
-		C.int(sizeThreshold), C.int(sfopt.connectedness))
+	cgc.setProgress(sfopt.progress)
+	if sfopt.tileX > 0 && sfopt.tileY > 0 {
+		if sfopt.overlap < 0 {
+			sfopt.overlap = sizeThreshold
+		}
+		C.godalSieveFilterTiled(cgc.cPointer(), band.handle(), cMaskBand, sfopt.dstBand.handle(),
+			C.int(sizeThreshold), C.int(sfopt.connectedness), C.int(sfopt.tileX), C.int(sfopt.tileY),
+			C.int(sfopt.overlap), C.int(sfopt.workers))
+	} else {
+		C.godalSieveFilter(cgc.cPointer(), band.handle(), cMaskBand, sfopt.dstBand.handle(),
+			C.int(sizeThreshold), C.int(sfopt.connectedness))
+	}
 	return cgc.close()
 }
 
@@ -421,6 +720,90 @@ func (band Band) Histogram(opts ...HistogramOption) (Histogram, error) {
 	return h, nil
 }
 
+// Statistics computes the count, min, max, mean, standard deviation and histogram of the
+// valid pixels of all the dataset's bands (or of the ones selected with Bands), in a single
+// pass over the dataset. Pixels that are masked or nodata, and NaNs, are ignored.
+//
+// Blocks are processed in parallel by the number of threads set with Workers, each reading
+// from its own handle on the dataset, reopened with the same driver and open options.
+// Datasets that are not opened read-only (whose other handles could miss unflushed writes)
+// or that cannot be reopened by name (e.g. MEM datasets) are processed by a single thread
+// on their own handle.
+//
+// The histograms span the range given with Intervals. Without Intervals, 8 and 16 bit bands
+// get an exact histogram with one bucket per possible value, and other bands no histogram.
+func (ds *Dataset) Statistics(opts ...StatisticsOption) ([]BandStatistics, error) {
+	so := statisticsOpts{workers: runtime.NumCPU()}
+	for _, o := range opts {
+		o.setStatisticsOpt(&so)
+	}
+	if so.buckets > 0 && !(so.max > so.min) {
+		return nil, fmt.Errorf("invalid histogram interval [%g,%g]", so.min, so.max)
+	}
+	bands := ds.Bands()
+	idx := so.bands
+	if len(idx) == 0 {
+		idx = make([]int, len(bands))
+		for i := range bands {
+			idx[i] = i + 1
+		}
+	}
+	if len(idx) == 0 {
+		return nil, fmt.Errorf("dataset has no bands")
+	}
+	cstats := make([]C.godalBandStats, len(idx))
+	hists := make([]Histogram, len(idx))
+	for i, b := range idx {
+		if b < 1 || b > len(bands) {
+			return nil, fmt.Errorf("invalid band %d", b-1)
+		}
+		h := &hists[i]
+		h.min, h.max = so.min, so.max
+		nBuckets := int(so.buckets)
+		if nBuckets <= 0 {
+			switch bands[b-1].Structure().DataType {
+			case Byte:
+				h.min, h.max, nBuckets = -0.5, 255.5, 256
+			case UInt16:
+				h.min, h.max, nBuckets = -0.5, 65535.5, 65536
+			case Int16:
+				h.min, h.max, nBuckets = -32768.5, 32767.5, 65536
+			default:
+				nBuckets = 0
+			}
+		}
+		cstats[i].band = C.int(b)
+		if nBuckets > 0 {
+			h.counts = make([]uint64, nBuckets)
+			cstats[i].histMin, cstats[i].histMax = C.double(h.min), C.double(h.max)
+			cstats[i].nBuckets = C.int(nBuckets)
+			cstats[i].buckets = C.uintptr_t(uintptr(unsafe.Pointer(&h.counts[0])))
+		}
+	}
+
+	cgc := createCGOContext(nil, so.errorHandler)
+	C.godalDatasetStatistics(cgc.cPointer(), ds.handle(), C.int(len(cstats)), &cstats[0],
+		C.int(so.includeOutside), C.int(so.workers))
+	//the histograms are only referenced by address in cstats
+	runtime.KeepAlive(hists)
+	if err := cgc.close(); err != nil {
+		return nil, err
+	}
+	stats := make([]BandStatistics, len(idx))
+	for i := range stats {
+		cs := &cstats[i]
+		stats[i] = BandStatistics{
+			Count:     uint64(cs.count),
+			Min:       float64(cs.min),
+			Max:       float64(cs.max),
+			Mean:      float64(cs.mean),
+			StdDev:    float64(cs.stdDev),
+			Histogram: hists[i],
+		}
+	}
+	return stats, nil
+}
+
 func cIntArray(in []int) *C.int {
 	ret := make([]C.int, len(in))
 	for i := range in {
@@ -750,11 +1133,12 @@ func (ds *Dataset) Translate(dstDS string, switches []string, opts ...DatasetTra
 	defer C.free(cname)
 
 	cgc := createCGOContext(gopts.config, gopts.errorHandler)
+	cgc.setProgress(gopts.progress)
 	hndl := C.godalTranslate(cgc.cPointer(), (*C.char)(cname), ds.handle(), cswitches.cPointer())
 	if err := cgc.close(); err != nil {
 		return nil, err
 	}
-	return &Dataset{majorObject{C.GDALMajorObjectH(hndl)}}, nil
+	return &Dataset{majorObject: majorObject{C.GDALMajorObjectH(hndl)}}, nil
 }
 
 // Warp runs the library version of gdalwarp
@@ -803,6 +1187,7 @@ func Warp(dstDS string, sourceDS []*Dataset, switches []string, opts ...DatasetW
 		}
 		switches = append(switches, "-of", dname)
 	}
+	switches = append(switches, gopts.warp.switches()...)
 
 	srcDS := make([]C.GDALDatasetH, len(sourceDS))
 	for i, dataset := range sourceDS {
@@ -815,11 +1200,12 @@ func Warp(dstDS string, sourceDS []*Dataset, switches []string, opts ...DatasetW
 	defer C.free(cname)
 
 	cgc := createCGOContext(gopts.config, gopts.errorHandler)
+	cgc.setProgress(gopts.progress)
 	hndl := C.godalDatasetWarp(cgc.cPointer(), (*C.char)(cname), C.int(len(sourceDS)), (*C.GDALDatasetH)(unsafe.Pointer(&srcDS[0])), cswitches.cPointer())
 	if err := cgc.close(); err != nil {
 		return nil, err
 	}
-	return &Dataset{majorObject{C.GDALMajorObjectH(hndl)}}, nil
+	return &Dataset{majorObject: majorObject{C.GDALMajorObjectH(hndl)}}, nil
 }
 
 // WarpInto writes provided sourceDS Datasets into self existing dataset and runs the library version of gdalwarp
@@ -834,6 +1220,7 @@ func (ds *Dataset) WarpInto(sourceDS []*Dataset, switches []string, opts ...Data
 	for _, opt := range opts {
 		opt.setDatasetWarpIntoOpt(&gopts)
 	}
+	switches = append(switches, gopts.warp.switches()...)
 
 	cswitches := sliceToCStringArray(switches)
 	defer cswitches.free()
@@ -845,6 +1232,7 @@ func (ds *Dataset) WarpInto(sourceDS []*Dataset, switches []string, opts ...Data
 	}
 
 	cgc := createCGOContext(gopts.config, gopts.errorHandler)
+	cgc.setProgress(gopts.progress)
 	C.godalDatasetWarpInto(cgc.cPointer(),
 		dstDS,
 		C.int(len(sourceDS)),
@@ -911,7 +1299,12 @@ func (ds *Dataset) BuildOverviews(opts ...BuildOverviewsOption) error {
 	cResample := unsafe.Pointer(C.CString(oopts.resampling.String()))
 	defer C.free(cResample)
 
-	cgc := createCGOContext(oopts.config, oopts.errorHandler)
+	config := oopts.config
+	if oopts.threads != 0 {
+		config = append([]string{numThreadsConfig(oopts.threads)}, config...)
+	}
+	cgc := createCGOContext(config, oopts.errorHandler)
+	cgc.setProgress(oopts.progress)
 	C.godalBuildOverviews(cgc.cPointer(), ds.handle(), (*C.char)(cResample), nLevels, cLevels,
 		nBands, cBands)
 	return cgc.close()
@@ -1192,7 +1585,7 @@ func Create(driver DriverName, name string, nBands int, dtype DataType, width, h
 	if err := cgc.close(); err != nil {
 		return nil, err
 	}
-	return &Dataset{majorObject{C.GDALMajorObjectH(hndl)}}, nil
+	return &Dataset{majorObject: majorObject{C.GDALMajorObjectH(hndl)}}, nil
 
 }
 
@@ -1225,7 +1618,7 @@ func CreateVector(driver DriverName, name string, opts ...DatasetCreateOption) (
 	if err := cgc.close(); err != nil {
 		return nil, err
 	}
-	return &Dataset{majorObject{C.GDALMajorObjectH(hndl)}}, nil
+	return &Dataset{majorObject: majorObject{C.GDALMajorObjectH(hndl)}}, nil
 
 }
 
@@ -1236,6 +1629,7 @@ type majorObject struct {
 //Dataset is a wrapper around a GDALDatasetH
 type Dataset struct {
 	majorObject
+	pool *DatasetPool //set when the dataset was obtained from a DatasetPool
 }
 
 //handle returns a pointer to the underlying GDALDatasetH
@@ -1248,6 +1642,10 @@ func (ds *Dataset) handle() C.GDALDatasetH {
 //name may be a filename or any supported string supported by gdal (e.g. a /vsixxx path,
 //the xml string representing a vrt dataset, etc...)
 func Open(name string, options ...OpenOption) (*Dataset, error) {
+	return open(name, newOpenOpts(name, options))
+}
+
+func newOpenOpts(name string, options []OpenOption) openOpts {
 	oopts := openOpts{
 		flags:        C.GDAL_OF_READONLY | C.GDAL_OF_VERBOSE_ERROR,
 		siblingFiles: []string{filepath.Base(name)},
@@ -1255,6 +1653,10 @@ func Open(name string, options ...OpenOption) (*Dataset, error) {
 	for _, opt := range options {
 		opt.setOpenOpt(&oopts)
 	}
+	return oopts
+}
+
+func open(name string, oopts openOpts) (*Dataset, error) {
 	csiblings := sliceToCStringArray(oopts.siblingFiles)
 	coopts := sliceToCStringArray(oopts.options)
 	cdrivers := sliceToCStringArray(oopts.drivers)
@@ -1272,7 +1674,7 @@ func Open(name string, options ...OpenOption) (*Dataset, error) {
 	if err := cgc.close(); err != nil {
 		return nil, err
 	}
-	return &Dataset{majorObject{C.GDALMajorObjectH(retds)}}, nil
+	return &Dataset{majorObject: majorObject{C.GDALMajorObjectH(retds)}}, nil
 }
 
 //Close releases the dataset
@@ -1284,12 +1686,40 @@ func (ds *Dataset) Close(opts ...CloseOption) error {
 	if ds.cHandle == nil {
 		return fmt.Errorf("close called more than once")
 	}
+	if ds.pool != nil {
+		err := ds.pool.put(ds.handle())
+		ds.cHandle = nil
+		return err
+	}
 	cgc := createCGOContext(nil, co.errorHandler)
 	C.godalClose(cgc.cPointer(), ds.handle())
 	ds.cHandle = nil
 	return cgc.close()
 }
 
+// reopen returns up to n additional handles on ds, for goroutines that cannot share it.
+// Datasets that are not opened read-only, or that cannot be reopened identically by name
+// (e.g. MEM datasets), get none.
+func (ds *Dataset) reopen(n int, errorHandler ErrorHandler) ([]*Dataset, error) {
+	if n <= 0 {
+		return nil, nil
+	}
+	chandles := make([]C.GDALDatasetH, n)
+	cgc := createCGOContext(nil, errorHandler)
+	nh := int(C.godalReopen(cgc.cPointer(), ds.handle(), C.int(n), &chandles[0]))
+	handles := make([]*Dataset, nh)
+	for i := range handles {
+		handles[i] = &Dataset{majorObject: majorObject{C.GDALMajorObjectH(chandles[i])}}
+	}
+	if err := cgc.close(); err != nil {
+		for _, h := range handles {
+			_ = h.Close()
+		}
+		return nil, err
+	}
+	return handles, nil
+}
+
 //LibVersion is the GDAL lib versioning scheme
 type LibVersion int
 
@@ -1329,6 +1759,9 @@ func goErrorHandler(loggerID C.int, ec C.int, code C.int, msg *C.char) C.int {
 	//returns 0 if the received ec/code/msg is not an actual error
 	//returns !0 if msg should be considered an error
 	lfn := getErrorHandler(int(loggerID))
+	//the handler may be called concurrently from multiple gdal threads, e.g. by IOBatch
+	lfn.mu.Lock()
+	defer lfn.mu.Unlock()
 	err := lfn.fn(ErrorCategory(ec), int(code), C.GoString(msg))
 	if err != nil {
 		lfn.err = combine(lfn.err, err)
@@ -1466,6 +1899,37 @@ func (ra ResamplingAlg) rioAlg() (C.GDALRIOResampleAlg, error) {
 	}
 }
 
+func (ra ResamplingAlg) warpAlg() (C.GDALResampleAlg, error) {
+	switch ra {
+	case Nearest:
+		return C.GRA_NearestNeighbour, nil
+	case Average:
+		return C.GRA_Average, nil
+	case Bilinear:
+		return C.GRA_Bilinear, nil
+	case Cubic:
+		return C.GRA_Cubic, nil
+	case CubicSpline:
+		return C.GRA_CubicSpline, nil
+	case Lanczos:
+		return C.GRA_Lanczos, nil
+	case Mode:
+		return C.GRA_Mode, nil
+	case Max:
+		return C.GRA_Max, nil
+	case Min:
+		return C.GRA_Min, nil
+	case Median:
+		return C.GRA_Med, nil
+	case Q1:
+		return C.GRA_Q1, nil
+	case Q3:
+		return C.GRA_Q3, nil
+	default:
+		return C.GRA_NearestNeighbour, fmt.Errorf("%s resampling not supported for warping", ra.String())
+	}
+}
+
 //cBuffer returns the byte size of an individual element, and a pointer to the
 //underlying memory array
 func cBuffer(buffer interface{}) (int, DataType, unsafe.Pointer) {
@@ -1564,6 +2028,12 @@ func (mo majorObject) MetadataDomains() []string {
 	return cStringArrayToSlice(strs)
 }
 
+// Description returns the description of the object, i.e. the name a dataset was opened
+// or created with
+func (mo majorObject) Description() string {
+	return C.GoString(C.GDALGetDescription(mo.cHandle))
+}
+
 type openUpdateOpt struct{}
 
 //Update is an OpenOption that instructs gdal to open the dataset for writing/updating
@@ -1743,46 +2213,34 @@ func (trn *Transform) Close() {
 // successful may be nil or of the same length as x and y. If non nil, it will contain
 // true or false depending on wether the corresponding point succeeded transformation or not.
 //
-// TODO: create a version of this function that accepts *C.double to avoid allocs?
+// The slices are handed over to gdal without any intermediate copy. With Workers(n), n > 1,
+// large point arrays are split in chunks transformed concurrently by n threads, each with
+// its own copy of the transformation (gdal >= 3.1 only, the points are transformed by a
+// single thread otherwise).
+//
 // TODO: create a Transform() method that accepts z and successful as options
-func (trn *Transform) TransformEx(x []float64, y []float64, z []float64, successful []bool) error {
-	cx := make([]C.double, len(x))
-	cy := make([]C.double, len(x))
-	pcx, pcy := (*C.double)(unsafe.Pointer(&cx[0])), (*C.double)(unsafe.Pointer(&cy[0]))
+func (trn *Transform) TransformEx(x []float64, y []float64, z []float64, successful []bool, opts ...TransformExOption) error {
+	to := transformExOpts{workers: 1}
+	for _, o := range opts {
+		o.setTransformExOpt(&to)
+	}
+	if len(y) != len(x) || (len(z) > 0 && len(z) != len(x)) || (len(successful) > 0 && len(successful) != len(x)) {
+		return fmt.Errorf("x, y, z and successful must have the same length")
+	}
+	if len(x) == 0 {
+		return nil
+	}
+	//float64 and bool have the same layout as C's double and unsigned char
+	pcx, pcy := (*C.double)(unsafe.Pointer(&x[0])), (*C.double)(unsafe.Pointer(&y[0]))
 	pcz := (*C.double)(nil)
-	pcs := (*C.int)(nil)
-	var cz []C.double
-	var cs []C.int
+	pcs := (*C.uchar)(nil)
 	if len(z) > 0 {
-		cz = make([]C.double, len(x))
-		pcz = (*C.double)(unsafe.Pointer(&cz[0]))
+		pcz = (*C.double)(unsafe.Pointer(&z[0]))
 	}
 	if len(successful) > 0 {
-		cs = make([]C.int, len(x))
-		pcs = (*C.int)(unsafe.Pointer(&cs[0]))
-	}
-	for i := range x {
-		cx[i] = C.double(x[i])
-		cy[i] = C.double(y[i])
-		if cz != nil {
-			cz[i] = C.double(z[i])
-		}
-	}
-	ret := C.OCTTransformEx(trn.handle, C.int(len(x)), pcx, pcy, pcz, pcs)
-	for i := range x {
-		x[i] = float64(cx[i])
-		y[i] = float64(cy[i])
-		if cz != nil {
-			z[i] = float64(cz[i])
-		}
-		if cs != nil {
-			if cs[i] > 0 {
-				successful[i] = true
-			} else {
-				successful[i] = false
-			}
-		}
+		pcs = (*C.uchar)(unsafe.Pointer(&successful[0]))
 	}
+	ret := C.godalTransformEx(trn.handle, C.longlong(len(x)), pcx, pcy, pcz, pcs, C.int(to.workers))
 	if ret == 0 {
 		return fmt.Errorf("some or all points failed to transform")
 	}
@@ -1881,11 +2339,12 @@ func (ds *Dataset) Rasterize(dstDS string, switches []string, opts ...RasterizeO
 	defer C.free(cname)
 
 	cgc := createCGOContext(gopts.config, gopts.errorHandler)
+	cgc.setProgress(gopts.progress)
 	hndl := C.godalRasterize(cgc.cPointer(), (*C.char)(cname), ds.handle(), cswitches.cPointer())
 	if err := cgc.close(); err != nil {
 		return nil, err
 	}
-	return &Dataset{majorObject{C.GDALMajorObjectH(hndl)}}, nil
+	return &Dataset{majorObject: majorObject{C.GDALMajorObjectH(hndl)}}, nil
 }
 
 // RasterizeGeometry "burns" the provided geometry onto ds.
@@ -1932,6 +2391,66 @@ func (ds *Dataset) RasterizeGeometry(g *Geometry, opts ...RasterizeGeometryOptio
 	return cgc.close()
 }
 
+// RasterizeGeometries "burns" the provided geometries onto ds with a single call to
+// GDALRasterizeGeometries. values holds the pixel values to burn, either one per geometry
+// for all the bands, or len(bands) per geometry (i.e. values[i*len(bands)+b] is burnt
+// for geometry i into band b). Where geometries overlap, the last one wins. nil geometries
+// are skipped. The following options can be used:
+//
+// • Bands(bnd ...int) the list of bands to affect. Defaults to all bands
+//
+// • AllTouched() pixels touched by lines or polygons will be updated, not just those on the line
+// render path, or whose center point is within the polygon.
+//
+// • Workers(n) partitions ds in chunks of rows that are burnt concurrently by n threads.
+// ds must have a geotransform, and must not be used concurrently while RasterizeGeometries
+// is running. Each chunk is at most 64Mb, and at most 3*n chunks are held in memory at once.
+// Defaults to 1, i.e. a single pass over the whole dataset
+//
+// • Progress(fn) and Context(ctx) to monitor and cancel the operation
+func (ds *Dataset) RasterizeGeometries(geoms []*Geometry, values []float64, opts ...RasterizeGeometriesOption) error {
+	opt := rasterizeGeometriesOpts{workers: 1}
+	for _, o := range opts {
+		o.setRasterizeGeometriesOpt(&opt)
+	}
+	if len(opt.bands) == 0 {
+		bnds := ds.Bands()
+		opt.bands = make([]int, len(bnds))
+		for i := range bnds {
+			opt.bands[i] = i + 1
+		}
+	}
+	if len(opt.bands) == 0 {
+		return fmt.Errorf("cannot rasterize on a dataset with no bands")
+	}
+	if len(geoms) == 0 {
+		return nil
+	}
+	if len(values) == len(geoms) && len(opt.bands) > 1 {
+		vals := make([]float64, 0, len(geoms)*len(opt.bands))
+		for _, v := range values {
+			for range opt.bands {
+				vals = append(vals, v)
+			}
+		}
+		values = vals
+	}
+	if len(values) != len(geoms)*len(opt.bands) {
+		return fmt.Errorf("must pass in one value per geometry, or one value per geometry and band")
+	}
+	handles := make([]C.OGRGeometryH, len(geoms))
+	for i, g := range geoms {
+		if g != nil {
+			handles[i] = g.handle
+		}
+	}
+	cgc := createCGOContext(nil, opt.errorHandler)
+	cgc.setProgress(opt.progress)
+	C.godalRasterizeGeometries(cgc.cPointer(), ds.handle(), C.int(len(handles)), &handles[0],
+		cIntArray(opt.bands), C.int(len(opt.bands)), cDoubleArray(values), C.int(opt.allTouched), C.int(opt.workers))
+	return cgc.close()
+}
+
 // GeometryType is a geometry type
 type GeometryType uint32
 
@@ -2039,17 +2558,22 @@ func (ds *Dataset) VectorTranslate(dstDS string, switches []string, opts ...Data
 		}
 		switches = append(switches, "-f", dname)
 	}
+	if gopts.progress.fn != nil || gopts.progress.ctx != nil {
+		//ogr2ogr only reports its progress when asked to
+		switches = append(switches, "-progress")
+	}
 	cswitches := sliceToCStringArray(switches)
 	defer cswitches.free()
 	cname := unsafe.Pointer(C.CString(dstDS))
 	defer C.free(cname)
 
 	cgc := createCGOContext(gopts.config, gopts.errorHandler)
+	cgc.setProgress(gopts.progress)
 	hndl := C.godalDatasetVectorTranslate(cgc.cPointer(), (*C.char)(cname), ds.handle(), cswitches.cPointer())
 	if err := cgc.close(); err != nil {
 		return nil, err
 	}
-	return &Dataset{majorObject{C.GDALMajorObjectH(hndl)}}, nil
+	return &Dataset{majorObject: majorObject{C.GDALMajorObjectH(hndl)}}, nil
 }
 
 // Layer wraps an OGRLayerH
@@ -2645,6 +3169,40 @@ type VSIMultiReader interface {
 	ReadAtMulti(bufs [][]byte, offs []int64) ([]int, error)
 }
 
+// VSIKeyWriter is an optional interface that can be implemented by the VSIKeyReader
+// provided to RegisterVSIHandler to support opening files for writing.
+//
+// Only sequential writes are supported: the data written by gdal is buffered into parts of
+// VSIHandlerWritePartSize bytes that are passed to the returned writer's Write method as
+// soon as they are filled, so that e.g. a multipart upload can be run concurrently with the
+// encoding of the remainder of the file. Write must not retain the passed slice. Close is
+// called once the file has been entirely written or when gdal gave up on writing it, in
+// which case a previous call to Write will have failed.
+//
+// Drivers that need to update previously written data must be configured to write
+// to a temporary file first (e.g. the COG driver, or the GTiff driver with
+// CPL_VSIL_USE_TEMP_FILE_FOR_RANDOM_WRITE=YES on gdal>=3.2).
+type VSIKeyWriter interface {
+	VSIWriter(key string) (io.WriteCloser, error)
+}
+
+// VSIExtentsReader is an optional interface that can be implemented by VSIReader to report
+// which parts of the file effectively contain data. Reads that fall entirely outside of the
+// returned extents are filled with zeros without calling ReadAt, and drivers that query
+// the range status of a file (e.g. GTiff when computing data coverage) can skip them.
+//
+// Extents is called at most once per opened handle. As the VSICreateCachedFile layer used by
+// default does not forward range status queries, VSIHandlerBufferSize(0) or
+// VSIHandlerSharedCacheSize should be used for drivers to take advantage of the extents.
+type VSIExtentsReader interface {
+	Extents() ([]VSIExtent, error)
+}
+
+// VSIExtent is a range of bytes of a file that contains data
+type VSIExtent struct {
+	Offset, Length int64
+}
+
 // VSIKeyReader is the interface that must be provided to RegisterVSIHandler. It
 // should return a VSIReader for the given key.
 //
@@ -2657,19 +3215,56 @@ type VSIKeyReader interface {
 }
 
 //export _gogdalSizeCallback
-func _gogdalSizeCallback(key *C.char, errorString **C.char) C.longlong {
-	//log.Printf("GetSize called")
-	cbd := getGoGDALReader(key, errorString)
+func _gogdalSizeCallback(handlerID C.int, key *C.char, errorString **C.char) C.longlong {
+	cbd := getGoGDALReader(handlerID, key, errorString)
 	if cbd == nil {
 		return -1
 	}
 	return C.longlong(cbd.Size())
 }
 
+// _gogdalOpenCallback resolves the VSIReader for key and returns the id it can be
+// referenced with in subsequent callbacks until it is released by _gogdalCloseCallback.
+// The size of the file is queried if *size is negative, and the first clen bytes of the
+// file are read into buffer. *extents is set to 1 if the reader implements VSIExtentsReader.
+// Returns -1 on failure, in which case *size is set to -1 if the key could not be resolved.
+//export _gogdalOpenCallback
+func _gogdalOpenCallback(handlerID C.int, key *C.char, buffer unsafe.Pointer, clen C.size_t, nread *C.size_t, size *C.longlong, extents *C.int, errorString **C.char) C.int {
+	cbd := getGoGDALReader(handlerID, key, errorString)
+	if cbd == nil {
+		*size = -1
+		return -1
+	}
+	if *size < 0 {
+		*size = C.longlong(cbd.Size())
+	}
+	l := int(clen)
+	if int64(l) > int64(*size) {
+		l = int(*size)
+	}
+	if l > 0 {
+		slice := (*[1 << 28]byte)(buffer)[:l:l]
+		rlen, err := cbd.ReadAt(slice, 0)
+		if err != nil && err != io.EOF {
+			*errorString = C.CString(err.Error())
+			return -1
+		}
+		*nread = C.size_t(rlen)
+	}
+	if _, ok := cbd.(VSIExtentsReader); ok {
+		*extents = 1
+	}
+	return C.int(vsiReaders.add(cbd, C.GoString(key), vsiHandlers.Load().([]vsiHandler)[handlerID]))
+}
+
+//export _gogdalCloseCallback
+func _gogdalCloseCallback(readerID C.int) {
+	vsiReaders.remove(int(readerID))
+}
+
 //export _gogdalMultiReadCallback
-func _gogdalMultiReadCallback(key *C.char, nRanges C.int, pocbuffers unsafe.Pointer, coffsets unsafe.Pointer, clengths unsafe.Pointer, errorString **C.char) C.int {
-	cbd := getGoGDALReader(key, errorString)
-	/* cbd == nil would be a bug elsewhere */
+func _gogdalMultiReadCallback(readerID C.int, nRanges C.int, pocbuffers unsafe.Pointer, coffsets unsafe.Pointer, clengths unsafe.Pointer, errorString **C.char) C.int {
+	cbd := vsiReaders.get(int(readerID))
 	n := int(nRanges)
 	cbuffers := (*[1 << 28]unsafe.Pointer)(unsafe.Pointer(pocbuffers))[:n:n]
 	lengths := (*[1 << 28]C.size_t)(unsafe.Pointer(clengths))[:n:n]
@@ -2677,78 +3272,402 @@ func _gogdalMultiReadCallback(key *C.char, nRanges C.int, pocbuffers unsafe.Poin
 
 	buffers := make([][]byte, n)
 	goffsets := make([]int64, n)
-	ret := int64(0)
 	for b := range buffers {
 		l := int(lengths[b])
 		buffers[b] = (*[1 << 28]byte)(unsafe.Pointer(cbuffers[b]))[:l:l]
 		goffsets[b] = int64(offsets[b])
 	}
-	var err error
-	if mcbd, ok := cbd.(VSIMultiReader); ok {
-		_, err = mcbd.ReadAtMulti(buffers, goffsets)
+	start := time.Now()
+	err := vsiReadAtMulti(cbd, buffers, goffsets)
+	cbd.traceRequest(goffsets, buffers, start, err)
+	if err != nil {
+		*errorString = C.CString(err.Error())
+		return -1
+	}
+	return 0
+}
+
+// vsiReadAtMulti fills buffers with the data found at offsets, using a single call to
+// ReadAtMulti if r supports it, or with concurrent calls to ReadAt otherwise.
+func vsiReadAtMulti(r *vsiReaderEntry, buffers [][]byte, offsets []int64) error {
+	if mr, ok := r.VSIReader.(VSIMultiReader); ok {
+		_, err := mr.ReadAtMulti(buffers, offsets)
 		if err != nil && err != io.EOF {
-			*errorString = C.CString(err.Error())
-			ret = -1
+			return err
 		}
-		return C.int(ret)
+		return nil
 	}
-	var wg sync.WaitGroup
-	wg.Add(n)
+	var (
+		wg       sync.WaitGroup
+		mu       sync.Mutex
+		firstErr error
+	)
+	wg.Add(len(buffers))
 	for b := range buffers {
 		go func(bidx int) {
 			defer wg.Done()
-			rlen, err := cbd.ReadAt(buffers[bidx], goffsets[bidx])
-			if err != nil && err != io.EOF {
-				if *errorString == nil {
-					*errorString = C.CString(err.Error())
-				}
-				atomic.StoreInt64(&ret, -1)
+			rlen, err := r.policy.readAt(r.VSIReader, buffers[bidx], offsets[bidx])
+			if err == io.EOF && rlen == len(buffers[bidx]) {
+				err = nil
+			}
+			if err == nil && rlen != len(buffers[bidx]) {
+				err = io.ErrUnexpectedEOF
 			}
-			if rlen != int(lengths[bidx]) {
-				if *errorString == nil {
-					if err != nil {
-						*errorString = C.CString(err.Error())
-					} else {
-						*errorString = C.CString("short read")
-					}
+			if err != nil {
+				mu.Lock()
+				if firstErr == nil {
+					firstErr = err
 				}
-				atomic.StoreInt64(&ret, -1)
+				mu.Unlock()
 			}
 		}(b)
 	}
 	wg.Wait()
-	return C.int(ret)
+	return firstErr
+}
+
+var (
+	writersMu  sync.Mutex
+	writers    = make(map[int64]io.WriteCloser)
+	nextWriter int64
+)
+
+//export _gogdalOpenWriterCallback
+func _gogdalOpenWriterCallback(handlerID C.int, key *C.char, errorString **C.char) C.longlong {
+	kw, ok := getVSIHandler(handlerID).(VSIKeyWriter)
+	if !ok {
+		*errorString = C.CString("handler does not support writing")
+		return -1
+	}
+	w, err := kw.VSIWriter(C.GoString(key))
+	if err != nil {
+		*errorString = C.CString(err.Error())
+		return -1
+	}
+	writersMu.Lock()
+	defer writersMu.Unlock()
+	nextWriter++
+	writers[nextWriter] = w
+	return C.longlong(nextWriter)
+}
+
+//export _gogdalWriteCallback
+func _gogdalWriteCallback(writerID C.longlong, buffer unsafe.Pointer, clen C.size_t, errorString **C.char) C.int {
+	writersMu.Lock()
+	w := writers[int64(writerID)]
+	writersMu.Unlock()
+	l := int(clen)
+	if _, err := w.Write((*[1 << 28]byte)(buffer)[:l:l]); err != nil {
+		*errorString = C.CString(err.Error())
+		return -1
+	}
+	return 0
+}
+
+//export _gogdalCloseWriterCallback
+func _gogdalCloseWriterCallback(writerID C.longlong, errorString **C.char) C.int {
+	writersMu.Lock()
+	w := writers[int64(writerID)]
+	delete(writers, int64(writerID))
+	writersMu.Unlock()
+	if err := w.Close(); err != nil {
+		*errorString = C.CString(err.Error())
+		return -1
+	}
+	return 0
+}
+
+//export _gogdalExtentsCallback
+func _gogdalExtentsCallback(readerID C.int, nExtents *C.int, errorString **C.char) unsafe.Pointer {
+	*nExtents = -1
+	ecbd, ok := vsiReaders.get(int(readerID)).VSIReader.(VSIExtentsReader)
+	if !ok {
+		return nil
+	}
+	extents, err := ecbd.Extents()
+	if err != nil {
+		*errorString = C.CString(err.Error())
+		return nil
+	}
+	n := len(extents)
+	*nExtents = C.int(n)
+	if n == 0 {
+		return nil
+	}
+	cextents := C.malloc(C.size_t(2*n) * C.size_t(unsafe.Sizeof(C.ulonglong(0))))
+	sextents := (*[1 << 28]C.ulonglong)(cextents)[: 2*n : 2*n]
+	for i, e := range extents {
+		sextents[2*i] = C.ulonglong(e.Offset)
+		sextents[2*i+1] = C.ulonglong(e.Length)
+	}
+	return cextents
 }
 
 //export _gogdalReadCallback
-func _gogdalReadCallback(key *C.char, buffer unsafe.Pointer, off C.size_t, clen C.size_t, errorString **C.char) C.size_t {
+func _gogdalReadCallback(readerID C.int, buffer unsafe.Pointer, off C.size_t, clen C.size_t, errorString **C.char) C.size_t {
 	l := int(clen)
-	cbd := getGoGDALReader(key, errorString)
-	/* cbd == nil would be a bug elsewhere */
+	cbd := vsiReaders.get(int(readerID))
 	slice := (*[1 << 28]byte)(buffer)[:l:l]
-	rlen, err := cbd.ReadAt(slice, int64(off))
-	if err != nil && err != io.EOF {
+	start := time.Now()
+	rlen, err := cbd.policy.readAt(cbd.VSIReader, slice, int64(off))
+	if err == io.EOF {
+		err = nil
+	}
+	cbd.traceRequest([]int64{int64(off)}, [][]byte{slice}, start, err)
+	if err != nil {
 		*errorString = C.CString(err.Error())
 	}
 	return C.size_t(rlen)
 }
 
-var handlers map[string]VSIKeyReader
+type vsiHandler struct {
+	prefix string
+	VSIKeyReader
+	trace  func(VSITrace)
+	policy *vsiReadPolicy
+}
+
+var (
+	vsiHandlersMu sync.Mutex
+	// vsiHandlers holds the []vsiHandler registered with RegisterVSIHandler, indexed by the
+	// id passed to the C++ handler. It is replaced (copy-on-write) on each registration so
+	// that it can be read without locking from the callbacks
+	vsiHandlers atomic.Value
+)
 
-func getGoGDALReader(ckey *C.char, errorString **C.char) VSIReader {
-	key := C.GoString(ckey)
-	for prefix, handler := range handlers {
-		if strings.HasPrefix(key, prefix) {
-			hndl, err := handler.VSIReader(key[len(prefix):])
-			if err != nil {
-				*errorString = C.CString(err.Error())
-				return nil
+func getVSIHandler(handlerID C.int) VSIKeyReader {
+	return vsiHandlers.Load().([]vsiHandler)[handlerID].VSIKeyReader
+}
+
+// vsiReadPolicy bounds the number of concurrent ReadAt calls made to the readers of a
+// handler, and optionally hedges them (c.f. VSIHandlerMaxConcurrency and VSIHandlerHedgedReads).
+// A nil *vsiReadPolicy calls ReadAt directly.
+type vsiReadPolicy struct {
+	sem        chan struct{}
+	hedge      bool
+	hedgeAfter time.Duration
+
+	latMu sync.Mutex
+	lat   []time.Duration // ring of the latest latencies, used when hedgeAfter is 0
+	nlat  int
+	p95   int64 // atomic, 0 until enough latencies have been recorded
+}
+
+const (
+	vsiLatencySamples    = 256
+	vsiMinLatencySamples = 32
+)
+
+func newVSIReadPolicy(maxConcurrency int, hedge bool, hedgeAfter time.Duration) *vsiReadPolicy {
+	if maxConcurrency <= 0 && !hedge {
+		return nil
+	}
+	p := &vsiReadPolicy{hedge: hedge, hedgeAfter: hedgeAfter}
+	if maxConcurrency > 0 {
+		p.sem = make(chan struct{}, maxConcurrency)
+	}
+	if hedge && hedgeAfter <= 0 {
+		p.lat = make([]time.Duration, vsiLatencySamples)
+	}
+	return p
+}
+
+func (p *vsiReadPolicy) acquire() {
+	if p.sem != nil {
+		p.sem <- struct{}{}
+	}
+}
+
+func (p *vsiReadPolicy) tryAcquire() bool {
+	if p.sem == nil {
+		return true
+	}
+	select {
+	case p.sem <- struct{}{}:
+		return true
+	default:
+		return false
+	}
+}
+
+func (p *vsiReadPolicy) release() {
+	if p.sem != nil {
+		<-p.sem
+	}
+}
+
+// record adds a ReadAt latency to the samples the p95 hedging delay is computed from
+func (p *vsiReadPolicy) record(d time.Duration) {
+	if p.lat == nil {
+		return
+	}
+	p.latMu.Lock()
+	defer p.latMu.Unlock()
+	p.lat[p.nlat%vsiLatencySamples] = d
+	p.nlat++
+	if p.nlat >= vsiMinLatencySamples && p.nlat%(vsiMinLatencySamples/2) == 0 {
+		n := p.nlat
+		if n > vsiLatencySamples {
+			n = vsiLatencySamples
+		}
+		sorted := make([]time.Duration, n)
+		copy(sorted, p.lat[:n])
+		sort.Slice(sorted, func(i, j int) bool { return sorted[i] < sorted[j] })
+		atomic.StoreInt64(&p.p95, int64(sorted[n*95/100]))
+	}
+}
+
+func (p *vsiReadPolicy) hedgeDelay() time.Duration {
+	if p.hedgeAfter > 0 {
+		return p.hedgeAfter
+	}
+	return time.Duration(atomic.LoadInt64(&p.p95))
+}
+
+type vsiReadResult struct {
+	buf []byte
+	n   int
+	err error
+}
+
+// readAt calls r.ReadAt(buf,off) once a concurrency slot is available. When hedging,
+// a second identical request is issued if the first one has not completed after the
+// hedging delay, and the result of the first one to succeed is returned.
+func (p *vsiReadPolicy) readAt(r io.ReaderAt, buf []byte, off int64) (int, error) {
+	if p == nil {
+		return r.ReadAt(buf, off)
+	}
+	after := time.Duration(0)
+	if p.hedge {
+		after = p.hedgeDelay()
+	}
+	if after <= 0 {
+		p.acquire()
+		start := time.Now()
+		n, err := r.ReadAt(buf, off)
+		p.release()
+		p.record(time.Since(start))
+		return n, err
+	}
+	//the attempts read into their own buffers as the losing one may still be running
+	//after we have returned and buf has been handed back to gdal
+	results := make(chan vsiReadResult, 2)
+	attempt := func() {
+		b := make([]byte, len(buf))
+		start := time.Now()
+		n, err := r.ReadAt(b, off)
+		p.release()
+		p.record(time.Since(start))
+		results <- vsiReadResult{b, n, err}
+	}
+	p.acquire()
+	go attempt()
+	pending := 1
+	timer := time.NewTimer(after)
+	defer timer.Stop()
+	for {
+		select {
+		case res := <-results:
+			pending--
+			if res.err != nil && res.err != io.EOF && pending > 0 {
+				continue
+			}
+			copy(buf, res.buf[:res.n])
+			return res.n, res.err
+		case <-timer.C:
+			//the hedged request must not exceed the concurrency limit
+			if p.tryAcquire() {
+				pending++
+				go attempt()
 			}
-			return hndl
 		}
 	}
-	*errorString = C.CString("handler not registered for prefix")
-	return nil
+}
+
+const vsiReaderChunkSize = 1024
+
+type vsiReaderEntry struct {
+	VSIReader
+	key    string
+	trace  func(VSITrace)
+	policy *vsiReadPolicy
+}
+
+// traceRequest reports a request made to the reader to the VSIHandlerTrace callback, if any
+func (e *vsiReaderEntry) traceRequest(offsets []int64, buffers [][]byte, start time.Time, err error) {
+	if e.trace == nil {
+		return
+	}
+	lengths := make([]int, len(buffers))
+	for i := range buffers {
+		lengths[i] = len(buffers[i])
+	}
+	e.trace(VSITrace{
+		Key:      e.key,
+		Offsets:  offsets,
+		Lengths:  lengths,
+		Duration: time.Since(start),
+		Err:      err,
+	})
+}
+
+// vsiReaderTable maps the ids held by the C++ VSIGoHandles to the VSIReader they were
+// opened with. Lookups are lock-free, insertions and removals are serialized by mu.
+type vsiReaderTable struct {
+	mu sync.Mutex
+	// chunks is a []*[vsiReaderChunkSize]atomic.Value, replaced when a chunk is added.
+	// Chunks themselves are never reallocated so a slot can be read while another
+	// chunk is being added.
+	chunks atomic.Value
+	free   []int
+	next   int
+}
+
+var vsiReaders vsiReaderTable
+
+func (t *vsiReaderTable) add(r VSIReader, key string, h vsiHandler) int {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	var id int
+	if n := len(t.free); n > 0 {
+		id = t.free[n-1]
+		t.free = t.free[:n-1]
+	} else {
+		id = t.next
+		t.next++
+	}
+	chunks, _ := t.chunks.Load().([]*[vsiReaderChunkSize]atomic.Value)
+	if id/vsiReaderChunkSize >= len(chunks) {
+		nchunks := make([]*[vsiReaderChunkSize]atomic.Value, len(chunks)+1)
+		copy(nchunks, chunks)
+		nchunks[len(chunks)] = new([vsiReaderChunkSize]atomic.Value)
+		t.chunks.Store(nchunks)
+		chunks = nchunks
+	}
+	chunks[id/vsiReaderChunkSize][id%vsiReaderChunkSize].Store(&vsiReaderEntry{r, key, h.trace, h.policy})
+	return id
+}
+
+func (t *vsiReaderTable) get(id int) *vsiReaderEntry {
+	chunks := t.chunks.Load().([]*[vsiReaderChunkSize]atomic.Value)
+	return chunks[id/vsiReaderChunkSize][id%vsiReaderChunkSize].Load().(*vsiReaderEntry)
+}
+
+func (t *vsiReaderTable) remove(id int) {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	chunks := t.chunks.Load().([]*[vsiReaderChunkSize]atomic.Value)
+	chunks[id/vsiReaderChunkSize][id%vsiReaderChunkSize].Store((*vsiReaderEntry)(nil))
+	t.free = append(t.free, id)
+}
+
+func getGoGDALReader(handlerID C.int, key *C.char, errorString **C.char) VSIReader {
+	hndl, err := getVSIHandler(handlerID).VSIReader(C.GoString(key))
+	if err != nil {
+		*errorString = C.CString(err.Error())
+		return nil
+	}
+	return hndl
 }
 
 type osioAdapterWrapper struct {
@@ -2776,21 +3695,129 @@ func RegisterVSIHandler(prefix string, keyReader VSIKeyReader, opts ...VSIHandle
 	for _, o := range opts {
 		o.setVSIHandlerOpt(&opt)
 	}
-	if handlers == nil {
-		handlers = make(map[string]VSIKeyReader)
+	//the prefetched bytes and the written parts are passed to the go callbacks as slices of a 1<<28 array
+	if opt.prefetch < 0 || opt.prefetch >= 1<<28 {
+		return fmt.Errorf("invalid prefetch size %d", opt.prefetch)
 	}
-	if handlers[prefix] != nil {
-		return fmt.Errorf("handler already registered on prefix")
+	if opt.partSize < 0 || opt.partSize >= 1<<28 {
+		return fmt.Errorf("invalid write part size %d", opt.partSize)
 	}
+	if opt.mergeGap < 0 {
+		return fmt.Errorf("invalid merge gap %d", opt.mergeGap)
+	}
+	vsiHandlersMu.Lock()
+	defer vsiHandlersMu.Unlock()
+	registered, _ := vsiHandlers.Load().([]vsiHandler)
+	for _, h := range registered {
+		if h.prefix == prefix {
+			return fmt.Errorf("handler already registered on prefix")
+		}
+	}
+	//the handler must be visible to the callbacks as soon as it is installed
+	nregistered := make([]vsiHandler, len(registered)+1)
+	copy(nregistered, registered)
+	nregistered[len(registered)] = vsiHandler{prefix, keyReader, opt.trace,
+		newVSIReadPolicy(opt.maxConcurrency, opt.hedge, opt.hedgeAfter)}
+	vsiHandlers.Store(nregistered)
+
+	cprefix := C.CString(prefix)
+	defer C.free(unsafe.Pointer(cprefix))
 	cgc := createCGOContext(nil, opt.errorHandler)
-	C.VSIInstallGoHandler(cgc.cPointer(), C.CString(prefix), C.size_t(opt.bufferSize), C.size_t(opt.cacheSize))
+	C.VSIInstallGoHandler(cgc.cPointer(), cprefix, C.int(len(registered)), C.size_t(opt.bufferSize), C.size_t(opt.cacheSize), C.size_t(opt.mergeGap), C.size_t(opt.sharedCacheSize),
+		C.longlong(opt.statTTL), C.longlong(opt.negStatTTL), C.size_t(opt.prefetch), C.size_t(opt.partSize), C.int(opt.readAhead))
 	if err := cgc.close(); err != nil {
+		vsiHandlers.Store(registered)
 		return err
 	}
-	handlers[prefix] = keyReader
 	return nil
 }
 
+// VSIInvalidate drops the cached sizes, missing keys and shared cache blocks of all the
+// files starting with path (e.g. "scheme://myfile.tif", or "scheme://" for all the files
+// of the handler) from the caches of the handler registered with RegisterVSIHandler.
+func VSIInvalidate(path string, opts ...VSIInvalidateOption) error {
+	vo := &vsiInvalidateOpts{}
+	for _, o := range opts {
+		o.setVSIInvalidateOpt(vo)
+	}
+	cname := unsafe.Pointer(C.CString(path))
+	defer C.free(cname)
+	cgc := createCGOContext(nil, vo.errorHandler)
+	C.VSIInvalidateGoHandler(cgc.cPointer(), (*C.char)(cname))
+	return cgc.close()
+}
+
+// VSIHandlerStats holds the i/o counters of a handler registered with RegisterVSIHandler,
+// or of one of its files.
+type VSIHandlerStats struct {
+	// Opens and Stats are the number of files opened and of stat requests made by gdal
+	Opens, Stats int64
+	// Reads and MultiReads are the number of Read and ReadMultiRange calls made by gdal,
+	// Ranges is the total number of ranges requested by MultiReads, and BytesRequested
+	// the number of bytes requested by all these calls
+	Reads, MultiReads, Ranges, BytesRequested int64
+	// GoReads is the number of calls made to the VSIReader's ReadAt or ReadAtMulti methods
+	// in order to serve the above requests, GoRanges and GoBytes the number of ranges and
+	// bytes that were requested by these calls
+	GoReads, GoRanges, GoBytes int64
+	// CacheHits and CacheMisses count the lookups in the shared block cache
+	// (c.f. VSIHandlerSharedCacheSize)
+	CacheHits, CacheMisses int64
+	// Errors is the number of GoReads that failed
+	Errors int64
+	// Latency is an histogram of the durations of the GoReads: Latency[0] counts the
+	// reads that took less than 1ms, Latency[i] those that took between 2^(i-1) and 2^i ms,
+	// and the last bucket all the slower ones
+	Latency [16]int64
+}
+
+// VSITrace describes a request made to a VSIReader, as reported to the callback set
+// with VSIHandlerTrace
+type VSITrace struct {
+	Key      string
+	Offsets  []int64
+	Lengths  []int
+	Duration time.Duration
+	// Err is the error returned by the reader, if any
+	Err error
+}
+
+// VSIStats returns the i/o counters of the handler registered on path if path is
+// a prefix given to RegisterVSIHandler, or those of the file path otherwise (which
+// are zero if the file was never opened, or if its counters have been discarded).
+func VSIStats(path string, opts ...VSIStatsOption) (VSIHandlerStats, error) {
+	so := vsiStatsOpts{}
+	for _, o := range opts {
+		o.setVSIStatsOpt(&so)
+	}
+	cname := unsafe.Pointer(C.CString(path))
+	defer C.free(cname)
+	var cstats [C.GODAL_VSI_NSTATS]C.longlong
+	cgc := createCGOContext(nil, so.errorHandler)
+	C.VSIGoHandlerStats(cgc.cPointer(), (*C.char)(cname), &cstats[0])
+	if err := cgc.close(); err != nil {
+		return VSIHandlerStats{}, err
+	}
+	st := VSIHandlerStats{
+		Opens:          int64(cstats[C.GODAL_VSI_OPENS]),
+		Stats:          int64(cstats[C.GODAL_VSI_STATS]),
+		Reads:          int64(cstats[C.GODAL_VSI_READS]),
+		MultiReads:     int64(cstats[C.GODAL_VSI_MULTIREADS]),
+		Ranges:         int64(cstats[C.GODAL_VSI_RANGES]),
+		BytesRequested: int64(cstats[C.GODAL_VSI_BYTES_REQUESTED]),
+		GoReads:        int64(cstats[C.GODAL_VSI_GO_READS]),
+		GoRanges:       int64(cstats[C.GODAL_VSI_GO_RANGES]),
+		GoBytes:        int64(cstats[C.GODAL_VSI_GO_BYTES]),
+		CacheHits:      int64(cstats[C.GODAL_VSI_CACHE_HITS]),
+		CacheMisses:    int64(cstats[C.GODAL_VSI_CACHE_MISSES]),
+		Errors:         int64(cstats[C.GODAL_VSI_ERRORS]),
+	}
+	for i := range st.Latency {
+		st.Latency[i] = int64(cstats[C.GODAL_VSI_LATENCY+i])
+	}
+	return st, nil
+}
+
 //BuildVRT runs the GDALBuildVRT function and creates a VRT dataset from a list of datasets
 func BuildVRT(dstVRTName string, sourceDatasets []string, switches []string, opts ...BuildVRTOption) (*Dataset, error) {
 	bvo := buildVRTOpts{}
@@ -2816,25 +3843,32 @@ func BuildVRT(dstVRTName string, sourceDatasets []string, switches []string, opt
 	defer csources.free()
 
 	cgc := createCGOContext(bvo.config, bvo.errorHandler)
+	cgc.setProgress(bvo.progress)
 	hndl := C.godalBuildVRT(cgc.cPointer(), (*C.char)(cname), csources.cPointer(),
 		cswitches.cPointer())
 	if err := cgc.close(); err != nil {
 		return nil, err
 	}
-	return &Dataset{majorObject{C.GDALMajorObjectH(hndl)}}, nil
+	return &Dataset{majorObject: majorObject{C.GDALMajorObjectH(hndl)}}, nil
 }
 
 type cgoContext struct {
 	cctx *C.cctx
-	opts cStringArray
 }
 
+// cctxPool holds released C contexts so that the common case of a call without config
+// options nor ErrorHandler does not allocate. Contexts are C allocated so a sync.Pool,
+// which silently drops its items, cannot be used.
+var cctxPool = make(chan *C.cctx, 64)
+
 func createCGOContext(configOptions []string, eh ErrorHandler) cgoContext {
-	cgc := cgoContext{
-		opts: sliceToCStringArray(configOptions),
-		cctx: (*C.cctx)(C.malloc(C.size_t(unsafe.Sizeof(C.cctx{})))),
+	var cgc cgoContext
+	select {
+	case cgc.cctx = <-cctxPool:
+	default:
+		cgc.cctx = (*C.cctx)(C.malloc(C.size_t(unsafe.Sizeof(C.cctx{}))))
 	}
-	cgc.cctx.configOptions = cgc.opts.cPointer()
+	cgc.cctx.configOptions = configPairs(configOptions)
 	cgc.cctx.failed = 0
 	cgc.cctx.errMessage = nil
 	if eh != nil {
@@ -2842,28 +3876,96 @@ func createCGOContext(configOptions []string, eh ErrorHandler) cgoContext {
 	} else {
 		cgc.cctx.handlerIdx = 0
 	}
+	cgc.cctx.progressIdx = 0
 	return cgc
 }
 
+// setProgress makes the gdal call report its progress to po.fn, and be interrupted
+// once po.ctx is done
+func (cgc cgoContext) setProgress(po progressOpts) {
+	cgc.cctx.progressIdx = C.int(registerProgress(po))
+}
+
+// configPairs splits KEY=VALUE config options into a C allocated, null terminated,
+// key,value,key,value... list, so that they do not have to be parsed again on each
+// side of the call. Options without a "=" are ignored. Returns nil if there are no options.
+func configPairs(configOptions []string) **C.char {
+	n := 0
+	for _, opt := range configOptions {
+		if strings.IndexByte(opt, '=') >= 0 {
+			n++
+		}
+	}
+	if n == 0 {
+		return nil
+	}
+	ptrSize := C.size_t(unsafe.Sizeof((*C.char)(nil)))
+	cpairs := (**C.char)(C.malloc(C.size_t(2*n+1) * ptrSize))
+	pairs := (*[1 << 28]*C.char)(unsafe.Pointer(cpairs))[: 2*n+1 : 2*n+1]
+	i := 0
+	for _, opt := range configOptions {
+		if idx := strings.IndexByte(opt, '='); idx >= 0 {
+			pairs[i] = C.CString(opt[:idx])
+			pairs[i+1] = C.CString(opt[idx+1:])
+			i += 2
+		}
+	}
+	pairs[i] = nil
+	return cpairs
+}
+
+func freeConfigPairs(cpairs **C.char) {
+	if cpairs == nil {
+		return
+	}
+	pairs := (*[1 << 28]*C.char)(unsafe.Pointer(cpairs))
+	for i := 0; pairs[i] != nil; i++ {
+		C.free(unsafe.Pointer(pairs[i]))
+	}
+	C.free(unsafe.Pointer(cpairs))
+}
+
 func (cgc cgoContext) cPointer() *C.cctx {
 	return cgc.cctx
 }
 
 //frees the context and returns any error it may contain
 func (cgc cgoContext) close() error {
-	cgc.opts.free()
-	if cgc.cctx.errMessage != nil {
+	freeConfigPairs(cgc.cctx.configOptions)
+	errMessage, handlerIdx := cgc.cctx.errMessage, int(cgc.cctx.handlerIdx)
+	progressIdx := int(cgc.cctx.progressIdx)
+	select {
+	case cctxPool <- cgc.cctx:
+	default:
+		C.free(unsafe.Pointer(cgc.cctx))
+	}
+	if progressIdx != 0 {
+		//an interrupted operation returns the reason it was interrupted rather
+		//than gdal's generic "User terminated" error
+		p := getProgress(progressIdx)
+		unregisterProgress(progressIdx)
+		if p.err != nil {
+			if errMessage != nil {
+				C.free(unsafe.Pointer(errMessage))
+			}
+			if handlerIdx != 0 {
+				unregisterErrorHandler(handlerIdx)
+			}
+			return p.err
+		}
+	}
+	if errMessage != nil {
 		/* debug code
-		if cgc.cctx.handlerIdx != 0 {
+		if handlerIdx != 0 {
 			panic("bug!")
 		}
 		*/
-		defer C.free(unsafe.Pointer(cgc.cctx.errMessage))
-		return errors.New(C.GoString(cgc.cctx.errMessage))
+		defer C.free(unsafe.Pointer(errMessage))
+		return errors.New(C.GoString(errMessage))
 	}
-	if cgc.cctx.handlerIdx != 0 {
-		defer unregisterErrorHandler(int(cgc.cctx.handlerIdx))
-		return getErrorHandler(int(cgc.cctx.handlerIdx)).err
+	if handlerIdx != 0 {
+		defer unregisterErrorHandler(handlerIdx)
+		return getErrorHandler(handlerIdx).err
 	}
 	return nil
 }
@@ -16,7 +16,9 @@
 #define _GODAL_H_
 
 #define _GNU_SOURCE 1
+#include <stdint.h>
 #include <gdal.h>
+#include <gdalwarper.h>
 #include <ogr_srs_api.h>
 #include <cpl_conv.h>
 #include "cpl_port.h"
@@ -33,8 +35,40 @@ extern "C" {
 		char *errMessage;
 		int handlerIdx;
 		int failed;
-		char **configOptions;
+		char **configOptions; /* null terminated list of key,value pairs */
+		int progressIdx;	  /* go progress callback, 0 if none */
 	} cctx;
+
+	/* indices of the counters filled by VSIGoHandlerStats */
+	enum {
+		GODAL_VSI_OPENS,
+		GODAL_VSI_STATS,
+		GODAL_VSI_READS,
+		GODAL_VSI_MULTIREADS,
+		GODAL_VSI_RANGES,
+		GODAL_VSI_BYTES_REQUESTED,
+		GODAL_VSI_GO_READS,
+		GODAL_VSI_GO_RANGES,
+		GODAL_VSI_GO_BYTES,
+		GODAL_VSI_CACHE_HITS,
+		GODAL_VSI_CACHE_MISSES,
+		GODAL_VSI_ERRORS,
+		GODAL_VSI_LATENCY, /* first of the GODAL_VSI_LATENCY_BUCKETS latency buckets */
+		GODAL_VSI_LATENCY_BUCKETS = 16,
+		GODAL_VSI_NSTATS = GODAL_VSI_LATENCY + GODAL_VSI_LATENCY_BUCKETS
+	};
+	/* counters of the instrumented calls to an entry point, see godalSetInstrumentation */
+	typedef struct {
+		const char *function;
+		long long calls;
+		long long wrapNs; /* spent in godalWrap/godalUnwrap */
+		long long bodyNs; /* spent between godalWrap and godalUnwrap */
+	} godalCallStat;
+	void godalSetInstrumentation(int enabled);
+	void godalResetInstrumentation();
+	/* returns the number of entries of *stats, which must be freed by the caller */
+	int godalInstrumentationStats(godalCallStat **stats);
+
 	void godalSetMetadataItem(cctx *ctx, GDALMajorObjectH mo, char *ckey, char *cval, char *cdom);
 	GDALDatasetH godalOpen(cctx *ctx, const char *name, unsigned int nOpenFlags, const char *const *papszAllowedDrivers,
 						   const char *const *papszOpenOptions, const char *const *papszSiblingFiles);
@@ -43,6 +77,8 @@ extern "C" {
 							GDALDataType dtype, char **creationOption);
 
 	void godalClose(cctx *ctx, GDALDatasetH ds);
+	/* fills handles with up to n additional read-only handles on ds, returns their number */
+	int godalReopen(cctx *ctx, GDALDatasetH ds, int n, GDALDatasetH *handles);
 	int godalRegisterDriver(const char *funcname);
 	void godalRasterSize(GDALDatasetH ds, int *xsize, int *ysize);
 
@@ -63,6 +99,20 @@ extern "C" {
 	OGRSpatialReferenceH godalCreateEPSGSpatialRef(cctx *ctx, int epsgCode);
 	char* godalExportToWKT(cctx *ctx, OGRSpatialReferenceH sr);
 	OGRCoordinateTransformationH godalNewCoordinateTransformation(cctx *ctx,  OGRSpatialReferenceH src, OGRSpatialReferenceH dst);
+	/* godalTransformEx transforms the points in place, in chunks spread over nThreads threads.
+	   successful may be nullptr. returns 0 if some or all points failed to transform */
+	int godalTransformEx(OGRCoordinateTransformationH trn, long long nPoints, double *x, double *y, double *z,
+						 unsigned char *successful, int nThreads);
+	/* godalCachedSpatialRef returns a copy of the process wide cached spatial reference for
+	   epsgCode, or for wkt if epsgCode is 0 */
+	OGRSpatialReferenceH godalCachedSpatialRef(cctx *ctx, int epsgCode, char *wkt);
+	typedef void *godalSharedTransformH;
+	godalSharedTransformH godalCachedTransform(cctx *ctx, OGRSpatialReferenceH src, OGRSpatialReferenceH dst);
+	/* godalSharedTransformHandle returns the calling thread's instance of the shared transform */
+	OGRCoordinateTransformationH godalSharedTransformHandle(cctx *ctx, godalSharedTransformH trn);
+	/* godalSharedTransformGeometry transforms geom with the calling thread's instance of the
+	   shared transform, and assigns it its own copy of the target spatial reference */
+	void godalSharedTransformGeometry(cctx *ctx, OGRGeometryH geom, godalSharedTransformH trn);
 	void godalDatasetSetSpatialRef(cctx *ctx, GDALDatasetH ds, OGRSpatialReferenceH sr);
 	void godalSetGeoTransform(cctx *ctx, GDALDatasetH ds, double *gt);
 	void godalGetGeoTransform(cctx *ctx, GDALDatasetH ds, double *gt);
@@ -71,9 +121,16 @@ extern "C" {
 	GDALDatasetH godalTranslate(cctx *ctx, char *dstName, GDALDatasetH ds, char **switches);
 	GDALDatasetH godalDatasetWarp(cctx *ctx, char *dstName, int nSrcCount, GDALDatasetH *srcDS, char **switches);
 	void godalDatasetWarpInto(cctx *ctx, GDALDatasetH dstDs,  int nSrcCount, GDALDatasetH *srcDS, char **switches);
+	typedef void *godalWarperH;
+	godalWarperH godalCreateWarper(cctx *ctx, int nSrcCount, GDALDatasetH *srcDS, OGRSpatialReferenceH dstSRS, GDALResampleAlg alg,
+								   double errorThreshold, double memoryLimit, int nThreads);
+	void godalWarperWarp(cctx *ctx, godalWarperH warper, GDALDatasetH dstDS, double *gt);
+	void godalDestroyWarper(godalWarperH warper);
 	GDALDatasetH godalDatasetVectorTranslate(cctx *ctx, char *dstName, GDALDatasetH ds, char **switches);
 	GDALDatasetH godalRasterize(cctx *ctx, char *dstName, GDALDatasetH ds, char **switches);
 	void godalRasterizeGeometry(cctx *ctx, GDALDatasetH ds, OGRGeometryH geom, int *bands, int nBands, double *vals, int allTouched);
+	void godalRasterizeGeometries(cctx *ctx, GDALDatasetH ds, int nGeoms, OGRGeometryH *geoms, int *bands, int nBands, double *vals,
+								  int allTouched, int nThreads);
 	void godalBuildOverviews(cctx *ctx, GDALDatasetH ds, const char *resampling, int nLevels, int *levels, int nBands, int *bands);
 	void godalClearOverviews(cctx *ctx, GDALDatasetH ds);
 
@@ -84,23 +141,89 @@ extern "C" {
 		int nPixelSpace, int nLineSpace, int nBandSpace, GDALRIOResampleAlg alg);
 	void godalBandRasterIO(cctx *ctx, GDALRasterBandH bnd, GDALRWFlag rw, int nDSXOff, int nDSYOff, int nDSXSize, int nDSYSize, void *pBuffer,
 		int nBXSize, int nBYSize, GDALDataType eBDataType, int nPixelSpace, int nLineSpace, GDALRIOResampleAlg alg);
+	/* godalIOWindow is a window transferred by godalBandRasterIOBatch */
+	typedef struct {
+		int nDSXOff, nDSYOff, nDSXSize, nDSYSize;
+		uintptr_t pBuffer; /* address of the (go) buffer, not a pointer so the array can be passed to cgo */
+		int nBXSize, nBYSize;
+		GDALDataType eBDataType;
+		int nPixelSpace, nLineSpace;
+		char *errMessage; /* set on output */
+		int failed;		  /* set on output */
+	} godalIOWindow;
+	void godalBandRasterIOBatch(cctx *ctx, GDALRasterBandH bnd, GDALRWFlag rw, int nWindows, godalIOWindow *windows, GDALRIOResampleAlg alg, int nThreads);
+	void godalBandBlockIO(cctx *ctx, GDALRasterBandH bnd, GDALRWFlag rw, int nXBlockOff, int nYBlockOff, void *pBuffer);
+	void *godalBandLockBlock(cctx *ctx, GDALRasterBandH bnd, int nXBlockOff, int nYBlockOff, void **ppData);
+	void godalUnlockBlock(void *block, int dirty);
+	void godalBandRawTiles(cctx *ctx, GDALRasterBandH bnd, int nXBlockOff, int nYBlockOff, int nXBlocks, int nYBlocks, long long *offsets, long long *sizes);
+	void godalBandReadRawTiles(cctx *ctx, GDALRasterBandH bnd, int nTiles, unsigned long long *offsets, size_t *sizes, void *buffer);
 	void godalFillRaster(cctx *ctx, GDALRasterBandH bnd, double real, double imag);
 	void godalPolygonize(cctx *ctx, GDALRasterBandH in, GDALRasterBandH mask, OGRLayerH layer, int fieldIndex, char **opts);
+	void godalPolygonizeTiled(cctx *ctx, GDALRasterBandH in, GDALRasterBandH mask, OGRLayerH layer, int fieldIndex, char **opts,
+							  int tileX, int tileY, int nThreads);
 	void godalFillNoData(cctx *ctx, GDALRasterBandH in, GDALRasterBandH mask, int maxDistance, int iterations, char **opts);
 	void godalSieveFilter(cctx *ctx, GDALRasterBandH bnd, GDALRasterBandH mask, GDALRasterBandH dst, int sizeThreshold, int connectedNess);
+	void godalSieveFilterTiled(cctx *ctx, GDALRasterBandH bnd, GDALRasterBandH mask, GDALRasterBandH dst, int sizeThreshold, int connectedNess,
+							   int tileX, int tileY, int overlap, int nThreads);
 
 	void godalLayerFeatureCount(cctx *ctx, OGRLayerH layer, int *count);
 	void godalLayerSetFeature(cctx *ctx, OGRLayerH layer, OGRFeatureH feat);
 	OGRFeatureH godalLayerNewFeature(cctx *ctx, OGRLayerH layer, OGRGeometryH geom);
 	void godalLayerDeleteFeature(cctx *ctx, OGRLayerH layer, OGRFeatureH feat);
+	typedef struct {
+		const char *name;
+		OGRFieldType type;
+		unsigned char *nulls;		/* 1 if the field of the feature is unset or null */
+		long long *ints;			/* integers, list items, or year,month,day,hour,minute,tzflag of dates */
+		int nInts;
+		double *doubles;			/* reals, list items, or seconds of dates */
+		int nDoubles;
+		char *bytes;				/* concatenated strings and binaries */
+		long long *offsets;			/* nStrings+1 boundaries of the strings in bytes */
+		int nOffsets;
+		long long *listOffsets;		/* nFeatures+1 boundaries of the list items of each feature */
+	} godalFieldColumn;
+	typedef struct {
+		int nFeatures;
+		long long *fids;
+		unsigned char *wkb;			/* concatenated ISO WKB geometries */
+		long long *wkbOffsets;		/* nFeatures+1 boundaries of the geometries in wkb */
+		int nFields;
+		godalFieldColumn *columns;
+		void *priv;
+	} godalFeatureBatch;
+	godalFeatureBatch *godalLayerNextFeatureBatch(cctx *ctx, OGRLayerH layer, int maxFeatures);
+	void godalFreeFeatureBatch(godalFeatureBatch *batch);
+	typedef struct {
+		int field;	/* index of the layer field */
+		OGRFieldType type;
+		/* addresses of the (go) arrays laid out as in godalFieldColumn, 0 if unused. not
+		   pointers so that the columns can be passed to cgo */
+		uintptr_t nulls, ints, doubles, bytes, offsets, listOffsets;
+	} godalWriteColumn;
+	int godalLayerWriteFeatureBatch(cctx *ctx, OGRLayerH layer, int nFeatures, uintptr_t fids, uintptr_t wkb, uintptr_t wkbOffsets,
+									int nColumns, godalWriteColumn *columns, int transactionSize);
 	void godalFeatureSetGeometry(cctx *ctx, OGRFeatureH feat, OGRGeometryH geom);
 	OGRLayerH godalCreateLayer(cctx *ctx, GDALDatasetH ds, char *name, OGRSpatialReferenceH sr, OGRwkbGeometryType gtype);
-	void VSIInstallGoHandler(cctx *ctx, const char *pszPrefix, size_t bufferSize, size_t cacheSize);
+	void VSIInstallGoHandler(cctx *ctx, const char *pszPrefix, int handlerID, size_t bufferSize, size_t cacheSize, size_t mergeGap, size_t sharedCacheSize,
+							 long long statTTL, long long negStatTTL, size_t prefetch, size_t partSize, int readAhead);
+	void VSIInvalidateGoHandler(cctx *ctx, const char *pszPrefix);
+	void VSIGoHandlerStats(cctx *ctx, const char *pszPath, long long *stats);
 
 	void godalGetColorTable(GDALRasterBandH bnd, GDALPaletteInterp *interp, int *nEntries, short **entries);
 	void godalSetColorTable(cctx *ctx, GDALRasterBandH bnd, GDALPaletteInterp interp, int nEntries, short *entries);
 	void godalRasterHistogram(cctx *ctx, GDALRasterBandH bnd, double *min, double *max, int *buckets,
 						   unsigned long long **values, int bIncludeOutOfRange, int bApproxOK);
+	/* godalBandStats holds the statistics computed by godalDatasetStatistics for one band */
+	typedef struct {
+		int band;
+		double histMin, histMax;
+		int nBuckets;					/* 0 to skip the histogram */
+		uintptr_t buckets;				/* address of the (go) array of nBuckets counts */
+		unsigned long long count;		/* number of valid pixels, set on output as the following */
+		double min, max, mean, stdDev;
+	} godalBandStats;
+	void godalDatasetStatistics(cctx *ctx, GDALDatasetH ds, int nBands, godalBandStats *stats, int bIncludeOutOfRange, int nThreads);
 
 	VSILFILE *godalVSIOpen(cctx *ctx, const char *name);
 	void godalVSIUnlink(cctx *ctx, const char *name);
@@ -115,6 +238,36 @@ extern "C" {
 	void godalExportGeometryWKB(cctx *ctx, void **wkb, int *wkbLen, OGRGeometryH in);
 	void godalGeometryTransformTo(cctx *ctx, OGRGeometryH geom, OGRSpatialReferenceH sr);
 	void godalGeometryTransform(cctx *ctx, OGRGeometryH geom, OGRCoordinateTransformationH trn, OGRSpatialReferenceH dst);
+	typedef enum {
+		godalGeomTransform,
+		godalGeomSimplify,
+		godalGeomBuffer
+	} godalGeometryOpType;
+	/* godalGeometryOp is an operation applied by godalProcessGeometries */
+	typedef struct {
+		godalGeometryOpType op;
+		OGRCoordinateTransformationH trn;
+		double distance; /* simplification tolerance or buffer distance */
+		int segments;
+	} godalGeometryOp;
+	typedef enum {
+		godalEncodeWKB,
+		godalEncodeWKT,
+		godalEncodeGeoJSON
+	} godalGeometryEncoding;
+	typedef struct {
+		int nGeometries;
+		char *data;				/* concatenated encoded geometries */
+		long long *offsets;		/* nGeometries+1 boundaries of the geometries in data */
+		char **errMessages;		/* per geometry error, nullptr if it succeeded */
+		int *failed;			/* per geometry flag, set if the ErrorHandler returned an error */
+		void *priv;
+	} godalGeometryBatch;
+	/* godalProcessGeometries applies ops to each of the input geometries, taken from geoms if
+	   not nullptr or else decoded from the wkb buffer, and encodes the results */
+	godalGeometryBatch *godalProcessGeometries(cctx *ctx, int nGeometries, OGRGeometryH *geoms, uintptr_t wkb, uintptr_t wkbOffsets,
+											   int nOps, godalGeometryOp *ops, godalGeometryEncoding encoding, int precision, int nThreads);
+	void godalFreeGeometryBatch(godalGeometryBatch *batch);
 
 	GDALDatasetH godalBuildVRT(cctx *ctx, char *dstname, char **sources, char **switches);
 
@@ -16,16 +16,21 @@ package godal
 
 import (
 	"bytes"
+	"compress/zlib"
 	"context"
 	"errors"
 	"fmt"
 	"io"
 	"io/ioutil"
+	"math"
 	"os"
 	"path"
 	"path/filepath"
+	"sync"
+	"sync/atomic"
 	"syscall"
 	"testing"
+	"time"
 
 	"cloud.google.com/go/storage"
 	"github.com/airbusgeo/osio"
@@ -65,6 +70,63 @@ func tempfile() string {
 	return f.Name()
 }
 
+func TestContextReuse(t *testing.T) {
+	var wg sync.WaitGroup
+	for g := 0; g < 8; g++ {
+		wg.Add(1)
+		go func(g int) {
+			defer wg.Done()
+			fname := fmt.Sprintf("/vsimem/ctxreuse%d.tif", g)
+			for i := 0; i < 20; i++ {
+				_, err := Open(fmt.Sprintf("/vsimem/notexists%d.tif", g))
+				assert.Error(t, err)
+				ds, err := Create(GTiff, fname, 1, Byte, 16, 16, CreationOption("INVALID_OPTION=TRUE"))
+				assert.Error(t, err)
+				if err == nil {
+					_ = ds.Close()
+				}
+				ds, err = Create(GTiff, fname, 1, Byte, 16, 16, CreationOption("INVALID_OPTION=TRUE"),
+					ConfigOption("GDAL_VALIDATE_CREATION_OPTIONS=FALSE", "IGNORED_OPTION_WITHOUT_VALUE"))
+				if assert.NoError(t, err) {
+					assert.NoError(t, ds.Close())
+				}
+				ehc := eh()
+				_, err = Open(fmt.Sprintf("/vsimem/notexists%d.tif", g), ErrLogger(ehc.ErrorHandler))
+				assert.Error(t, err)
+				_ = VSIUnlink(fname)
+			}
+		}(g)
+	}
+	wg.Wait()
+}
+
+// nestingKeyReader calls into godal from inside the VSI callbacks, i.e. while another
+// godal call is running on the same thread
+type nestingKeyReader struct {
+	vpAdapter
+}
+
+func (n nestingKeyReader) VSIReader(k string) (VSIReader, error) {
+	if _, err := Open("/vsimem/nested-notexists.tif"); err == nil {
+		return nil, fmt.Errorf("nested call did not fail")
+	}
+	return n.vpAdapter.VSIReader(k)
+}
+
+func TestNestedContexts(t *testing.T) {
+	tifdat, _ := ioutil.ReadFile("testdata/test.tif")
+	vpa := vpAdapter{datas: make(map[string]VSIReader)}
+	vpa.datas["test.tif"] = bufAdapter(tifdat)
+	_ = RegisterVSIHandler("testnested://", nestingKeyReader{vpa})
+	//the errors of the nested call must not be reported by the outer one
+	ds, err := Open("testnested://test.tif")
+	if assert.NoError(t, err) {
+		ds.Close()
+	}
+	_, err = Open("testnested://notexists.tif")
+	assert.Error(t, err)
+}
+
 func TestCBuffer(t *testing.T) {
 	bbuf := make([]byte, 100)
 	sz, dt, _ := cBuffer(bbuf)
@@ -426,6 +488,135 @@ func TestHistogram(t *testing.T) {
 
 }
 
+func TestStatistics(t *testing.T) {
+	tmpname := tempfile()
+	defer os.Remove(tmpname)
+	ds, _ := Create(GTiff, tmpname, 2, Byte, 1000, 1000, CreationOption("TILED=YES", "BLOCKXSIZE=128", "BLOCKYSIZE=128"))
+	buf := make([]byte, 1000*1000)
+	for i := range buf {
+		buf[i] = byte(i % 250)
+	}
+	bands := ds.Bands()
+	_ = bands[0].Write(0, 0, buf, 1000, 1000)
+	for i := range buf {
+		buf[i] = 2
+	}
+	buf[0], buf[1] = 0, 10
+	_ = bands[1].Write(0, 0, buf, 1000, 1000)
+	_ = bands[1].SetNoData(0)
+	ds.Close()
+
+	ds, _ = Open(tmpname)
+	defer ds.Close()
+	for _, workers := range []int{1, 4} {
+		stats, err := ds.Statistics(Workers(workers))
+		assert.NoError(t, err)
+		assert.Len(t, stats, 2)
+		s := stats[0]
+		assert.Equal(t, uint64(1000000), s.Count)
+		assert.Equal(t, 0.0, s.Min)
+		assert.Equal(t, 249.0, s.Max)
+		assert.InDelta(t, 124.5, s.Mean, 1e-9)
+		assert.InDelta(t, 72.1682, s.StdDev, 1e-3)
+		assert.Equal(t, 256, s.Histogram.Len())
+		assert.Equal(t, uint64(4000), s.Histogram.Bucket(10).Count)
+		assert.Equal(t, uint64(0), s.Histogram.Bucket(250).Count)
+		assert.Equal(t, 124.0, s.Histogram.Quantile(0.5))
+		assert.Equal(t, 0.0, s.Histogram.Quantile(0))
+		assert.Equal(t, 249.0, s.Histogram.Quantile(1))
+
+		//nodata
+		s = stats[1]
+		assert.Equal(t, uint64(999999), s.Count)
+		assert.Equal(t, 2.0, s.Min)
+		assert.Equal(t, 10.0, s.Max)
+		assert.InDelta(t, 2+8.0/999999, s.Mean, 1e-9)
+		assert.Equal(t, uint64(0), s.Histogram.Bucket(0).Count)
+		assert.Equal(t, uint64(999998), s.Histogram.Bucket(2).Count)
+	}
+
+	stats, err := ds.Statistics(Bands(1), Intervals(4, 0, 8), IncludeOutOfRange())
+	assert.NoError(t, err)
+	assert.Len(t, stats, 1)
+	assert.Equal(t, 4, stats[0].Histogram.Len())
+	assert.Equal(t, uint64(999998), stats[0].Histogram.Bucket(1).Count)
+	assert.Equal(t, uint64(1), stats[0].Histogram.Bucket(3).Count)
+	stats, _ = ds.Statistics(Bands(1), Intervals(4, 0, 8))
+	assert.Equal(t, uint64(0), stats[0].Histogram.Bucket(3).Count)
+	_, err = ds.Statistics(Intervals(4, 8, 8))
+	assert.Error(t, err)
+
+	//intervals are [min,max), as for Band.Histogram: the single 10 is out of range
+	for _, opts := range [][]StatisticsOption{nil, {IncludeOutOfRange()}} {
+		stats, err = ds.Statistics(append(opts, Bands(1), Intervals(5, 0, 10))...)
+		assert.NoError(t, err)
+		var hopts []HistogramOption
+		if opts != nil {
+			hopts = append(hopts, IncludeOutOfRange())
+		}
+		hist, err := ds.Bands()[1].Histogram(append(hopts, Intervals(5, 0, 10))...)
+		assert.NoError(t, err)
+		expected := uint64(0)
+		if opts != nil {
+			expected = 1
+		}
+		assert.Equal(t, expected, stats[0].Histogram.Bucket(4).Count)
+		assert.Equal(t, hist.Bucket(4).Count, stats[0].Histogram.Bucket(4).Count)
+		assert.Equal(t, hist.Bucket(1).Count, stats[0].Histogram.Bucket(1).Count)
+	}
+
+	//unflushed writes to an update-mode dataset are taken into account
+	uds, _ := Open(tmpname, Update())
+	for i := range buf {
+		buf[i] = 5
+	}
+	_ = uds.Bands()[0].Write(0, 0, buf, 1000, 1000)
+	stats, err = uds.Statistics(Bands(0), Workers(4))
+	assert.NoError(t, err)
+	assert.Equal(t, 5.0, stats[0].Min)
+	assert.Equal(t, 5.0, stats[0].Max)
+	assert.Equal(t, uint64(1000000), stats[0].Histogram.Bucket(5).Count)
+	uds.Close()
+
+	//floats with NaNs, and a mask band
+	mds, _ := Create(Memory, "", 1, Float32, 16, 16)
+	defer mds.Close()
+	fbuf := make([]float32, 256)
+	for i := range fbuf {
+		fbuf[i] = float32(i)
+	}
+	fbuf[255] = float32(math.NaN())
+	_ = mds.Write(0, 0, fbuf, 16, 16)
+	stats, err = mds.Statistics()
+	assert.NoError(t, err)
+	assert.Equal(t, uint64(255), stats[0].Count)
+	assert.Equal(t, 254.0, stats[0].Max)
+	assert.Equal(t, 0, stats[0].Histogram.Len())
+
+	msk, _ := mds.CreateMaskBand(0x02)
+	mbuf := make([]byte, 256)
+	for i := 0; i < 128; i++ {
+		mbuf[i] = 255
+	}
+	_ = msk.Write(0, 0, mbuf, 16, 16)
+	stats, err = mds.Statistics(Intervals(2, 0, 128))
+	assert.NoError(t, err)
+	assert.Equal(t, uint64(128), stats[0].Count)
+	assert.Equal(t, 127.0, stats[0].Max)
+	assert.Equal(t, uint64(64), stats[0].Histogram.Bucket(0).Count)
+	assert.InDelta(t, 64, stats[0].Histogram.Quantile(0.5), 1e-9)
+
+	_, err = ds.Statistics(Bands(3))
+	assert.Error(t, err)
+	cds, _ := Create(Memory, "", 1, CFloat32, 16, 16)
+	defer cds.Close()
+	_, err = cds.Statistics()
+	assert.Error(t, err)
+	ehc := eh()
+	_, err = cds.Statistics(ErrLogger(ehc.ErrorHandler))
+	assert.Error(t, err)
+}
+
 func TestSize(t *testing.T) {
 	ds, _ := Open("testdata/test.tif")
 	srm, err := NewSpatialRefFromEPSG(3857)
@@ -1323,6 +1514,42 @@ func TestTransform(t *testing.T) {
 	if oks[1] {
 		t.Error("ok[1] should be false")
 	}
+
+	n := 100000
+	x, y = make([]float64, n), make([]float64, n)
+	px, py := make([]float64, n), make([]float64, n)
+	oks = make([]bool, n)
+	for i := range x {
+		x[i], y[i] = float64(i%360)-180, float64(i%170)-85
+		if i == n-10 {
+			y[i] = 91
+		}
+	}
+	copy(px, x)
+	copy(py, y)
+	err = ct.TransformEx(px, py, nil, nil)
+	assert.Error(t, err)
+	err = ct.TransformEx(x, y, nil, oks, Workers(4))
+	assert.Error(t, err)
+	for i := range x {
+		if i == n-10 {
+			assert.False(t, oks[i])
+			continue
+		}
+		assert.True(t, oks[i])
+		if x[i] != px[i] || y[i] != py[i] {
+			t.Errorf("point %d: got %f,%f, expected %f,%f", i, x[i], y[i], px[i], py[i])
+			break
+		}
+	}
+	err = ct.TransformEx([]float64{0, 1}, []float64{0, 1}, nil, nil, Workers(4))
+	assert.NoError(t, err)
+	err = ct.TransformEx(x, y[:2], nil, nil)
+	assert.Error(t, err)
+	err = ct.TransformEx(x[:2], y[:2], z[:1], nil)
+	assert.Error(t, err)
+	err = ct.TransformEx(nil, nil, nil, nil)
+	assert.NoError(t, err)
 	ct.Close()
 	assert.NotPanics(t, ct.Close, "2nd close must not panic")
 
@@ -1331,6 +1558,79 @@ func TestTransform(t *testing.T) {
 		t.Error("err not raised")
 	}
 }
+func TestSharedTransform(t *testing.T) {
+	sr1, err := CachedSpatialRefFromEPSG(4326)
+	assert.NoError(t, err)
+	sr2, err := CachedSpatialRefFromEPSG(3857)
+	assert.NoError(t, err)
+	ref, _ := NewSpatialRefFromEPSG(4326)
+	assert.True(t, sr1.IsSame(ref))
+	ref.Close()
+	//cached spatial refs are independent copies
+	sr1bis, _ := CachedSpatialRefFromEPSG(4326)
+	assert.NotEqual(t, sr1.handle, sr1bis.handle)
+	sr1bis.Close()
+	assert.True(t, sr1.Geographic())
+
+	wkt, _ := sr2.WKT()
+	srw, err := CachedSpatialRefFromWKT(wkt)
+	assert.NoError(t, err)
+	assert.True(t, srw.IsSame(sr2))
+	srw.Close()
+
+	_, err = CachedSpatialRefFromEPSG(-10)
+	assert.Error(t, err)
+	ehc := eh()
+	_, err = CachedSpatialRefFromWKT("invalid", ErrLogger(ehc.ErrorHandler))
+	assert.Error(t, err)
+
+	st, err := NewSharedTransform(sr1, sr2)
+	assert.NoError(t, err)
+	st2, _ := NewSharedTransform(sr1, sr2)
+	assert.Equal(t, st.handle, st2.handle)
+	sr1.Close()
+	sr2.Close()
+
+	wg := sync.WaitGroup{}
+	for g := 0; g < 8; g++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := 0; i < 100; i++ {
+				x := []float64{0, 1}
+				y := []float64{0, 1}
+				assert.NoError(t, st.TransformEx(x, y, nil, nil))
+				assert.Equal(t, 0.0, x[0])
+				assert.InDelta(t, 111319.49, x[1], 0.01)
+				gp, _ := NewGeometryFromWKT("POINT (1 0)", nil)
+				assert.NoError(t, st.TransformGeometry(gp))
+				gwkt, _ := gp.WKT()
+				assert.Contains(t, gwkt, "POINT (111319.49")
+				//transformed geometries do not share their srs, so it can be modified concurrently
+				gp2, _ := NewGeometryFromWKT("POINT (0 1)", nil)
+				assert.NoError(t, st.TransformGeometry(gp2))
+				assert.NotEqual(t, gp.SpatialRef().handle, gp2.SpatialRef().handle)
+				_ = gp.SpatialRef().AutoIdentifyEPSG()
+				assert.Equal(t, "3857", gp.SpatialRef().AuthorityCode(""))
+				gp2.Close()
+				gp.Close()
+			}
+		}()
+	}
+	wg.Wait()
+
+	x := []float64{0, 1}
+	y := []float64{0, 91}
+	oks := []bool{false, false}
+	assert.Error(t, st.TransformEx(x, y, nil, oks))
+	assert.Equal(t, []bool{true, false}, oks)
+
+	sr1, _ = NewSpatialRefFromEPSG(4326)
+	_, err = NewSharedTransform(sr1, &SpatialRef{handle: nil})
+	assert.Error(t, err)
+	sr1.Close()
+}
+
 func TestProjection(t *testing.T) {
 	tmpname := tempfile()
 	defer os.Remove(tmpname)
@@ -1609,6 +1909,99 @@ func TestGeometryTransform(t *testing.T) {
 	gp.Close()
 }
 
+func TestProcessGeometries(t *testing.T) {
+	sr, _ := NewSpatialRefFromEPSG(4326)
+	srm, _ := NewSpatialRefFromEPSG(3857)
+	trn, _ := NewTransform(sr, srm)
+	defer trn.Close()
+
+	geoms := make([]*Geometry, 100)
+	for i := range geoms {
+		if i == 50 {
+			continue
+		}
+		geoms[i], _ = NewGeometryFromWKT(fmt.Sprintf("POINT (%d 10)", i%90), nil)
+		defer geoms[i].Close()
+	}
+
+	b, err := ProcessGeometries(geoms, BatchTransform(trn), BatchBuffer(1000, 8), BatchSimplify(10), Workers(4))
+	assert.NoError(t, err)
+	assert.Nil(t, b.Errors)
+	assert.Equal(t, 100, b.Len())
+	assert.Nil(t, b.Geometry(50))
+	for i, g := range geoms {
+		if g == nil {
+			continue
+		}
+		ref, _ := NewGeometryFromWKT(fmt.Sprintf("POINT (%d 10)", i%90), nil)
+		_ = ref.Transform(trn)
+		buf, _ := ref.Buffer(1000, 8)
+		simp, _ := buf.Simplify(10)
+		wkb, _ := simp.WKB()
+		assert.Equal(t, wkb, b.Geometry(i))
+		ref.Close()
+		buf.Close()
+		simp.Close()
+		//input geometries are left untouched
+		wkt, _ := g.WKT()
+		assert.Equal(t, fmt.Sprintf("POINT (%d 10)", i%90), wkt)
+	}
+
+	b, err = ProcessGeometries(geoms[:2], BatchEncoding(WKTEncoding))
+	assert.NoError(t, err)
+	assert.Equal(t, "POINT (0 10)", string(b.Geometry(0)))
+	assert.Equal(t, "POINT (1 10)", string(b.Geometry(1)))
+
+	b, err = ProcessGeometries(geoms[1:2], BatchEncoding(GeoJSONEncoding), SignificantDigits(1))
+	assert.NoError(t, err)
+	assert.Equal(t, `{ "type": "Point", "coordinates": [ 1.0, 10.0 ] }`, string(b.Geometry(0)))
+
+	wkb := []byte{}
+	offsets := []int{0}
+	for _, g := range geoms[:3] {
+		gwkb, _ := g.WKB()
+		wkb = append(wkb, gwkb...)
+		offsets = append(offsets, len(wkb))
+	}
+	//empty geometry
+	offsets = append(offsets, len(wkb))
+	//invalid wkb
+	wkb = append(wkb, 1, 2, 3)
+	offsets = append(offsets, len(wkb))
+	b, err = ProcessWKB(wkb, offsets, BatchEncoding(WKTEncoding))
+	assert.Error(t, err)
+	assert.Equal(t, 5, b.Len())
+	assert.Equal(t, "POINT (2 10)", string(b.Geometry(2)))
+	assert.Nil(t, b.Geometry(3))
+	assert.Nil(t, b.Geometry(4))
+	assert.NoError(t, b.Errors[2])
+	assert.NoError(t, b.Errors[3])
+	assert.Error(t, b.Errors[4])
+
+	ehc := eh()
+	b, err = ProcessWKB(wkb, offsets, ErrLogger(ehc.ErrorHandler))
+	assert.Error(t, err)
+	assert.Error(t, b.Errors[4])
+
+	pole, _ := NewGeometryFromWKT("POINT (10 90)", nil)
+	defer pole.Close()
+	b, err = ProcessGeometries([]*Geometry{geoms[0], pole}, BatchTransform(trn))
+	assert.Error(t, err)
+	assert.NoError(t, b.Errors[0])
+	assert.Error(t, b.Errors[1])
+	assert.NotNil(t, b.Geometry(0))
+
+	_, err = ProcessWKB(wkb, []int{0, len(wkb) + 1})
+	assert.Error(t, err)
+	_, err = ProcessWKB(wkb, []int{2, 1})
+	assert.Error(t, err)
+	_, err = ProcessGeometries(geoms, BatchEncoding(GeometryEncoding(10)))
+	assert.Error(t, err)
+	b, err = ProcessGeometries(nil)
+	assert.NoError(t, err)
+	assert.Equal(t, 0, b.Len())
+}
+
 func TestProjBounds(t *testing.T) {
 	sr4326, _ := NewSpatialRefFromEPSG(4326)
 	sr3857, _ := NewSpatialRefFromEPSG(3857)
@@ -1782,6 +2175,206 @@ func TestDatasetWarpInto(t *testing.T) {
 	_ = outputDataset.Read(0, 0, data, 1, 1)
 	assert.Equal(t, uint8(155), data[0])
 }
+
+func TestWarpSetup(t *testing.T) {
+	wo := dsWarpOpts{}
+	for _, o := range []DatasetWarpOption{NumThreads(4), WarpMemory(256), WarpErrorThreshold(0.125)} {
+		o.setDatasetWarpOpt(&wo)
+	}
+	assert.Equal(t, []string{"-multi", "-wo", "NUM_THREADS=4", "-wm", "256", "-et", "0.125"}, wo.warp.switches())
+	wio := dsWarpIntoOpts{}
+	for _, o := range []DatasetWarpIntoOption{NumThreads(0), WarpErrorThreshold(0)} {
+		o.setDatasetWarpIntoOpt(&wio)
+	}
+	assert.Equal(t, []string{"-multi", "-wo", "NUM_THREADS=ALL_CPUS", "-et", "0"}, wio.warp.switches())
+	assert.Empty(t, warpSetup{}.switches())
+
+	ds, _ := Create(Memory, "", 1, Byte, 200, 200)
+	defer ds.Close()
+	sr, _ := NewSpatialRefFromEPSG(4326)
+	defer sr.Close()
+	_ = ds.SetSpatialRef(sr)
+	_ = ds.SetGeoTransform([6]float64{45, 0.01, 0, 35, 0, -0.01})
+	_ = ds.Bands()[0].Fill(42, 0)
+
+	wds, err := ds.Warp("", []string{"-t_srs", "epsg:3857"}, Memory, NumThreads(2), WarpMemory(1), WarpErrorThreshold(0))
+	assert.NoError(t, err)
+	defer wds.Close()
+	data := make([]byte, 1)
+	st := wds.Structure()
+	_ = wds.Read(st.SizeX/2, st.SizeY/2, data, 1, 1)
+	assert.Equal(t, byte(42), data[0])
+
+	_ = wds.Bands()[0].Fill(0, 0)
+	err = wds.WarpInto([]*Dataset{ds}, nil, NumThreads(-1), WarpMemory(16))
+	assert.NoError(t, err)
+	_ = wds.Read(st.SizeX/2, st.SizeY/2, data, 1, 1)
+	assert.Equal(t, byte(42), data[0])
+}
+
+func TestWarper(t *testing.T) {
+	_, err := NewWarper(nil, nil)
+	assert.Error(t, err)
+
+	ds, _ := Create(Memory, "", 2, Byte, 200, 200)
+	defer ds.Close()
+	sr, _ := NewSpatialRefFromEPSG(4326)
+	defer sr.Close()
+	_ = ds.SetSpatialRef(sr)
+	_ = ds.SetGeoTransform([6]float64{45, 0.01, 0, 35, 0, -0.01})
+	data := make([]byte, 200*200)
+	for i := range data {
+		data[i] = byte(i % 199)
+	}
+	_ = ds.Bands()[0].Write(0, 0, data, 200, 200)
+	_ = ds.Bands()[1].Fill(42, 0)
+
+	_, err = NewWarper([]*Dataset{ds}, nil, Resampling(Gauss))
+	assert.Error(t, err)
+	ds1, _ := Create(Memory, "", 1, Byte, 20, 20)
+	defer ds1.Close()
+	_ = ds1.SetSpatialRef(sr)
+	_ = ds1.SetGeoTransform([6]float64{45, 0.01, 0, 35, 0, -0.01})
+	ehc := eh()
+	_, err = NewWarper([]*Dataset{ds, ds1}, nil, ErrLogger(ehc.ErrorHandler))
+	assert.Error(t, err, "band count mismatch not raised")
+
+	mercator, _ := NewSpatialRefFromEPSG(3857)
+	defer mercator.Close()
+	w, err := NewWarper([]*Dataset{ds}, mercator, Resampling(Bilinear), NumThreads(2), WarpMemory(16))
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer w.Close()
+
+	tile, _ := Create(Memory, "", 2, Byte, 64, 64)
+	defer tile.Close()
+	bad, _ := Create(Memory, "", 1, Byte, 64, 64)
+	defer bad.Close()
+	assert.Error(t, w.WarpTile(bad, [4]float64{5050000, 3950000, 5150000, 4050000}))
+
+	//the output of the warper must be the same as the one of WarpInto
+	ref, _ := Create(Memory, "", 2, Byte, 64, 64)
+	defer ref.Close()
+	tilebuf := make([]byte, 64*64*2)
+	refbuf := make([]byte, 64*64*2)
+	for _, bounds := range [][4]float64{
+		{5050000, 3950000, 5150000, 4050000},
+		{5100000, 4000000, 5110000, 4010000},
+		{5200000, 4100000, 5300000, 4200000}, //partially outside of the source
+	} {
+		for _, bnd := range tile.Bands() {
+			_ = bnd.Fill(9, 0)
+		}
+		var last float64
+		err = w.WarpTile(tile, bounds, Progress(func(c float64, msg string) bool {
+			last = c
+			return true
+		}))
+		assert.NoError(t, err)
+		assert.Equal(t, 1.0, last)
+		gt, _ := tile.GeoTransform()
+		assert.Equal(t, bounds[0], gt[0])
+		assert.Equal(t, bounds[3], gt[3])
+		assert.InDelta(t, (bounds[2]-bounds[0])/64, gt[1], 1e-9)
+		assert.True(t, tile.SpatialRef().IsSame(mercator))
+
+		_ = ref.SetSpatialRef(mercator)
+		_ = ref.SetGeoTransform(gt)
+		for _, bnd := range ref.Bands() {
+			_ = bnd.Fill(0, 0)
+		}
+		err = ref.WarpInto([]*Dataset{ds}, []string{"-r", "bilinear"})
+		assert.NoError(t, err)
+		_ = tile.Read(0, 0, tilebuf, 64, 64)
+		_ = ref.Read(0, 0, refbuf, 64, 64)
+		assert.Equal(t, refbuf, tilebuf)
+	}
+	assert.Equal(t, byte(0), tilebuf[len(tilebuf)-1], "uncovered pixels not initialized")
+	assert.Equal(t, byte(42), tilebuf[2*63*64+1])
+
+	ctx, cancel := context.WithCancel(context.Background())
+	cancel()
+	err = w.WarpTile(tile, [4]float64{5050000, 3950000, 5150000, 4050000}, Context(ctx))
+	assert.Equal(t, context.Canceled, err)
+
+	w.Close()
+	w.Close()
+}
+
+func TestUtilitiesProgress(t *testing.T) {
+	ds, _ := Create(Memory, "", 1, Byte, 200, 200)
+	defer ds.Close()
+	sr, _ := NewSpatialRefFromEPSG(4326)
+	defer sr.Close()
+	_ = ds.SetSpatialRef(sr)
+	_ = ds.SetGeoTransform([6]float64{45, 0.01, 0, 35, 0, -0.01})
+
+	var last float64
+	progress := Progress(func(complete float64, msg string) bool {
+		last = complete
+		return true
+	})
+	interrupt := Progress(func(complete float64, msg string) bool {
+		return false
+	})
+	cancelled, cancel := context.WithCancel(context.Background())
+	cancel()
+
+	last = 0
+	tds, err := ds.Translate("", nil, Memory, progress)
+	assert.NoError(t, err)
+	assert.Equal(t, 1.0, last)
+	tds.Close()
+	_, err = ds.Translate("", nil, Memory, interrupt)
+	assert.Equal(t, ErrInterrupted, err)
+	_, err = ds.Translate("", nil, Memory, Context(cancelled))
+	assert.Equal(t, context.Canceled, err)
+
+	last = 0
+	wds, err := ds.Warp("", []string{"-ts", "100", "100"}, Memory, progress, Context(context.Background()))
+	assert.NoError(t, err)
+	assert.Equal(t, 1.0, last)
+	_, err = ds.Warp("", nil, Memory, Context(cancelled))
+	assert.Equal(t, context.Canceled, err)
+
+	err = wds.WarpInto([]*Dataset{ds}, nil, interrupt)
+	assert.Equal(t, ErrInterrupted, err)
+	ehc := eh()
+	err = wds.WarpInto([]*Dataset{ds}, nil, Context(cancelled), ErrLogger(ehc.ErrorHandler))
+	assert.Equal(t, context.Canceled, err)
+	last = 0
+	err = wds.WarpInto([]*Dataset{ds}, nil, progress)
+	assert.NoError(t, err)
+	assert.Equal(t, 1.0, last)
+	wds.Close()
+
+	inv, _ := Open("testdata/test.geojson", VectorOnly())
+	defer inv.Close()
+	last = 0
+	rds, err := inv.Rasterize("", []string{"-te", "99", "-1", "102", "2", "-ts", "9", "9", "-burn", "20"}, Memory, progress)
+	assert.NoError(t, err)
+	assert.Equal(t, 1.0, last)
+	rds.Close()
+	_, err = inv.Rasterize("", []string{"-te", "99", "-1", "102", "2", "-ts", "9", "9", "-burn", "20"}, Memory, interrupt)
+	assert.Equal(t, ErrInterrupted, err)
+
+	_, err = inv.VectorTranslate("", []string{"-of", "MEMORY"}, Context(cancelled))
+	assert.Equal(t, context.Canceled, err)
+
+	tmpname := tempfile()
+	defer os.Remove(tmpname)
+	tifds, _ := ds.Translate(tmpname, nil, GTiff)
+	tifds.Close()
+	last = 0
+	vrt, err := BuildVRT("/vsimem/progress.vrt", []string{tmpname}, nil, progress)
+	assert.NoError(t, err)
+	assert.Equal(t, 1.0, last)
+	vrt.Close()
+	_ = VSIUnlink("/vsimem/progress.vrt")
+	_, err = BuildVRT("/vsimem/progress.vrt", []string{tmpname}, nil, interrupt)
+	assert.Equal(t, ErrInterrupted, err)
+}
 func TestBuildOverviews(t *testing.T) {
 	tmpname := tempfile()
 	defer os.Remove(tmpname)
@@ -1899,6 +2492,55 @@ func TestBuildOverviews(t *testing.T) {
 	*/
 }
 
+func TestBuildOverviewsProgress(t *testing.T) {
+	tmpname := tempfile()
+	defer os.Remove(tmpname)
+	ds, err := Create(GTiff, tmpname, 1, Byte, 2000, 2000, CreationOption("TILED=YES", "BLOCKXSIZE=256", "BLOCKYSIZE=256"))
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer ds.Close()
+
+	last := -1.0
+	calls := 0
+	err = ds.BuildOverviews(NumThreads(2), Progress(func(complete float64, msg string) bool {
+		assert.GreaterOrEqual(t, complete, last)
+		last = complete
+		calls++
+		return true
+	}))
+	assert.NoError(t, err)
+	assert.Greater(t, calls, 1)
+	assert.Equal(t, 1.0, last)
+	assert.Len(t, ds.Bands()[0].Overviews(), 3)
+
+	_ = ds.ClearOverviews()
+	err = ds.BuildOverviews(Progress(func(complete float64, msg string) bool {
+		return complete < 0.5
+	}))
+	assert.Equal(t, ErrInterrupted, err)
+
+	_ = ds.ClearOverviews()
+	ehc := eh()
+	err = ds.BuildOverviews(ErrLogger(ehc.ErrorHandler), Progress(func(complete float64, msg string) bool {
+		return false
+	}))
+	assert.Equal(t, ErrInterrupted, err)
+
+	_ = ds.ClearOverviews()
+	ctx, cancel := context.WithCancel(context.Background())
+	cancel()
+	err = ds.BuildOverviews(Context(ctx))
+	assert.Equal(t, context.Canceled, err)
+
+	_ = ds.ClearOverviews()
+	ctx, cancel = context.WithTimeout(context.Background(), time.Hour)
+	defer cancel()
+	err = ds.BuildOverviews(Context(ctx), Levels(2, 4))
+	assert.NoError(t, err)
+	assert.Len(t, ds.Bands()[0].Overviews(), 2)
+}
+
 func TestResampling(t *testing.T) {
 	ds, _ := Create(Memory, "", 1, Byte, 10, 10)
 	data := make([]uint8, 100)
@@ -2084,6 +2726,94 @@ func TestPolygonize(t *testing.T) {
 	}
 }
 
+func polygonSummary(t *testing.T, l Layer) []string {
+	l.ResetReading()
+	ret := []string{}
+	for {
+		f := l.NextFeature()
+		if f == nil {
+			break
+		}
+		b, err := f.Geometry().Bounds()
+		assert.NoError(t, err)
+		ret = append(ret, fmt.Sprintf("%d:%v", f.Fields()["v"].Int(), b))
+		f.Close()
+	}
+	return ret
+}
+
+func TestPolygonizeTiled(t *testing.T) {
+	rds, _ := Create(Memory, "", 1, Byte, 41, 37)
+	defer rds.Close()
+	_ = rds.SetGeoTransform([6]float64{100, 2, 0, 200, 0, -2})
+	data := make([]byte, 41*37)
+	seed := uint32(42)
+	for i := range data {
+		seed = seed*1664525 + 1013904223
+		data[i] = byte(seed>>28) % 3
+	}
+	bnd := rds.Bands()[0]
+	_ = bnd.Write(0, 0, data, 41, 37)
+	vds, _ := CreateVector(Memory, "")
+	defer vds.Close()
+
+	//with 8-connectivity, pixels that only touch through a corner on a tile boundary are not
+	//dissolved, so the pixels around the boundaries are set to 0 for the outputs to be the same
+	data8 := make([]byte, len(data))
+	for i := range data {
+		if x, y := i%41, i/41; x%7 != 0 && x%7 != 6 && y%9 != 0 && y%9 != 8 {
+			data8[i] = data[i]
+		}
+	}
+	for _, conn := range [][]PolygonizeOption{nil, {EightConnected()}} {
+		if conn != nil {
+			_ = bnd.Write(0, 0, data8, 41, 37)
+		}
+		ref, _ := vds.CreateLayer("ref", nil, GTPolygon, NewFieldDefinition("v", FTInt))
+		err := bnd.Polygonize(ref, append(conn, PixelValueFieldIndex(0))...)
+		assert.NoError(t, err)
+		tiled, _ := vds.CreateLayer("tiled", nil, GTPolygon, NewFieldDefinition("v", FTInt))
+		calls := 0
+		err = bnd.Polygonize(tiled, append(conn, PixelValueFieldIndex(0), TileSize(7, 9), Workers(3),
+			Progress(func(complete float64, msg string) bool {
+				calls++
+				return true
+			}))...)
+		assert.NoError(t, err)
+		assert.Greater(t, calls, 0)
+		assert.ElementsMatch(t, polygonSummary(t, ref), polygonSummary(t, tiled))
+	}
+
+	//two pixels touching through a corner on a tile boundary: separate 8-connected polygons
+	corner := make([]byte, 41*37)
+	corner[8*41+6] = 1
+	corner[9*41+7] = 1
+	_ = bnd.Write(0, 0, corner, 41, 37)
+	tiled, _ := vds.CreateLayer("corner", nil, GTPolygon, NewFieldDefinition("v", FTInt))
+	err := bnd.Polygonize(tiled, EightConnected(), PixelValueFieldIndex(0), TileSize(7, 9))
+	assert.NoError(t, err)
+	ones := 0
+	tiled.ResetReading()
+	for f := tiled.NextFeature(); f != nil; f = tiled.NextFeature() {
+		wkt, _ := f.Geometry().WKT()
+		assert.NotContains(t, wkt, "MULTI")
+		if f.Fields()["v"].Int() == 1 {
+			ones++
+		}
+		f.Close()
+	}
+	assert.Equal(t, 2, ones)
+
+	cancelled, _ := vds.CreateLayer("cancelled", nil, GTPolygon)
+	err = bnd.Polygonize(cancelled, TileSize(7, 9), Progress(func(complete float64, msg string) bool {
+		return false
+	}))
+	assert.Equal(t, ErrInterrupted, err)
+
+	err = bnd.Polygonize(cancelled, TileSize(7, 9), PixelValueFieldIndex(5))
+	assert.Error(t, err)
+}
+
 func TestFillNoData(t *testing.T) {
 	ds, _ := Create(Memory, "", 1, Byte, 1000, 1000)
 	mskds, _ := Create(Memory, "", 1, Byte, 1000, 1000)
@@ -2280,6 +3010,100 @@ func TestRasterizeGeometries(t *testing.T) {
 
 }
 
+func TestRasterizeGeometriesBatch(t *testing.T) {
+	geoms := []*Geometry{}
+	values := []float64{}
+	for i := 0; i < 200; i++ {
+		x, y := float64((i*37)%280), float64((i*53)%240)
+		w, h := float64(5+i%17), float64(3+i%23)
+		g, err := NewGeometryFromWKT(fmt.Sprintf("POLYGON((%g %g,%g %g,%g %g,%g %g,%g %g))",
+			x, y, x+w, y, x+w, y+h, x, y+h, x, y), nil)
+		assert.NoError(t, err)
+		geoms = append(geoms, g)
+		values = append(values, float64(1+i%250))
+	}
+	geoms = append(geoms, nil)
+	values = append(values, 255)
+	defer func() {
+		for _, g := range geoms[:len(geoms)-1] {
+			g.Close()
+		}
+	}()
+
+	newds := func() *Dataset {
+		ds, _ := Create(Memory, "", 2, Byte, 301, 257)
+		_ = ds.SetGeoTransform([6]float64{-7, 1.1, 0, 255, 0, -1})
+		return ds
+	}
+	ref := newds()
+	defer ref.Close()
+	for i, g := range geoms[:len(geoms)-1] {
+		err := ref.RasterizeGeometry(g, AllTouched(), Values(values[i]))
+		assert.NoError(t, err)
+	}
+	expected := make([]byte, 301*257*2)
+	_ = ref.Read(0, 0, expected, 301, 257)
+
+	//per band values, then a single value on the second band only
+	pbv := make([]float64, 0, 2*len(values))
+	for _, v := range values {
+		pbv = append(pbv, 255-v, v)
+	}
+	for i, g := range geoms[:len(geoms)-1] {
+		err := ref.RasterizeGeometry(g, Values(255-values[i], values[i]))
+		assert.NoError(t, err)
+	}
+	expectedPbv := make([]byte, 301*257*2)
+	_ = ref.Read(0, 0, expectedPbv, 301, 257)
+	for i, g := range geoms[:len(geoms)-1] {
+		err := ref.RasterizeGeometry(g, Bands(2), Values(values[i]))
+		assert.NoError(t, err)
+	}
+	expectedBand := make([]byte, 301*257*2)
+	_ = ref.Read(0, 0, expectedBand, 301, 257)
+
+	for _, workers := range []int{1, 4} {
+		ds := newds()
+		calls := 0
+		err := ds.RasterizeGeometries(geoms, values, AllTouched(), Workers(workers),
+			Progress(func(complete float64, msg string) bool {
+				calls++
+				return true
+			}))
+		assert.NoError(t, err)
+		assert.Greater(t, calls, 0)
+		got := make([]byte, 301*257*2)
+		_ = ds.Read(0, 0, got, 301, 257)
+		assert.Equal(t, expected, got)
+
+		err = ds.RasterizeGeometries(geoms, pbv, Workers(workers))
+		assert.NoError(t, err)
+		_ = ds.Read(0, 0, got, 301, 257)
+		assert.Equal(t, expectedPbv, got)
+		err = ds.RasterizeGeometries(geoms, values, Bands(2), Workers(workers))
+		assert.NoError(t, err)
+		_ = ds.Read(0, 0, got, 301, 257)
+		assert.Equal(t, expectedBand, got)
+		ds.Close()
+	}
+
+	ds := newds()
+	defer ds.Close()
+	err := ds.RasterizeGeometries(geoms, values[1:])
+	assert.Error(t, err)
+	err = ds.RasterizeGeometries(geoms, values, Bands(3), Workers(2))
+	assert.Error(t, err)
+	ehc := eh()
+	err = ds.RasterizeGeometries(geoms, values, Bands(3), ErrLogger(ehc.ErrorHandler))
+	assert.Error(t, err)
+	err = ds.RasterizeGeometries(geoms, values, Workers(4), Progress(func(complete float64, msg string) bool {
+		return false
+	}))
+	assert.Equal(t, ErrInterrupted, err)
+	err = ds.RasterizeGeometries(nil, nil)
+	assert.NoError(t, err)
+}
+
 func TestVectorTranslate(t *testing.T) {
 	tmpname := tempfile()
 	defer os.Remove(tmpname)
@@ -2444,26 +3268,134 @@ func TestVectorLayer(t *testing.T) {
 	}
 }
 
-func TestLayerModifyFeatures(t *testing.T) {
-	ds, _ := Open("testdata/test.geojson") //read-only
+func TestWriteFeatureBatch(t *testing.T) {
+	ds, _ := CreateVector(Memory, "")
 	defer ds.Close()
-	l := ds.Layers()[0]
-	for {
-		ff := l.NextFeature()
-		if ff == nil {
-			break
-		}
-		err := l.DeleteFeature(ff)
-		assert.Error(t, err) //read-only, must fail
-		ehc := eh()
-		err = l.DeleteFeature(ff, ErrLogger(ehc.ErrorHandler))
-		assert.Error(t, err) //read-only, must fail
-		err = l.UpdateFeature(ff)
-		assert.Error(t, err) //read-only, must fail
-		ehc = eh()
-		err = l.UpdateFeature(ff, ErrLogger(ehc.ErrorHandler))
-		assert.Error(t, err) //read-only, must fail
-	}
+	lyr, err := ds.CreateLayer("l1", nil, GTPoint,
+		NewFieldDefinition("str", FTString),
+		NewFieldDefinition("int", FTInt64),
+		NewFieldDefinition("real", FTReal),
+		NewFieldDefinition("dt", FTDateTime),
+		NewFieldDefinition("ints", FTIntList),
+		NewFieldDefinition("strs", FTStringList),
+	)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	pnt, _ := NewGeometryFromWKT("POINT (1 2)", nil)
+	wkb, _ := pnt.WKB()
+	pnt.Close()
+	dt := time.Date(2021, 2, 3, 4, 5, 6, 0, time.UTC)
+	b := &FeatureBatch{
+		FIDs:            []int64{-1, -1, -1},
+		Geometries:      append(append([]byte{}, wkb...), wkb...),
+		GeometryOffsets: []int{0, len(wkb), len(wkb), 2 * len(wkb)},
+		Columns: []FieldColumn{
+			{Name: "str", Type: FTString, Bytes: []byte("foobarbaz"), Offsets: []int{0, 3, 6, 9}},
+			{Name: "int", Type: FTInt64, Ints: []int64{1, 0, 3}, Nulls: []bool{false, true, false}},
+			{Name: "real", Type: FTReal, Floats: []float64{0.5, 1.5, 2.5}},
+			{Name: "dt", Type: FTDateTime, Times: []time.Time{dt, dt.Add(time.Hour), dt.Add(2 * time.Hour)}},
+			{Name: "ints", Type: FTIntList, Ints: []int64{1, 2, 3}, ListOffsets: []int{0, 2, 2, 3}},
+			{Name: "strs", Type: FTStringList, Bytes: []byte("abc"), Offsets: []int{0, 1, 2, 3}, ListOffsets: []int{0, 1, 1, 3}},
+		},
+	}
+	n, err := lyr.WriteFeatureBatch(b)
+	assert.NoError(t, err)
+	assert.Equal(t, 3, n)
+
+	lyr.ResetReading()
+	rb, err := lyr.NextFeatureBatch(10)
+	assert.NoError(t, err)
+	assert.Equal(t, 3, rb.Len())
+	assert.Equal(t, b.GeometryOffsets, rb.GeometryOffsets)
+	assert.Equal(t, b.Geometries, rb.Geometries)
+	assert.Equal(t, "bar", rb.Column("str").String(1))
+	assert.Equal(t, []bool{false, true, false}, rb.Column("int").Nulls)
+	assert.Equal(t, b.Columns[2].Floats, rb.Column("real").Floats)
+	assert.True(t, dt.Add(time.Hour).Equal(rb.Column("dt").Times[1]))
+	assert.Equal(t, []int{0, 2, 2, 3}, rb.Column("ints").ListOffsets)
+	assert.Equal(t, []string{"b", "c"}, rb.Column("strs").StringList(2))
+
+	//write back what has been read
+	rb.FIDs = []int64{-1, -1, -1}
+	n, err = lyr.WriteFeatureBatch(rb, TransactionSize(0))
+	assert.NoError(t, err)
+	assert.Equal(t, 3, n)
+	c, _ := lyr.FeatureCount()
+	assert.Equal(t, 6, c)
+
+	n, err = lyr.WriteFeatureBatch(&FeatureBatch{})
+	assert.NoError(t, err)
+	assert.Equal(t, 0, n)
+	_, err = lyr.WriteFeatureBatch(&FeatureBatch{FIDs: []int64{-1}, Columns: []FieldColumn{{Name: "bogus", Type: FTInt, Ints: []int64{1}}}})
+	assert.Error(t, err)
+	_, err = lyr.WriteFeatureBatch(&FeatureBatch{FIDs: []int64{-1}, Columns: []FieldColumn{{Name: "int", Type: FTInt}}})
+	assert.Error(t, err)
+	_, err = lyr.WriteFeatureBatch(&FeatureBatch{FIDs: []int64{-1}, Columns: []FieldColumn{{Name: "str", Type: FTString, Bytes: []byte("a"), Offsets: []int{0, 2}}}})
+	assert.Error(t, err)
+	_, err = lyr.WriteFeatureBatch(&FeatureBatch{FIDs: []int64{-1, -1}, GeometryOffsets: []int{0, 1}})
+	assert.Error(t, err)
+	ehc := eh()
+	_, err = lyr.WriteFeatureBatch(&FeatureBatch{FIDs: []int64{-1}, Geometries: []byte{1, 2, 3}, GeometryOffsets: []int{0, 3}},
+		ErrLogger(ehc.ErrorHandler))
+	assert.Error(t, err, "invalid wkb not detected")
+
+	tmpdir, _ := ioutil.TempDir("", "")
+	defer os.RemoveAll(tmpdir)
+	gds, err := CreateVector(GeoPackage, filepath.Join(tmpdir, "test.gpkg"))
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer gds.Close()
+	glyr, err := gds.CreateLayer("l1", nil, GTPoint, NewFieldDefinition("int", FTInt64))
+	if err != nil {
+		t.Fatal(err)
+	}
+	gb := &FeatureBatch{
+		FIDs:    []int64{1, 2, 3, 3, 5},
+		Columns: []FieldColumn{{Name: "int", Type: FTInt64, Ints: []int64{1, 2, 3, 4, 5}}},
+	}
+	ehc = eh()
+	n, err = glyr.WriteFeatureBatch(gb, TransactionSize(2), ErrLogger(ehc.ErrorHandler))
+	assert.Error(t, err)
+	assert.Equal(t, 2, n)
+	c, _ = glyr.FeatureCount()
+	assert.Equal(t, 2, c, "failed transaction not rolled back")
+	gb.FIDs = []int64{-1, -1, -1, -1, -1}
+	n, err = glyr.WriteFeatureBatch(gb, TransactionSize(2))
+	assert.NoError(t, err)
+	assert.Equal(t, 5, n)
+	c, _ = glyr.FeatureCount()
+	assert.Equal(t, 7, c)
+
+	//NewFeature creates the feature in the layer
+	_, err = glyr.NewFeature(nil)
+	assert.NoError(t, err)
+	c, _ = glyr.FeatureCount()
+	assert.Equal(t, 8, c)
+}
+
+func TestLayerModifyFeatures(t *testing.T) {
+	ds, _ := Open("testdata/test.geojson") //read-only
+	defer ds.Close()
+	l := ds.Layers()[0]
+	for {
+		ff := l.NextFeature()
+		if ff == nil {
+			break
+		}
+		err := l.DeleteFeature(ff)
+		assert.Error(t, err) //read-only, must fail
+		ehc := eh()
+		err = l.DeleteFeature(ff, ErrLogger(ehc.ErrorHandler))
+		assert.Error(t, err) //read-only, must fail
+		err = l.UpdateFeature(ff)
+		assert.Error(t, err) //read-only, must fail
+		ehc = eh()
+		err = l.UpdateFeature(ff, ErrLogger(ehc.ErrorHandler))
+		assert.Error(t, err) //read-only, must fail
+	}
 	dsm, _ := ds.VectorTranslate("", []string{"-of", "Memory"})
 	defer dsm.Close()
 	l = dsm.Layers()[0]
@@ -2686,6 +3618,93 @@ func TestFeatureAttributes(t *testing.T) {
 	}
 }
 
+func TestFeatureBatch(t *testing.T) {
+	glayers := `{
+	"type": "FeatureCollection",
+	"features": [
+		{ "type": "Feature", "id": 1,
+			"properties": { "str": "foo", "int": 3, "real": 1.5, "date": "2021-02-03", "dt": "2021-02-03T04:05:06.5Z",
+				"ints": [1, 2], "reals": [0.5], "strs": ["a", "bc"] },
+			"geometry": { "type": "Point", "coordinates": [1, 2] } },
+		{ "type": "Feature", "id": 2,
+			"properties": { "str": "barbaz", "int": null, "real": 2.5, "date": null, "dt": "2021-02-03T04:05:06+02:00",
+				"ints": [], "reals": [1.5, 2.5], "strs": ["d"] },
+			"geometry": null },
+		{ "type": "Feature", "id": 3,
+			"properties": { "str": "", "int": 5, "real": 3.5, "date": "2022-12-31", "dt": null,
+				"ints": [4], "reals": null, "strs": [] },
+			"geometry": { "type": "Point", "coordinates": [3, 4] } }
+	]
+}`
+	ds, err := Open(glayers, VectorOnly())
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer ds.Close()
+	lyr := ds.Layers()[0]
+
+	_, err = lyr.NextFeatureBatch(0)
+	assert.Error(t, err)
+
+	b, err := lyr.NextFeatureBatch(2)
+	assert.NoError(t, err)
+	assert.Equal(t, 2, b.Len())
+	assert.Equal(t, []int64{1, 2}, b.FIDs)
+	g, _ := NewGeometryFromWKB(b.Geometry(0), nil)
+	wkt, _ := g.WKT()
+	assert.Equal(t, "POINT (1 2)", wkt)
+	g.Close()
+	assert.Nil(t, b.Geometry(1))
+	assert.Nil(t, b.Column("bogus"))
+
+	col := b.Column("str")
+	assert.Equal(t, FTString, col.Type)
+	assert.Equal(t, "foo", col.String(0))
+	assert.Equal(t, "barbaz", col.String(1))
+	col = b.Column("int")
+	assert.Equal(t, []bool{false, true}, col.Nulls)
+	assert.Equal(t, []int64{3, 0}, col.Ints)
+	assert.Equal(t, []float64{1.5, 2.5}, b.Column("real").Floats)
+	col = b.Column("date")
+	assert.Equal(t, FTDate, col.Type)
+	assert.True(t, col.Nulls[1])
+	assert.Equal(t, "2021-02-03", col.Times[0].Format("2006-01-02"))
+	col = b.Column("dt")
+	assert.Equal(t, FTDateTime, col.Type)
+	assert.True(t, col.Times[0].Equal(time.Date(2021, 2, 3, 4, 5, 6, 5e8, time.UTC)))
+	assert.True(t, col.Times[1].Equal(time.Date(2021, 2, 3, 2, 5, 6, 0, time.UTC)))
+	col = b.Column("ints")
+	assert.Equal(t, FTIntList, col.Type)
+	assert.Equal(t, []int64{1, 2}, col.Ints[col.ListOffsets[0]:col.ListOffsets[1]])
+	assert.Empty(t, col.Ints[col.ListOffsets[1]:col.ListOffsets[2]])
+	col = b.Column("reals")
+	assert.Equal(t, []float64{1.5, 2.5}, col.Floats[col.ListOffsets[1]:col.ListOffsets[2]])
+	col = b.Column("strs")
+	assert.Equal(t, FTStringList, col.Type)
+	assert.Equal(t, []string{"a", "bc"}, col.StringList(0))
+	assert.Equal(t, []string{"d"}, col.StringList(1))
+
+	b, err = lyr.NextFeatureBatch(2)
+	assert.NoError(t, err)
+	assert.Equal(t, 1, b.Len())
+	assert.Equal(t, "", b.Column("str").String(0))
+	assert.True(t, b.Column("dt").Nulls[0])
+	assert.True(t, b.Column("dt").Times[0].IsZero())
+	assert.Empty(t, b.Column("strs").StringList(0))
+	assert.NotNil(t, b.Geometry(0))
+
+	b, err = lyr.NextFeatureBatch(2)
+	assert.NoError(t, err)
+	assert.Nil(t, b)
+
+	lyr.ResetReading()
+	ehc := eh()
+	b, err = lyr.NextFeatureBatch(10, ErrLogger(ehc.ErrorHandler))
+	assert.NoError(t, err)
+	assert.Equal(t, 3, b.Len())
+	assert.Len(t, b.GeometryOffsets, 4)
+}
+
 func TestVSIFile(t *testing.T) {
 	fname := "/vsimem/dsakfljhsafdjkl.tif"
 	tmpfile := tempfile()
@@ -2946,6 +3965,924 @@ func TestVSIErrors(t *testing.T) {
 
 }
 
+type rangeCountingAdapter struct {
+	mbufAdapter
+	nranges *[]int
+}
+
+func (rc rangeCountingAdapter) ReadAtMulti(bufs [][]byte, offs []int64) ([]int, error) {
+	*rc.nranges = append(*rc.nranges, len(bufs))
+	return rc.mbufAdapter.ReadAtMulti(bufs, offs)
+}
+
+func TestVSIMergeGap(t *testing.T) {
+	tt := tempfile()
+	defer os.Remove(tt)
+	ds, _ := Create(GTiff, tt, 1, Byte, 2048, 2048, CreationOption("TILED=YES", "COMPRESS=LZW", "BLOCKXSIZE=128", "BLOCKYSIZE=128"))
+	data := make([]byte, 2048*2048)
+	for i := range data {
+		data[i] = byte(i % 251)
+	}
+	_ = ds.Write(0, 0, data, 2048, 2048)
+	ds.Close()
+
+	ds, _ = Open(tt)
+	expected := make([]byte, 128*128)
+	_ = ds.Read(64, 64, expected, 128, 128)
+	ds.Close()
+
+	tifdat, _ := ioutil.ReadFile(tt)
+	nogap, gap := []int{}, []int{}
+	vpa := vpAdapter{datas: make(map[string]VSIReader)}
+	vpa.datas["nogap.tif"] = rangeCountingAdapter{mbufAdapter{tifdat}, &nogap}
+	vpa.datas["gap.tif"] = rangeCountingAdapter{mbufAdapter{tifdat}, &gap}
+	assert.Error(t, RegisterVSIHandler("testmerge://", vpa, VSIHandlerMergeGap(-1)))
+	_ = RegisterVSIHandler("testmerge://", vpa, VSIHandlerBufferSize(0), VSIHandlerMergeGap(64*1024))
+	_ = RegisterVSIHandler("testnomerge://", vpa, VSIHandlerBufferSize(0))
+
+	read := make([]byte, 128*128)
+	ds, err := Open("testnomerge://nogap.tif")
+	assert.NoError(t, err)
+	err = ds.Read(64, 64, read, 128, 128)
+	assert.NoError(t, err)
+	assert.Equal(t, expected, read)
+	ds.Close()
+
+	read = make([]byte, 128*128)
+	ds, err = Open("testmerge://gap.tif")
+	assert.NoError(t, err)
+	err = ds.Read(64, 64, read, 128, 128)
+	assert.NoError(t, err)
+	assert.Equal(t, expected, read)
+	ds.Close()
+
+	//the window spans 2 rows of 2 tiles: each pair of tiles is contiguous, the two
+	//rows are separated by the 14 remaining tiles of the first row
+	if assert.Len(t, nogap, 1) && assert.Len(t, gap, 1) {
+		assert.Equal(t, 2, nogap[0])
+		assert.Equal(t, 1, gap[0])
+	}
+}
+
+func TestVSISharedCache(t *testing.T) {
+	tt := tempfile()
+	defer os.Remove(tt)
+	ds, _ := Create(GTiff, tt, 1, Byte, 1024, 1024, CreationOption("TILED=YES", "COMPRESS=LZW", "BLOCKXSIZE=128", "BLOCKYSIZE=128"))
+	data := make([]byte, 1024*1024)
+	for i := range data {
+		data[i] = byte(i % 251)
+	}
+	_ = ds.Write(0, 0, data, 1024, 1024)
+	ds.Close()
+
+	ds, _ = Open(tt)
+	expected := make([]byte, 128*128)
+	_ = ds.Read(64, 64, expected, 128, 128)
+	ds.Close()
+
+	tifdat, _ := ioutil.ReadFile(tt)
+	calls := []int{}
+	vpa := vpAdapter{datas: make(map[string]VSIReader)}
+	vpa.datas["test.tif"] = rangeCountingAdapter{mbufAdapter{tifdat}, &calls}
+	_ = RegisterVSIHandler("testshared://", vpa, VSIHandlerBufferSize(4096), VSIHandlerSharedCacheSize(len(tifdat)+4096))
+
+	for i := 0; i < 2; i++ {
+		read := make([]byte, 128*128)
+		ds, err := Open("testshared://test.tif")
+		assert.NoError(t, err)
+		err = ds.Read(64, 64, read, 128, 128)
+		assert.NoError(t, err)
+		assert.Equal(t, expected, read)
+		ds.Close()
+		if i == 0 {
+			assert.NotEmpty(t, calls)
+			calls = calls[:0]
+		}
+	}
+	//everything must have been served from the cache on the second open
+	assert.Empty(t, calls)
+
+	vf, err := VSIOpen("testshared://test.tif")
+	assert.NoError(t, err)
+	all, err := ioutil.ReadAll(vf)
+	assert.NoError(t, err)
+	assert.Equal(t, tifdat, all)
+	_ = vf.Close()
+}
+
+type sizeCountingAdapter struct {
+	bufAdapter
+	n *int
+}
+
+func (sc sizeCountingAdapter) Size() int64 {
+	*sc.n++
+	return sc.bufAdapter.Size()
+}
+
+type sizeCountingKeyReader struct {
+	vpAdapter
+	n *int
+}
+
+func (sk sizeCountingKeyReader) VSIReader(k string) (VSIReader, error) {
+	r, err := sk.vpAdapter.VSIReader(k)
+	if err != nil {
+		*sk.n++
+	}
+	return r, err
+}
+
+func TestVSIStatCache(t *testing.T) {
+	tifdat, _ := ioutil.ReadFile("testdata/test.tif")
+	sizes, misses := 0, 0
+	vpa := vpAdapter{datas: make(map[string]VSIReader)}
+	vpa.datas["test.tif"] = sizeCountingAdapter{bufAdapter(tifdat), &sizes}
+	err := RegisterVSIHandler("teststat://", sizeCountingKeyReader{vpa, &misses},
+		VSIHandlerSharedCacheSize(1<<20), VSIHandlerStatCache(time.Minute, time.Minute))
+	assert.NoError(t, err)
+
+	for i := 0; i < 3; i++ {
+		ds, err := Open("teststat://test.tif")
+		assert.NoError(t, err)
+		ds.Close()
+	}
+	assert.Equal(t, 1, sizes)
+
+	_, err = Open("teststat://noent.tif")
+	assert.Error(t, err)
+	m := misses
+	assert.NotZero(t, m)
+	vpa.datas["noent.tif"] = bufAdapter(tifdat)
+	_, err = Open("teststat://noent.tif")
+	assert.Error(t, err)
+	assert.Equal(t, m, misses)
+
+	err = VSIInvalidate("teststat://noent")
+	assert.NoError(t, err)
+	ds, err := Open("teststat://noent.tif")
+	assert.NoError(t, err)
+	ds.Close()
+
+	err = VSIInvalidate("teststat://")
+	assert.NoError(t, err)
+	ds, _ = Open("teststat://test.tif")
+	ds.Close()
+	assert.Equal(t, 2, sizes)
+
+	err = VSIInvalidate("/vsimem/test.tif")
+	assert.Error(t, err)
+	ehc := eh()
+	_ = VSIInvalidate("/vsimem/test.tif", ErrLogger(ehc.ErrorHandler))
+	assert.NotZero(t, ehc.errs)
+}
+
+type readCountingAdapter struct {
+	bufAdapter
+	n *int
+}
+
+func (rc readCountingAdapter) ReadAt(buf []byte, off int64) (int, error) {
+	*rc.n++
+	return rc.bufAdapter.ReadAt(buf, off)
+}
+
+func TestVSIPrefetch(t *testing.T) {
+	tifdat, _ := ioutil.ReadFile("testdata/test.tif")
+	reads, sreads := 0, 0
+	vpa := vpAdapter{datas: make(map[string]VSIReader)}
+	vpa.datas["test.tif"] = readCountingAdapter{bufAdapter(tifdat), &reads}
+	vpa.datas["stest.tif"] = readCountingAdapter{bufAdapter(tifdat), &sreads}
+	assert.Error(t, RegisterVSIHandler("testprefetch://", vpa, VSIHandlerPrefetch(1<<28)))
+	assert.Error(t, RegisterVSIHandler("testprefetch://", vpa, VSIHandlerPrefetch(-1)))
+	_ = RegisterVSIHandler("testprefetch://", vpa, VSIHandlerPrefetch(16*1024))
+	_ = RegisterVSIHandler("testsprefetch://", vpa, VSIHandlerPrefetch(16*1024),
+		VSIHandlerBufferSize(1024), VSIHandlerSharedCacheSize(64*1024))
+
+	data := make([]byte, 300)
+	ds, err := Open("testprefetch://test.tif")
+	assert.NoError(t, err)
+	assert.NoError(t, ds.Read(0, 0, data, 10, 10))
+	ds.Close()
+	//test.tif is smaller than the prefetched size
+	assert.Equal(t, 1, reads)
+
+	sdata := make([]byte, 300)
+	ds, err = Open("testsprefetch://stest.tif")
+	assert.NoError(t, err)
+	assert.NoError(t, ds.Read(0, 0, sdata, 10, 10))
+	ds.Close()
+	assert.Equal(t, 1, sreads)
+	assert.Equal(t, data, sdata)
+
+	_, err = Open("testprefetch://noent.tif")
+	assert.Error(t, err)
+}
+
+type extentsAdapter struct {
+	readCountingAdapter
+	extents []VSIExtent
+}
+
+func (ea extentsAdapter) Extents() ([]VSIExtent, error) {
+	if ea.extents == nil {
+		return nil, fmt.Errorf("extents not available")
+	}
+	return ea.extents, nil
+}
+
+func TestVSIExtents(t *testing.T) {
+	buf := make([]byte, 1000)
+	for i := range buf {
+		buf[i] = 1
+	}
+	reads := 0
+	vpa := vpAdapter{datas: make(map[string]VSIReader)}
+	vpa.datas["sparse"] = extentsAdapter{readCountingAdapter{bufAdapter(buf), &reads}, []VSIExtent{{Offset: 0, Length: 100}, {Offset: 800, Length: 100}}}
+	vpa.datas["noextents"] = extentsAdapter{readCountingAdapter{bufAdapter(buf), &reads}, nil}
+	_ = RegisterVSIHandler("testsparse://", vpa, VSIHandlerBufferSize(0))
+
+	vf, err := VSIOpen("testsparse://sparse")
+	assert.NoError(t, err)
+	for i, expected := range []byte{1, 0, 0, 0, 1} {
+		chunk := make([]byte, 100)
+		_, err = vf.Read(chunk)
+		assert.NoError(t, err)
+		assert.Equal(t, bytes.Repeat([]byte{expected}, 100), chunk, "chunk %d", i)
+		if i == 3 {
+			chunk = make([]byte, 400)
+			_, _ = vf.Read(chunk)
+		}
+	}
+	_ = vf.Close()
+	//only the 2 chunks containing data must have been read
+	assert.Equal(t, 2, reads)
+
+	reads = 0
+	vf, err = VSIOpen("testsparse://noextents")
+	assert.NoError(t, err)
+	all, err := ioutil.ReadAll(vf)
+	assert.NoError(t, err)
+	assert.Equal(t, buf, all)
+	_ = vf.Close()
+}
+
+type vpWriterAdapter struct {
+	vpAdapter
+	parts *int
+}
+
+type memWriter struct {
+	vpWriterAdapter
+	key string
+	buf bytes.Buffer
+}
+
+func (vw vpWriterAdapter) VSIWriter(k string) (io.WriteCloser, error) {
+	return &memWriter{vpWriterAdapter: vw, key: k}, nil
+}
+func (mw *memWriter) Write(buf []byte) (int, error) {
+	*mw.parts++
+	return mw.buf.Write(buf)
+}
+func (mw *memWriter) Close() error {
+	mw.datas[mw.key] = bufAdapter(mw.buf.Bytes())
+	return nil
+}
+
+func TestVSIWrite(t *testing.T) {
+	parts := 0
+	vpa := vpAdapter{datas: make(map[string]VSIReader)}
+	assert.Error(t, RegisterVSIHandler("testwrite://", vpWriterAdapter{vpa, &parts}, VSIHandlerWritePartSize(1<<28)))
+	_ = RegisterVSIHandler("testwrite://", vpWriterAdapter{vpa, &parts}, VSIHandlerWritePartSize(100))
+	_ = RegisterVSIHandler("testnowrite://", vpa)
+
+	ds, _ := Open("testdata/test.geojson", VectorOnly())
+	defer ds.Close()
+	nf, _ := ds.Layers()[0].FeatureCount()
+
+	wds, err := ds.VectorTranslate("testwrite://out.geojson", []string{"-f", "GeoJSON"})
+	assert.NoError(t, err)
+	wds.Close()
+	assert.Greater(t, parts, 1)
+	if assert.Contains(t, vpa.datas, "out.geojson") {
+		assert.Greater(t, len(vpa.datas["out.geojson"].(bufAdapter)), (parts-1)*100)
+	}
+
+	rds, err := Open("testwrite://out.geojson", VectorOnly())
+	assert.NoError(t, err)
+	rnf, _ := rds.Layers()[0].FeatureCount()
+	assert.Equal(t, nf, rnf)
+	rds.Close()
+
+	_, err = ds.VectorTranslate("testnowrite://out.geojson", []string{"-f", "GeoJSON"})
+	assert.Error(t, err)
+}
+
+func TestVSIReadAhead(t *testing.T) {
+	buf := make([]byte, 1024*1024+17)
+	for i := range buf {
+		buf[i] = byte(i % 253)
+	}
+	tifdat, _ := ioutil.ReadFile("testdata/test.tif")
+	vpa := vpAdapter{datas: make(map[string]VSIReader)}
+	vpa.datas["seq"] = bufAdapter(buf)
+	vpa.datas["test.tif"] = bufAdapter(tifdat)
+	vpa.datas["err"] = bodyreadErroringAdapter{bufAdapter(buf)}
+	_ = RegisterVSIHandler("testreadahead://", vpa, VSIHandlerBufferSize(4096), VSIHandlerReadAhead(8))
+	_ = RegisterVSIHandler("testreadahead0://", vpa, VSIHandlerBufferSize(0), VSIHandlerReadAhead(3))
+
+	for _, prefix := range []string{"testreadahead://", "testreadahead0://"} {
+		vf, err := VSIOpen(prefix + "seq")
+		assert.NoError(t, err)
+		all, err := ioutil.ReadAll(vf)
+		assert.NoError(t, err)
+		assert.Equal(t, buf, all)
+		_ = vf.Close()
+
+		vf, _ = VSIOpen(prefix + "err")
+		_, err = ioutil.ReadAll(vf)
+		assert.EqualError(t, err, "read >414 not implemented")
+		_ = vf.Close()
+
+		ds, err := Open(prefix + "test.tif")
+		assert.NoError(t, err)
+		data := make([]byte, 300)
+		assert.NoError(t, ds.Read(0, 0, data, 10, 10))
+		ds.Close()
+	}
+}
+
+func TestVSIStats(t *testing.T) {
+	tifdat, _ := ioutil.ReadFile("testdata/test.tif")
+	vpa := vpAdapter{datas: make(map[string]VSIReader)}
+	vpa.datas["test.tif"] = bufAdapter(tifdat)
+	var (
+		mu     sync.Mutex
+		traces []VSITrace
+	)
+	trace := func(tr VSITrace) {
+		mu.Lock()
+		traces = append(traces, tr)
+		mu.Unlock()
+	}
+	_ = RegisterVSIHandler("teststats://", vpa, VSIHandlerTrace(trace))
+	_ = RegisterVSIHandler("testsstats://", vpa, VSIHandlerSharedCacheSize(1024*1024))
+
+	st, err := VSIStats("teststats://")
+	assert.NoError(t, err)
+	assert.Equal(t, VSIHandlerStats{}, st)
+
+	ds, err := Open("teststats://test.tif")
+	assert.NoError(t, err)
+	data := make([]byte, 100)
+	assert.NoError(t, ds.Read(0, 0, data, 10, 10))
+	ds.Close()
+
+	st, err = VSIStats("teststats://")
+	assert.NoError(t, err)
+	assert.Equal(t, int64(1), st.Opens)
+	assert.NotZero(t, st.Reads+st.MultiReads)
+	assert.NotZero(t, st.GoReads)
+	assert.Zero(t, st.Errors)
+	nlat := int64(0)
+	for _, l := range st.Latency {
+		nlat += l
+	}
+	assert.Equal(t, st.GoReads, nlat)
+	fst, err := VSIStats("teststats://test.tif")
+	assert.NoError(t, err)
+	assert.Equal(t, st.Opens, fst.Opens)
+	assert.Equal(t, st.GoBytes, fst.GoBytes)
+
+	mu.Lock()
+	assert.Equal(t, int(st.GoReads), len(traces))
+	for _, tr := range traces {
+		assert.Equal(t, "test.tif", tr.Key)
+		assert.Equal(t, len(tr.Offsets), len(tr.Lengths))
+		assert.NoError(t, tr.Err)
+	}
+	mu.Unlock()
+
+	fst, err = VSIStats("teststats://notopened.tif")
+	assert.NoError(t, err)
+	assert.Equal(t, VSIHandlerStats{}, fst)
+
+	for i := 0; i < 2; i++ {
+		ds, err = Open("testsstats://test.tif")
+		assert.NoError(t, err)
+		assert.NoError(t, ds.Read(0, 0, data, 10, 10))
+		ds.Close()
+	}
+	st, _ = VSIStats("testsstats://")
+	assert.Equal(t, int64(2), st.Opens)
+	assert.NotZero(t, st.CacheMisses)
+	assert.NotZero(t, st.CacheHits)
+
+	ehc := eh()
+	_, err = VSIStats("/vsimem/", ErrLogger(ehc.ErrorHandler))
+	assert.Error(t, err)
+}
+
+// concurrencyAdapter records the maximum number of concurrent ReadAt calls
+type concurrencyAdapter struct {
+	bufAdapter
+	cur, max *int64
+}
+
+func (c concurrencyAdapter) ReadAt(buf []byte, off int64) (int, error) {
+	n := atomic.AddInt64(c.cur, 1)
+	defer atomic.AddInt64(c.cur, -1)
+	for {
+		m := atomic.LoadInt64(c.max)
+		if n <= m || atomic.CompareAndSwapInt64(c.max, m, n) {
+			break
+		}
+	}
+	time.Sleep(time.Millisecond)
+	return c.bufAdapter.ReadAt(buf, off)
+}
+
+// stallingAdapter stalls the first ReadAt issued at each offset for a long time
+type stallingAdapter struct {
+	bufAdapter
+	mu   *sync.Mutex
+	seen map[int64]bool
+}
+
+func (s stallingAdapter) ReadAt(buf []byte, off int64) (int, error) {
+	s.mu.Lock()
+	stall := !s.seen[off]
+	s.seen[off] = true
+	s.mu.Unlock()
+	if stall {
+		time.Sleep(5 * time.Second)
+	}
+	return s.bufAdapter.ReadAt(buf, off)
+}
+
+func TestVSIConcurrencyAndHedging(t *testing.T) {
+	tt := tempfile()
+	defer os.Remove(tt)
+	ds, _ := Create(GTiff, tt, 1, Byte, 1024, 1024, CreationOption("TILED=YES", "BLOCKXSIZE=128", "BLOCKYSIZE=128"))
+	data := make([]byte, 1024*1024)
+	for i := range data {
+		data[i] = byte(i % 251)
+	}
+	_ = ds.Write(0, 0, data, 1024, 1024)
+	ds.Close()
+	tifdat, _ := ioutil.ReadFile(tt)
+
+	var cur, max int64
+	vpa := vpAdapter{datas: make(map[string]VSIReader)}
+	vpa.datas["limited.tif"] = concurrencyAdapter{bufAdapter(tifdat), &cur, &max}
+	vpa.datas["stalling.tif"] = stallingAdapter{bufAdapter(tifdat), &sync.Mutex{}, make(map[int64]bool)}
+	_ = RegisterVSIHandler("testlimit://", vpa, VSIHandlerBufferSize(0), VSIHandlerMaxConcurrency(2))
+	_ = RegisterVSIHandler("testhedge://", vpa, VSIHandlerBufferSize(0), VSIHandlerHedgedReads(50*time.Millisecond))
+
+	ds, err := Open("testlimit://limited.tif")
+	assert.NoError(t, err)
+	read := make([]byte, 1024*1024)
+	assert.NoError(t, ds.Read(0, 0, read, 1024, 1024))
+	assert.Equal(t, data, read)
+	ds.Close()
+	assert.LessOrEqual(t, max, int64(2))
+	assert.Greater(t, max, int64(0))
+
+	start := time.Now()
+	ds, err = Open("testhedge://stalling.tif")
+	assert.NoError(t, err)
+	read = make([]byte, 1024*1024)
+	assert.NoError(t, ds.Read(0, 0, read, 1024, 1024))
+	assert.Equal(t, data, read)
+	ds.Close()
+	assert.Less(t, int64(time.Since(start)), int64(4*time.Second))
+}
+
+func TestBandIOBatch(t *testing.T) {
+	tt := tempfile()
+	defer os.Remove(tt)
+	ds, _ := Create(GTiff, tt, 1, Byte, 512, 512, CreationOption("TILED=YES", "BLOCKXSIZE=64", "BLOCKYSIZE=64"))
+	data := make([]byte, 512*512)
+	for i := range data {
+		data[i] = byte(i % 251)
+	}
+	bnd := ds.Bands()[0]
+	windows := []BandIOWindow{}
+	for y := 0; y < 512; y += 128 {
+		for x := 0; x < 512; x += 128 {
+			windows = append(windows, BandIOWindow{X: x, Y: y, Buffer: data[y*512+x:], BufWidth: 128, BufHeight: 128})
+		}
+	}
+	assert.NoError(t, bnd.WriteBatch(windows, LineSpacing(512)))
+	ds.Close()
+
+	ds, _ = Open(tt)
+	defer ds.Close()
+	bnd = ds.Bands()[0]
+	for _, opts := range [][]BandIOOption{nil, {IOThreads(4)}} {
+		windows := []BandIOWindow{}
+		//reverse order, the batch is sorted internally
+		for y := 512 - 64; y >= 0; y -= 64 {
+			for x := 512 - 64; x >= 0; x -= 64 {
+				windows = append(windows, BandIOWindow{X: x, Y: y, Buffer: make([]byte, 64*64), BufWidth: 64, BufHeight: 64})
+			}
+		}
+		windows = append(windows, BandIOWindow{X: 0, Y: 0, Width: 512, Height: 512,
+			Buffer: make([]uint16, 32*32), BufWidth: 32, BufHeight: 32})
+		assert.NoError(t, bnd.ReadBatch(windows, opts...))
+		for _, w := range windows[:len(windows)-1] {
+			expected := make([]byte, 64*64)
+			_ = bnd.Read(w.X, w.Y, expected, 64, 64)
+			assert.Equal(t, expected, w.Buffer)
+			assert.NoError(t, w.Err)
+		}
+		expected := make([]uint16, 32*32)
+		_ = bnd.Read(0, 0, expected, 32, 32, Window(512, 512))
+		assert.Equal(t, expected, windows[len(windows)-1].Buffer)
+	}
+
+	windows = []BandIOWindow{
+		{X: 0, Y: 0, Buffer: make([]byte, 16), BufWidth: 4, BufHeight: 4},
+		{X: 510, Y: 510, Buffer: make([]byte, 16), BufWidth: 4, BufHeight: 4},
+	}
+	err := bnd.ReadBatch(windows, IOThreads(2))
+	assert.Error(t, err)
+	assert.NoError(t, windows[0].Err)
+	assert.Error(t, windows[1].Err)
+
+	ehc := eh()
+	err = bnd.ReadBatch(windows, ErrLogger(ehc.ErrorHandler))
+	assert.Error(t, err)
+	assert.NoError(t, windows[0].Err)
+	assert.Error(t, windows[1].Err)
+
+	//MEM datasets cannot be reopened and are read sequentially
+	mds, _ := Create(Memory, "", 1, Byte, 64, 64)
+	defer mds.Close()
+	_ = mds.Bands()[0].Fill(7, 0)
+	windows = []BandIOWindow{
+		{X: 0, Y: 0, Buffer: make([]byte, 16), BufWidth: 4, BufHeight: 4},
+		{X: 32, Y: 32, Buffer: make([]byte, 16), BufWidth: 4, BufHeight: 4},
+	}
+	assert.NoError(t, mds.Bands()[0].ReadBatch(windows, IOThreads(2)))
+	assert.Equal(t, byte(7), windows[1].Buffer.([]byte)[15])
+	assert.NoError(t, mds.Bands()[0].ReadBatch(nil))
+
+	//unflushed writes to an update-mode dataset are seen by parallel reads
+	ut := tempfile()
+	defer os.Remove(ut)
+	uds, _ := Create(GTiff, ut, 1, Byte, 256, 256, CreationOption("TILED=YES", "BLOCKXSIZE=64", "BLOCKYSIZE=64"))
+	ubnd := uds.Bands()[0]
+	_ = ubnd.Fill(3, 0)
+	uds.Close()
+	uds, _ = Open(ut, Update())
+	defer uds.Close()
+	ubnd = uds.Bands()[0]
+	_ = ubnd.Fill(9, 0)
+	windows = []BandIOWindow{}
+	for y := 0; y < 256; y += 64 {
+		for x := 0; x < 256; x += 64 {
+			windows = append(windows, BandIOWindow{X: x, Y: y, Buffer: make([]byte, 64*64), BufWidth: 64, BufHeight: 64})
+		}
+	}
+	assert.NoError(t, ubnd.ReadBatch(windows, IOThreads(4)))
+	for _, w := range windows {
+		assert.Equal(t, byte(9), w.Buffer.([]byte)[0])
+		assert.Equal(t, byte(9), w.Buffer.([]byte)[64*64-1])
+	}
+}
+
+func TestBlockIO(t *testing.T) {
+	tt := tempfile()
+	defer os.Remove(tt)
+	ds, _ := Create(GTiff, tt, 1, UInt16, 100, 100, CreationOption("TILED=YES", "BLOCKXSIZE=64", "BLOCKYSIZE=64"))
+	bnd := ds.Bands()[0]
+	block := make([]uint16, 64*64)
+	for i := range block {
+		block[i] = uint16(i)
+	}
+	assert.NoError(t, bnd.WriteBlock(1, 1, block))
+	assert.Error(t, bnd.WriteBlock(1, 1, make([]byte, 64*64*2)))
+	assert.Error(t, bnd.WriteBlock(1, 1, make([]uint16, 64*63)))
+	ds.Close()
+
+	ds, _ = Open(tt)
+	defer ds.Close()
+	bnd = ds.Bands()[0]
+	read := make([]uint16, 64*64)
+	assert.NoError(t, bnd.ReadBlock(1, 1, read))
+	//only the pixels inside the band are defined
+	expected := make([]uint16, 36*36)
+	_ = bnd.Read(64, 64, expected, 36, 36)
+	for y := 0; y < 36; y++ {
+		assert.Equal(t, expected[y*36:y*36+36], read[y*64:y*64+36])
+		assert.Equal(t, block[y*64:y*64+36], read[y*64:y*64+36])
+	}
+	ehc := eh()
+	assert.Error(t, bnd.ReadBlock(5, 5, read, ErrLogger(ehc.ErrorHandler)))
+
+	lb, err := bnd.LockBlock(1, 1)
+	assert.NoError(t, err)
+	data := lb.Data()
+	assert.Len(t, data, 64*64*2)
+	assert.Equal(t, uint16(65), uint16(data[65*2])|uint16(data[65*2+1])<<8) //little endian
+	lb.Release()
+	lb.Release()
+	assert.Nil(t, lb.Data())
+
+	_, err = bnd.LockBlock(5, 5)
+	assert.Error(t, err)
+
+	mds, _ := Create(Memory, "", 1, Byte, 16, 16)
+	defer mds.Close()
+	mbnd := mds.Bands()[0]
+	lb, err = mbnd.LockBlock(0, 3)
+	assert.NoError(t, err)
+	lb.Data()[0] = 42
+	lb.MarkDirty()
+	lb.Release()
+	px := make([]byte, 1)
+	_ = mbnd.Read(0, 3, px, 1, 1)
+	assert.Equal(t, byte(42), px[0])
+}
+
+func TestRawTiles(t *testing.T) {
+	tt := tempfile()
+	defer os.Remove(tt)
+	ds, _ := Create(GTiff, tt, 1, Byte, 128, 128, CreationOption("TILED=YES", "BLOCKXSIZE=64", "BLOCKYSIZE=64",
+		"COMPRESS=DEFLATE", "SPARSE_OK=TRUE"))
+	block := make([]byte, 64*64)
+	for i := range block {
+		block[i] = byte(i % 7)
+	}
+	_ = ds.Bands()[0].WriteBlock(1, 0, block)
+	ds.Close()
+
+	ds, _ = Open(tt)
+	defer ds.Close()
+	assert.Equal(t, "DEFLATE", ds.Metadata("COMPRESSION", Domain("IMAGE_STRUCTURE")))
+	bnd := ds.Bands()[0]
+	tiles, err := bnd.RawTiles(0, 0, 2, 2)
+	assert.NoError(t, err)
+	if assert.Len(t, tiles, 4) {
+		assert.Equal(t, 1, tiles[1].X)
+		assert.Equal(t, 0, tiles[1].Y)
+		assert.Equal(t, 1, tiles[3].Y)
+		assert.NotZero(t, tiles[1].Size)
+		assert.Zero(t, tiles[0].Size)
+		assert.Zero(t, tiles[3].Offset)
+	}
+	raw, err := bnd.ReadRawTiles(tiles)
+	assert.NoError(t, err)
+	assert.Nil(t, raw[0])
+	zr, err := zlib.NewReader(bytes.NewReader(raw[1]))
+	if assert.NoError(t, err) {
+		data, _ := ioutil.ReadAll(zr)
+		assert.Equal(t, block, data)
+	}
+	raw, err = bnd.ReadRawTiles(tiles[:1])
+	assert.NoError(t, err)
+	assert.Equal(t, [][]byte{nil}, raw)
+
+	_, err = bnd.ReadRawTiles([]RawTile{{Offset: 1 << 40, Size: 10}})
+	assert.Error(t, err)
+
+	mds, _ := Create(Memory, "", 1, Byte, 16, 16)
+	defer mds.Close()
+	ehc := eh()
+	_, err = mds.Bands()[0].RawTiles(0, 0, 1, 1, ErrLogger(ehc.ErrorHandler))
+	assert.Error(t, err)
+}
+
+func TestProcessTiles(t *testing.T) {
+	tt := tempfile()
+	defer os.Remove(tt)
+	ds, _ := Create(GTiff, tt, 2, UInt16, 300, 200, CreationOption("TILED=YES", "BLOCKXSIZE=64", "BLOCKYSIZE=64"))
+	data := make([]uint16, 300*200*2)
+	for i := range data {
+		data[i] = uint16(i)
+	}
+	_ = ds.Write(0, 0, data, 300, 200)
+	ds.Close()
+
+	ds, _ = Open(tt)
+	defer ds.Close()
+	dst, _ := Create(Memory, "", 2, UInt16, 300, 200)
+	defer dst.Close()
+	var ntiles int64
+	err := ds.ProcessTiles(func(tile Tile) error {
+		atomic.AddInt64(&ntiles, 1)
+		buf := tile.Buffer.([]uint16)
+		if len(buf) != tile.W*tile.H*2 {
+			return fmt.Errorf("wrong buffer size")
+		}
+		for i := range buf {
+			buf[i] = ^buf[i]
+		}
+		return nil
+	}, Workers(3), TileSize(128, 64), MaxTilesInFlight(4), ProcessInto(dst))
+	assert.NoError(t, err)
+	assert.Equal(t, int64(3*4), ntiles)
+	read := make([]uint16, 300*200*2)
+	_ = dst.Read(0, 0, read, 300, 200)
+	for i := range read {
+		if read[i] != ^data[i] {
+			assert.Equal(t, ^data[i], read[i], "pixel %d", i)
+			break
+		}
+	}
+
+	err = ds.ProcessTiles(func(tile Tile) error {
+		if tile.X0 > 0 {
+			return fmt.Errorf("tile %d,%d", tile.X0, tile.Y0)
+		}
+		return nil
+	})
+	assert.Error(t, err)
+
+	assert.Error(t, ds.ProcessTiles(func(Tile) error { return nil }, TileSize(100, 64)))
+
+	//MEM datasets cannot be reopened and are read sequentially
+	ntiles = 0
+	err = dst.ProcessTiles(func(tile Tile) error {
+		atomic.AddInt64(&ntiles, 1)
+		return nil
+	}, Workers(4))
+	assert.NoError(t, err)
+	assert.Equal(t, int64(200), ntiles)
+
+	small, _ := Create(Memory, "", 2, UInt16, 100, 200)
+	defer small.Close()
+	err = ds.ProcessTiles(func(Tile) error { return nil }, ProcessInto(small))
+	assert.Error(t, err)
+
+	//in place on an update-mode dataset, whose unflushed writes must be seen
+	ds.Close()
+	ds, _ = Open(tt, Update())
+	_ = ds.Write(0, 0, data, 300, 200)
+	err = ds.ProcessTiles(func(tile Tile) error {
+		buf := tile.Buffer.([]uint16)
+		for i := range buf {
+			buf[i]++
+		}
+		return nil
+	}, Workers(4), ProcessInto(ds))
+	assert.NoError(t, err)
+	_ = ds.Read(0, 0, read, 300, 200)
+	for i := range read {
+		if read[i] != data[i]+1 {
+			assert.Equal(t, data[i]+1, read[i], "pixel %d", i)
+			break
+		}
+	}
+	_ = ds.Close()
+}
+
+func TestBufferPool(t *testing.T) {
+	ds, _ := Create(Memory, "", 3, Float32, 64, 64)
+	defer ds.Close()
+	_ = ds.Bands()[1].Fill(5, 0)
+	for _, pool := range []*BufferPool{NewBufferPool(), NewBufferPool(CMemory(), MaxIdle(1))} {
+		buf, err := pool.Get(Float32, 64, 64, 3)
+		assert.NoError(t, err)
+		if assert.Len(t, buf.Data, 64*64*3) {
+			assert.NoError(t, ds.Read(0, 0, buf.Data, 64, 64))
+			assert.Equal(t, float32(5), buf.Data.([]float32)[1])
+		}
+		bbuf, _ := pool.Get(Byte, 16, 16, 1)
+		assert.NoError(t, ds.Bands()[1].Read(0, 0, bbuf.Data, 16, 16))
+		assert.Equal(t, byte(5), bbuf.Data.([]byte)[255])
+		pool.Put(buf)
+		pool.Put(bbuf)
+		pool.Put(nil)
+
+		buf2, _ := pool.Get(Float32, 128, 32, 3)
+		assert.Len(t, buf2.Data, 128*32*3)
+		assert.Equal(t, 128, buf2.Width)
+		buf3, _ := pool.Get(Float32, 64, 64, 3)
+		pool.Put(buf2)
+		pool.Put(buf3)
+		for _, dt := range []DataType{Int16, UInt16, Int32, UInt32, Float64, CInt16, CFloat32, CInt32, CFloat64} {
+			b, err := pool.Get(dt, 2, 2, 1)
+			assert.NoError(t, err)
+			assert.NoError(t, ds.Bands()[1].Read(0, 0, b.Data, 2, 2))
+			pool.Put(b)
+		}
+		_, err = pool.Get(Unknown, 2, 2, 1)
+		assert.Error(t, err)
+		_, err = pool.Get(Byte, -2, 2, 1)
+		assert.Error(t, err)
+
+		//buffers of at most maxBufferKeys sizes are kept
+		for i := 1; i <= 2*maxBufferKeys; i++ {
+			b, _ := pool.Get(Byte, i, 1, 1)
+			pool.Put(b)
+		}
+		pool.mu.Lock()
+		assert.LessOrEqual(t, len(pool.pools), maxBufferKeys)
+		assert.LessOrEqual(t, len(pool.idle), maxBufferKeys)
+		pool.mu.Unlock()
+
+		pool.Close()
+		b, _ := pool.Get(Byte, 1, 1, 1)
+		pool.Put(b)
+	}
+	_, err := NewBufferPool(CMemory()).Get(Byte, maxCBufferPixels+1, 1, 1)
+	assert.Error(t, err)
+}
+
+func TestDatasetPool(t *testing.T) {
+	pool := NewDatasetPool(MaxIdle(2), MaxOpen(3))
+	ds1, err := pool.Get("testdata/test.tif")
+	assert.NoError(t, err)
+	h1 := ds1.handle()
+	ds2, err := pool.Get("testdata/test.tif")
+	assert.NoError(t, err)
+	assert.NotEqual(t, h1, ds2.handle())
+	assert.Equal(t, 10, ds1.Structure().SizeX)
+	_, err = pool.Get("testdata/doesnotexist.tif")
+	assert.Error(t, err)
+	assert.NoError(t, ds1.Close())
+	assert.Error(t, ds1.Close())
+
+	//idle dataset is reused
+	ds3, err := pool.Get("testdata/test.tif")
+	assert.NoError(t, err)
+	assert.Equal(t, h1, ds3.handle())
+	//different options are pooled separately
+	ds4, err := pool.Get("testdata/test.tif", Drivers("GTiff"))
+	assert.NoError(t, err)
+	assert.NotEqual(t, h1, ds4.handle())
+	_, err = pool.Get("testdata/test.tif", Update())
+	assert.Error(t, err)
+
+	//MaxOpen reached: wait for a dataset to be returned, then evict it
+	got := make(chan *Dataset)
+	go func() {
+		ds, err := pool.Get("testdata/test.geojson")
+		assert.NoError(t, err)
+		got <- ds
+	}()
+	for {
+		pool.mu.Lock()
+		waiting := pool.waiting
+		pool.mu.Unlock()
+		if waiting == 1 {
+			break
+		}
+		time.Sleep(time.Millisecond)
+	}
+	select {
+	case <-got:
+		t.Error("MaxOpen not enforced")
+	default:
+	}
+	_ = ds4.Close()
+	ds5 := <-got
+	assert.Len(t, ds5.Layers(), 1)
+	_ = ds5.Close()
+
+	//MaxIdle
+	_ = ds2.Close()
+	_ = ds3.Close()
+	pool.mu.Lock()
+	assert.Equal(t, 2, pool.lru.Len())
+	assert.Equal(t, 2, pool.open)
+	pool.mu.Unlock()
+
+	ds6, _ := pool.Get("testdata/test.tif")
+	pool.Close()
+	pool.mu.Lock()
+	assert.Equal(t, 1, pool.open)
+	pool.mu.Unlock()
+	_, err = pool.Get("testdata/test.tif")
+	assert.Error(t, err)
+	assert.NoError(t, ds6.Close())
+	assert.Equal(t, 0, pool.open)
+
+	var wg sync.WaitGroup
+	pool = NewDatasetPool(MaxOpen(4))
+	defer pool.Close()
+	for i := 0; i < 16; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for j := 0; j < 20; j++ {
+				ds, err := pool.Get("testdata/test.tif")
+				if !assert.NoError(t, err) {
+					return
+				}
+				buf := make([]byte, 100)
+				assert.NoError(t, ds.Bands()[0].Read(0, 0, buf, 10, 10))
+				_ = ds.Close()
+			}
+		}()
+	}
+	wg.Wait()
+	assert.LessOrEqual(t, pool.open, 4)
+}
+
 func TestBuildVRT(t *testing.T) {
 	ds, err := BuildVRT("/vsimem/vrt1.vrt", []string{"testdata/test.tif"}, nil)
 	assert.NoError(t, err)
@@ -3302,3 +5239,329 @@ func TestSieveFilter(t *testing.T) {
 	assert.Error(t, err)
 	assert.Equal(t, 1, ehc.errs)
 }
+
+func TestSieveFilterTiled(t *testing.T) {
+	const sx, sy = 53, 47
+	src, _ := Create(Memory, "", 2, Byte, sx, sy)
+	defer src.Close()
+	//blobs of 1 to 9 pixels on a background, so that sieved pixels have a single
+	//candidate neighbour whatever the tiling
+	data := make([]byte, sx*sy)
+	for i := range data {
+		data[i] = 2
+	}
+	seed := uint32(7)
+	rnd := func(n uint32) int {
+		seed = seed*1664525 + 1013904223
+		return int((seed >> 16) % n)
+	}
+	for b := 0; b < 150; b++ {
+		x, y, w, h := rnd(sx-3), rnd(sy-3), 1+rnd(3), 1+rnd(3)
+		for r := y; r < y+h; r++ {
+			for c := x; c < x+w; c++ {
+				data[r*sx+c] = 1
+			}
+		}
+	}
+	_ = src.Bands()[0].Write(0, 0, data, sx, sy)
+	ref := src.Bands()[1]
+	err := src.Bands()[0].SieveFilter(4, Destination(ref))
+	assert.NoError(t, err)
+	expected := make([]byte, sx*sy)
+	_ = ref.Read(0, 0, expected, sx, sy)
+
+	for _, dst := range []int{0, 1} {
+		ds, _ := Create(Memory, "", 2, Byte, sx, sy)
+		bnd := ds.Bands()[0]
+		_ = bnd.Write(0, 0, data, sx, sy)
+		err = bnd.SieveFilter(4, Destination(ds.Bands()[dst]), TileSize(8, 5), Workers(4))
+		assert.NoError(t, err)
+		got := make([]byte, sx*sy)
+		_ = ds.Bands()[dst].Read(0, 0, got, sx, sy)
+		assert.Equal(t, expected, got)
+		ds.Close()
+	}
+
+	cancelled, cancel := context.WithCancel(context.Background())
+	cancel()
+	err = src.Bands()[0].SieveFilter(4, TileSize(8, 5), Context(cancelled))
+	assert.Equal(t, context.Canceled, err)
+}
+
+func TestInstrumentation(t *testing.T) {
+	ResetInstrumentation()
+	EnableInstrumentation(true)
+	ds, err := Open("testdata/test.tif")
+	assert.NoError(t, err)
+	_, err = Open("testdata/doesnotexist.tif")
+	assert.Error(t, err)
+	_, err = ds.Statistics(Workers(2))
+	assert.NoError(t, err)
+	ds.Close()
+	EnableInstrumentation(false)
+	ds, _ = Open("testdata/test.tif")
+	ds.Close()
+
+	stats := Instrumentation()
+	found := false
+	for _, st := range stats {
+		if st.Function == "godalOpen" {
+			found = true
+			assert.Equal(t, int64(2), st.Calls)
+			assert.Greater(t, int64(st.GDAL), int64(0))
+		}
+		//worker threads are accounted to their entry point
+		assert.NotEqual(t, "operator()", st.Function)
+	}
+	assert.True(t, found)
+	ResetInstrumentation()
+	assert.Empty(t, Instrumentation())
+}
+
+func benchmarkRaster(b *testing.B, name string, nBands int, dt DataType, size, blockSize int) *Dataset {
+	ds, err := Create(GTiff, name, nBands, dt, size, size, CreationOption("TILED=YES",
+		fmt.Sprintf("BLOCKXSIZE=%d", blockSize), fmt.Sprintf("BLOCKYSIZE=%d", blockSize)))
+	if err != nil {
+		b.Fatal(err)
+	}
+	_ = ds.SetGeoTransform([6]float64{0, 1, 0, float64(size), 0, -1})
+	for i, bnd := range ds.Bands() {
+		_ = bnd.Fill(float64(i+1), 0)
+	}
+	return ds
+}
+
+func BenchmarkBandIO(b *testing.B) {
+	for _, dt := range []DataType{Byte, UInt16, Float32, Float64} {
+		for _, bs := range []int{64, 256, 512} {
+			b.Run(fmt.Sprintf("%s/%d", dt, bs), func(b *testing.B) {
+				ds := benchmarkRaster(b, "/vsimem/benchio.tif", 1, dt, 1024, bs)
+				defer func() { _ = VSIUnlink("/vsimem/benchio.tif") }()
+				defer ds.Close()
+				bnd := ds.Bands()[0]
+				buf, _ := newBuffer(dt, bs*bs)
+				nb := 1024 / bs
+				b.SetBytes(int64(bs * bs * dt.Size()))
+				b.ResetTimer()
+				for i := 0; i < b.N; i++ {
+					x, y := (i%nb)*bs, ((i/nb)%nb)*bs
+					if err := bnd.Read(x, y, buf, bs, bs); err != nil {
+						b.Fatal(err)
+					}
+				}
+			})
+		}
+	}
+}
+
+func BenchmarkDatasetIO(b *testing.B) {
+	ds := benchmarkRaster(b, "/vsimem/benchdsio.tif", 3, Byte, 1024, 256)
+	defer func() { _ = VSIUnlink("/vsimem/benchdsio.tif") }()
+	defer ds.Close()
+	buf := make([]byte, 256*256*3)
+	b.SetBytes(int64(len(buf)))
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		x, y := (i%4)*256, ((i/4)%4)*256
+		if err := ds.Read(x, y, buf, 256, 256); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
+
+func BenchmarkNextFeature(b *testing.B) {
+	gj := &bytes.Buffer{}
+	gj.WriteString(`{"type":"FeatureCollection","features":[`)
+	for i := 0; i < 1000; i++ {
+		if i > 0 {
+			gj.WriteString(",")
+		}
+		fmt.Fprintf(gj, `{"type":"Feature","properties":{"id":%d,"name":"feature %d","value":%g},`+
+			`"geometry":{"type":"Point","coordinates":[%d,%d]}}`, i, i, float64(i)/3, i%180, i%90)
+	}
+	gj.WriteString("]}")
+	fname := tempfile() + ".geojson"
+	if err := ioutil.WriteFile(fname, gj.Bytes(), 0644); err != nil {
+		b.Fatal(err)
+	}
+	defer os.Remove(fname)
+	ds, err := Open(fname, VectorOnly())
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer ds.Close()
+	layer := ds.Layers()[0]
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		layer.ResetReading()
+		for {
+			f := layer.NextFeature()
+			if f == nil {
+				break
+			}
+			_ = f.Fields()
+			f.Close()
+		}
+	}
+}
+
+func BenchmarkGeometryWKB(b *testing.B) {
+	wkt := &bytes.Buffer{}
+	wkt.WriteString("POLYGON((")
+	for i := 0; i <= 256; i++ {
+		a := 2 * math.Pi * float64(i%256) / 256
+		if i > 0 {
+			wkt.WriteString(",")
+		}
+		fmt.Fprintf(wkt, "%f %f", math.Cos(a), math.Sin(a))
+	}
+	wkt.WriteString("))")
+	g, err := NewGeometryFromWKT(wkt.String(), nil)
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer g.Close()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		wkb, err := g.WKB()
+		if err != nil {
+			b.Fatal(err)
+		}
+		g2, err := NewGeometryFromWKB(wkb, nil)
+		if err != nil {
+			b.Fatal(err)
+		}
+		g2.Close()
+	}
+}
+
+func BenchmarkTransformEx(b *testing.B) {
+	src, _ := NewSpatialRefFromEPSG(4326)
+	defer src.Close()
+	dst, _ := NewSpatialRefFromEPSG(3857)
+	defer dst.Close()
+	trn, err := NewTransform(src, dst)
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer trn.Close()
+	const n = 4096
+	x, y := make([]float64, n), make([]float64, n)
+	for _, workers := range []int{1, 4} {
+		b.Run(fmt.Sprintf("workers=%d", workers), func(b *testing.B) {
+			b.ResetTimer()
+			for i := 0; i < b.N; i++ {
+				b.StopTimer()
+				for p := range x {
+					x[p], y[p] = float64(p%90), float64(p%45)
+				}
+				b.StartTimer()
+				if err := trn.TransformEx(x, y, nil, nil, Workers(workers)); err != nil {
+					b.Fatal(err)
+				}
+			}
+		})
+	}
+}
+
+func BenchmarkWarp(b *testing.B) {
+	src := benchmarkRaster(b, "/vsimem/benchwarpsrc.tif", 1, Byte, 1024, 256)
+	defer func() { _ = VSIUnlink("/vsimem/benchwarpsrc.tif") }()
+	defer src.Close()
+	sr, _ := NewSpatialRefFromEPSG(3857)
+	defer sr.Close()
+	_ = src.SetSpatialRef(sr)
+	b.Run("Warp", func(b *testing.B) {
+		for i := 0; i < b.N; i++ {
+			ds, err := src.Warp("", []string{"-te", "128", "128", "384", "384", "-ts", "256", "256"}, Memory)
+			if err != nil {
+				b.Fatal(err)
+			}
+			ds.Close()
+		}
+	})
+	b.Run("WarpInto", func(b *testing.B) {
+		dst, _ := Create(Memory, "", 1, Byte, 256, 256)
+		defer dst.Close()
+		_ = dst.SetGeoTransform([6]float64{128, 1, 0, 384, 0, -1})
+		_ = dst.SetSpatialRef(sr)
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			if err := dst.WarpInto([]*Dataset{src}, nil); err != nil {
+				b.Fatal(err)
+			}
+		}
+	})
+}
+
+// latencyReader simulates the latency of a remote object store
+type latencyReader struct {
+	mbufAdapter
+	latency time.Duration
+}
+
+func (lr latencyReader) ReadAt(buf []byte, off int64) (int, error) {
+	time.Sleep(lr.latency)
+	return lr.mbufAdapter.ReadAt(buf, off)
+}
+func (lr latencyReader) ReadAtMulti(bufs [][]byte, offs []int64) ([]int, error) {
+	time.Sleep(lr.latency)
+	return lr.mbufAdapter.ReadAtMulti(bufs, offs)
+}
+
+// handlers cannot be unregistered, so the benchmark handler is registered once for all the
+// runs of BenchmarkVSIHandler (e.g. with -count)
+var benchVSIHandlerOnce sync.Once
+var benchVSIHandlerErr error
+
+func BenchmarkVSIHandler(b *testing.B) {
+	benchVSIHandlerOnce.Do(func() {
+		fname := tempfile()
+		defer os.Remove(fname)
+		ds := benchmarkRaster(b, fname, 1, Byte, 1024, 256)
+		ds.Close()
+		tifdat, _ := ioutil.ReadFile(fname)
+		vpa := vpAdapter{datas: make(map[string]VSIReader)}
+		vpa.datas["bench.tif"] = latencyReader{mbufAdapter{tifdat}, 100 * time.Microsecond}
+		benchVSIHandlerErr = RegisterVSIHandler("benchlatency://", vpa, VSIHandlerBufferSize(0), VSIHandlerCacheSize(0))
+	})
+	if benchVSIHandlerErr != nil {
+		b.Fatal(benchVSIHandlerErr)
+	}
+
+	b.Run("Read", func(b *testing.B) {
+		buf := make([]byte, 16384)
+		b.SetBytes(int64(len(buf)))
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			vf, err := VSIOpen("benchlatency://bench.tif")
+			if err != nil {
+				b.Fatal(err)
+			}
+			if _, err := vf.Read(buf); err != nil {
+				b.Fatal(err)
+			}
+			_ = vf.Close()
+		}
+	})
+	b.Run("ReadMultiRange", func(b *testing.B) {
+		buf := make([]byte, 1024*512)
+		b.SetBytes(int64(len(buf)))
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			//reopen so that no blocks are cached, and each iteration goes through the handler
+			b.StopTimer()
+			ds, err := Open("benchlatency://bench.tif")
+			if err != nil {
+				b.Fatal(err)
+			}
+			b.StartTimer()
+			if err := ds.Bands()[0].Read(0, (i%2)*512, buf, 1024, 512); err != nil {
+				b.Fatal(err)
+			}
+			b.StopTimer()
+			ds.Close()
+			b.StartTimer()
+		}
+	})
+}
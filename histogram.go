@@ -14,6 +14,8 @@
 
 package godal
 
+import "math"
+
 // Histogram is a band's histogram.
 type Histogram struct {
 	min, max float64
@@ -41,6 +43,74 @@ func (h Histogram) Bucket(i int) Bucket {
 	}
 }
 
+// Quantile returns the q-quantile (0<=q<=1) of the values counted in the histogram, by
+// linear interpolation inside the bucket it falls in. The result is exact for integer data
+// when the buckets are centered on each value, as for the default histograms of
+// Dataset.Statistics on 8 and 16 bit bands.
+func (h Histogram) Quantile(q float64) float64 {
+	total := uint64(0)
+	for _, c := range h.counts {
+		total += c
+	}
+	if total == 0 {
+		return math.NaN()
+	}
+	width := (h.max - h.min) / float64(len(h.counts))
+	rank := q * float64(total)
+	cum := 0.0
+	for i, c := range h.counts {
+		if c == 0 {
+			continue
+		}
+		if cum+float64(c) >= rank {
+			if width == 1 && h.min == math.Floor(h.min)+0.5 {
+				//one bucket per integer value
+				return h.min + 0.5 + float64(i)
+			}
+			return h.min + width*(float64(i)+(rank-cum)/float64(c))
+		}
+		cum += float64(c)
+	}
+	return h.max
+}
+
+// BandStatistics holds the statistics of a band computed by Dataset.Statistics
+type BandStatistics struct {
+	// Count is the number of valid pixels, i.e. pixels that are neither masked, nodata nor NaN
+	Count uint64
+	// Min, Max, Mean and StdDev are 0 if the band has no valid pixel
+	Min, Max, Mean, StdDev float64
+	// Histogram is the histogram of the valid pixels. It is empty unless set with Intervals,
+	// or for 8 and 16 bit bands that get a histogram with one bucket per possible value.
+	Histogram Histogram
+}
+
+type statisticsOpts struct {
+	bands          []int
+	includeOutside int
+	min, max       float64
+	buckets        int32
+	workers        int
+	errorHandler   ErrorHandler
+}
+
+// StatisticsOption is an option that can be passed to Dataset.Statistics()
+//
+// Available StatisticsOptions are:
+//
+// • Bands
+//
+// • Intervals
+//
+// • IncludeOutOfRange
+//
+// • Workers
+//
+// • ErrLogger
+type StatisticsOption interface {
+	setStatisticsOpt(so *statisticsOpts)
+}
+
 type histogramOpts struct {
 	approx         int
 	includeOutside int
@@ -55,8 +125,9 @@ type histogramOpts struct {
 //
 // • Approximate() to allow the algorithm to operate on a subset of the full resolution data
 //
-// • Intervals(count int, min,max float64) to compute a histogram with count buckets, spanning [min,max].
-//   Each bucket will be (max-min)/count wide. If not provided, the default histogram will be returned.
+// • Intervals(count int, min,max float64) to compute a histogram with count buckets, spanning [min,max).
+//   Each bucket will be (max-min)/count wide, and a value equal to max is out of range. If not provided,
+//   the default histogram will be returned.
 //
 // • IncludeOutOfRange() to populate the first and last bucket with values under/over the specified min/max
 //   when used in conjuntion with Intervals()
@@ -71,11 +142,15 @@ type includeOutsideOpt struct{}
 func (ioo includeOutsideOpt) setHistogramOpt(ho *histogramOpts) {
 	ho.includeOutside = 1
 }
+func (ioo includeOutsideOpt) setStatisticsOpt(so *statisticsOpts) {
+	so.includeOutside = 1
+}
 
 // IncludeOutOfRange populates the first and last bucket with values under/over the specified min/max
 // when used in conjuntion with Intervals()
 func IncludeOutOfRange() interface {
 	HistogramOption
+	StatisticsOption
 } {
 	return includeOutsideOpt{}
 }
@@ -103,11 +178,19 @@ func (io intervalsOption) setHistogramOpt(ho *histogramOpts) {
 	ho.max = io.max
 	ho.buckets = io.buckets
 }
+func (io intervalsOption) setStatisticsOpt(so *statisticsOpts) {
+	so.min = io.min
+	so.max = io.max
+	so.buckets = io.buckets
+}
 
-// Intervals computes a histogram with count buckets, spanning [min,max].
-// Each bucket will be (max-min)/count wide. If not provided, the default histogram will be returned.
+// Intervals computes a histogram with count buckets, spanning [min,max).
+// Each bucket will be (max-min)/count wide, and a value equal to max is out of range (i.e. only
+// counted in the last bucket with IncludeOutOfRange), for both Band.Histogram and Dataset.Statistics.
+// If not provided, the default histogram will be returned.
 func Intervals(count int, min, max float64) interface {
 	HistogramOption
+	StatisticsOption
 } {
 	return intervalsOption{min: min, max: max, buckets: int32(count)}
 }
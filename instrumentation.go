@@ -0,0 +1,91 @@
+// Copyright 2021 Airbus Defence and Space
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package godal
+
+/*
+#include "godal.h"
+#include <stdlib.h>
+*/
+import "C"
+import (
+	"sort"
+	"time"
+	"unsafe"
+)
+
+// CallStats are the counters of the instrumented calls to a godal C entry point
+type CallStats struct {
+	// Function is the name of the C function, e.g. "godalOpen". Calls made from the
+	// worker threads of an entry point are reported under the name of that entry point.
+	Function string
+	Calls    int64
+	// Wrap is the time spent setting up and tearing down the error handlers and config
+	// options of the calls (i.e. the fixed cost of a godal call on the C side)
+	Wrap time.Duration
+	// GDAL is the time spent in the body of the calls, i.e. mostly in gdal itself. It
+	// includes the time spent in nested calls and in go callbacks (e.g. VSI handlers).
+	GDAL time.Duration
+}
+
+// EnableInstrumentation starts (or stops, if enabled is false) counting the calls
+// to godal's C entry points and the time spent in them, as returned by
+// Instrumentation. Instrumentation is disabled by default; enabling it adds a few
+// clock reads and a mutex acquisition per call.
+//
+// Comparing these times to the ones measured from go (e.g. by a benchmark) gives the
+// overhead of the cgo calls themselves.
+func EnableInstrumentation(enabled bool) {
+	cenabled := C.int(0)
+	if enabled {
+		cenabled = 1
+	}
+	C.godalSetInstrumentation(cenabled)
+}
+
+// ResetInstrumentation clears the counters returned by Instrumentation
+func ResetInstrumentation() {
+	C.godalResetInstrumentation()
+}
+
+// Instrumentation returns the counters of the calls made since instrumentation was
+// enabled or last reset, by decreasing total time
+func Instrumentation() []CallStats {
+	var cstats *C.godalCallStat
+	n := int(C.godalInstrumentationStats(&cstats))
+	if n == 0 {
+		return nil
+	}
+	defer C.free(unsafe.Pointer(cstats))
+	stats := (*[1 << 20]C.godalCallStat)(unsafe.Pointer(cstats))[:n:n]
+	byName := map[string]int{}
+	ret := []CallStats{}
+	for _, cs := range stats {
+		name := C.GoString(cs.function)
+		idx, ok := byName[name]
+		if !ok {
+			idx = len(ret)
+			ret = append(ret, CallStats{Function: name})
+			byName[name] = idx
+		}
+		st := &ret[idx]
+		st.Calls += int64(cs.calls)
+		st.Wrap += time.Duration(cs.wrapNs)
+		st.GDAL += time.Duration(cs.bodyNs)
+	}
+	sort.Slice(ret, func(i, j int) bool {
+		return ret[i].Wrap+ret[i].GDAL > ret[j].Wrap+ret[j].GDAL
+	})
+	return ret
+}
@@ -14,7 +14,12 @@
 
 package godal
 
-import "sort"
+import (
+	"context"
+	"sort"
+	"strconv"
+	"time"
+)
 
 //GetGeoTransformOption is an option that can be passed to Dataset.GeoTransform()
 //
@@ -108,6 +113,271 @@ type FillBandOption interface {
 	setFillBandOpt(o *fillBandOpts)
 }
 
+type blockIOOpts struct {
+	config       []string
+	errorHandler ErrorHandler
+}
+
+// BlockIOOption is an option that can be passed to Band.ReadBlock, Band.WriteBlock
+// and Band.LockBlock
+//
+// Available BlockIOOptions are:
+//
+// • ConfigOption
+//
+// • ErrLogger
+type BlockIOOption interface {
+	setBlockIOOpt(bo *blockIOOpts)
+}
+
+type bufferPoolOpts struct {
+	cmem    bool
+	maxIdle int
+}
+
+// BufferPoolOption is an option that can be passed to NewBufferPool
+//
+// Available BufferPoolOptions are:
+//
+// • CMemory
+//
+// • MaxIdle
+type BufferPoolOption interface {
+	setBufferPoolOpt(bo *bufferPoolOpts)
+}
+
+type cMemoryOpt struct{}
+
+// CMemory makes a BufferPool allocate its buffers with VSIMallocAligned instead of
+// the go heap, so that large rasters do not add to the garbage collector's workload.
+// Such buffers are never garbage collected: they must be returned with BufferPool.Put,
+// and their Data must not be referenced once they have been.
+func CMemory() interface {
+	BufferPoolOption
+} {
+	return cMemoryOpt{}
+}
+
+func (cMemoryOpt) setBufferPoolOpt(bo *bufferPoolOpts) {
+	bo.cmem = true
+}
+
+type maxIdleOpt struct {
+	n int
+}
+
+// MaxIdle sets the maximum number of idle C allocated buffers kept by a BufferPool
+// for each data type and size. Defaults to 16.
+//
+// For a DatasetPool, MaxIdle sets the total number of idle datasets kept open, the least
+// recently used ones being closed first. Defaults to 64.
+func MaxIdle(n int) interface {
+	BufferPoolOption
+	DatasetPoolOption
+} {
+	return maxIdleOpt{n}
+}
+
+func (mo maxIdleOpt) setBufferPoolOpt(bo *bufferPoolOpts) {
+	bo.maxIdle = mo.n
+}
+func (mo maxIdleOpt) setDatasetPoolOpt(po *datasetPoolOpts) {
+	po.maxIdle = mo.n
+}
+
+type datasetPoolOpts struct {
+	maxIdle int
+	maxOpen int
+}
+
+// DatasetPoolOption is an option that can be passed to NewDatasetPool
+//
+// Available DatasetPoolOptions are:
+//
+// • MaxIdle
+//
+// • MaxOpen
+type DatasetPoolOption interface {
+	setDatasetPoolOpt(po *datasetPoolOpts)
+}
+
+type maxOpenOpt struct {
+	n int
+}
+
+// MaxOpen sets the maximum number of datasets a DatasetPool keeps open at the same
+// time, either in use or idle, e.g. to stay within the process' open files limit.
+// Defaults to 0, i.e. no limit.
+func MaxOpen(n int) interface {
+	DatasetPoolOption
+} {
+	return maxOpenOpt{n}
+}
+
+func (mo maxOpenOpt) setDatasetPoolOpt(po *datasetPoolOpts) {
+	po.maxOpen = mo.n
+}
+
+type processTilesOpts struct {
+	workers      int
+	tileX, tileY int
+	inFlight     int
+	dst          *Dataset
+	errorHandler ErrorHandler
+}
+
+// ProcessTilesOption is an option that can be passed to Dataset.ProcessTiles
+//
+// Available ProcessTilesOptions are:
+//
+// • Workers
+//
+// • TileSize
+//
+// • MaxTilesInFlight
+//
+// • ProcessInto
+//
+// • ErrLogger
+type ProcessTilesOption interface {
+	setProcessTilesOpt(po *processTilesOpts)
+}
+
+type workersOpt struct {
+	n int
+}
+
+// Workers sets the number of goroutines used by ProcessTiles, or the number of threads
+// used by ProcessGeometries and ProcessWKB. Defaults to runtime.NumCPU()
+//
+// For Transform.TransformEx, Workers sets the number of threads used to transform large
+// point arrays, and defaults to 1.
+//
+// For Dataset.Statistics, Workers sets the number of threads reading the dataset, and
+// defaults to runtime.NumCPU().
+func Workers(n int) interface {
+	ProcessTilesOption
+	GeometryBatchOption
+	StatisticsOption
+	TransformExOption
+	PolygonizeOption
+	SieveFilterOption
+	RasterizeGeometriesOption
+} {
+	return workersOpt{n}
+}
+
+func (wo workersOpt) setProcessTilesOpt(po *processTilesOpts) {
+	po.workers = wo.n
+}
+func (wo workersOpt) setGeometryBatchOpt(gbo *geometryBatchOpts) {
+	gbo.workers = wo.n
+}
+func (wo workersOpt) setTransformExOpt(to *transformExOpts) {
+	to.workers = wo.n
+}
+func (wo workersOpt) setStatisticsOpt(so *statisticsOpts) {
+	so.workers = wo.n
+}
+func (wo workersOpt) setPolygonizeOpt(po *polygonizeOpts) {
+	po.workers = wo.n
+}
+func (wo workersOpt) setSieveFilterOpt(so *sieveFilterOpts) {
+	so.workers = wo.n
+}
+func (wo workersOpt) setRasterizeGeometriesOpt(ro *rasterizeGeometriesOpts) {
+	ro.workers = wo.n
+}
+
+type tileSizeOpt struct {
+	x, y int
+}
+
+// TileSize sets the size of the windows processed by ProcessTiles, which must be a
+// multiple of the dataset's block size. Defaults to the block size.
+func TileSize(x, y int) interface {
+	ProcessTilesOption
+	PolygonizeOption
+	SieveFilterOption
+} {
+	return tileSizeOpt{x, y}
+}
+
+func (to tileSizeOpt) setProcessTilesOpt(po *processTilesOpts) {
+	po.tileX, po.tileY = to.x, to.y
+}
+func (to tileSizeOpt) setPolygonizeOpt(po *polygonizeOpts) {
+	po.tileX, po.tileY = to.x, to.y
+}
+func (to tileSizeOpt) setSieveFilterOpt(so *sieveFilterOpts) {
+	so.tileX, so.tileY = to.x, to.y
+}
+
+type tileOverlapOpt struct {
+	n int
+}
+
+// TileOverlap sets the number of pixels read around each tile by a tiled
+// Band.SieveFilter. Regions smaller than the size threshold are sieved exactly as by
+// the untiled algorithm as long as the overlap is not smaller than the threshold.
+func TileOverlap(n int) interface {
+	SieveFilterOption
+} {
+	return tileOverlapOpt{n}
+}
+
+func (to tileOverlapOpt) setSieveFilterOpt(so *sieveFilterOpts) {
+	so.overlap = to.n
+}
+
+type maxTilesInFlightOpt struct {
+	n int
+}
+
+// MaxTilesInFlight bounds the number of tiles being read, processed, or waiting to be
+// written by ProcessTiles, and hence its memory usage. Defaults to twice the number of workers.
+func MaxTilesInFlight(n int) interface {
+	ProcessTilesOption
+} {
+	return maxTilesInFlightOpt{n}
+}
+
+func (mo maxTilesInFlightOpt) setProcessTilesOpt(po *processTilesOpts) {
+	po.inFlight = mo.n
+}
+
+type processIntoOpt struct {
+	dst *Dataset
+}
+
+// ProcessInto makes ProcessTiles write the processed tiles to the same window of dst,
+// which must have the same size and number of bands as the source dataset.
+func ProcessInto(dst *Dataset) interface {
+	ProcessTilesOption
+} {
+	return processIntoOpt{dst}
+}
+
+func (po processIntoOpt) setProcessTilesOpt(o *processTilesOpts) {
+	o.dst = po.dst
+}
+
+type rawTileOpts struct {
+	config       []string
+	errorHandler ErrorHandler
+}
+
+// RawTileOption is an option that can be passed to Band.RawTiles and Band.ReadRawTiles
+//
+// Available RawTileOptions are:
+//
+// • ConfigOption
+//
+// • ErrLogger
+type RawTileOption interface {
+	setRawTileOpt(ro *rawTileOpts)
+}
+
 type bandCreateMaskOpts struct {
 	config       []string
 	errorHandler ErrorHandler
@@ -129,6 +399,7 @@ type bandIOOpts struct {
 	dsWidth, dsHeight         int
 	resampling                ResamplingAlg
 	pixelSpacing, lineSpacing int
+	threads                   int
 	errorHandler              ErrorHandler
 }
 
@@ -147,6 +418,8 @@ type bandIOOpts struct {
 // • PixelSpacing
 //
 // • LineSpacing
+//
+// • IOThreads
 type BandIOOption interface {
 	setBandIOOpt(ro *bandIOOpts)
 }
@@ -178,6 +451,10 @@ type sieveFilterOpts struct {
 	mask          *Band
 	dstBand       *Band
 	connectedness int
+	tileX, tileY  int
+	overlap       int
+	workers       int
+	progress      progressOpts
 	errorHandler  ErrorHandler
 }
 
@@ -192,6 +469,16 @@ type sieveFilterOpts struct {
 // • NoMask() to ignore the the source band's nodata value or mask band
 //
 // • Destination(band) where to output the sieved band, instead of updating in-place
+//
+// • TileSize(x,y) to sieve the band by tiles of x*y pixels processed in parallel
+// instead of as a whole. See TileOverlap and Workers
+//
+// • TileOverlap(n) number of pixels read around each tile when sieving by tiles.
+// Defaults to the size threshold
+//
+// • Workers(n) number of tiles sieved concurrently. Defaults to runtime.NumCPU()
+//
+// • Progress(fn) and Context(ctx) to monitor and cancel the operation
 type SieveFilterOption interface {
 	setSieveFilterOpt(sfo *sieveFilterOpts)
 }
@@ -200,6 +487,9 @@ type polygonizeOpts struct {
 	mask          *Band
 	options       []string
 	pixFieldIndex int
+	tileX, tileY  int
+	workers       int
+	progress      progressOpts
 	errorHandler  ErrorHandler
 }
 
@@ -213,6 +503,18 @@ type polygonizeOpts struct {
 // dataset with the polygon's pixel value
 //
 // • Mask(band) to use given band as nodata mask instead of the internal nodata mask
+//
+// • TileSize(x,y) to polygonize the band by tiles of x*y pixels processed in parallel
+// instead of as a whole. Polygons crossing tile boundaries are dissolved before being
+// written to the layer, so that the output is the same as for the whole band
+// (up to the feature order and the starting vertex of the rings). The only exception is
+// with EightConnected, where pixels that are only connected through a corner lying on a tile
+// boundary are output as separate polygons. The polygons touching a tile boundary are kept
+// in memory until all the tiles have been polygonized.
+//
+// • Workers(n) number of tiles polygonized concurrently. Defaults to runtime.NumCPU()
+//
+// • Progress(fn) and Context(ctx) to monitor and cancel the operation
 type PolygonizeOption interface {
 	setPolygonizeOpt(ro *polygonizeOpts)
 }
@@ -235,6 +537,7 @@ type dsTranslateOpts struct {
 	config       []string
 	creation     []string
 	driver       DriverName
+	progress     progressOpts
 	errorHandler ErrorHandler
 }
 
@@ -247,6 +550,10 @@ type dsTranslateOpts struct {
 // • CreationOption
 //
 // • DriverName
+//
+// • Progress
+//
+// • Context
 type DatasetTranslateOption interface {
 	setDatasetTranslateOpt(dto *dsTranslateOpts)
 }
@@ -255,6 +562,8 @@ type dsWarpOpts struct {
 	config       []string
 	creation     []string
 	driver       DriverName
+	warp         warpSetup
+	progress     progressOpts
 	errorHandler ErrorHandler
 }
 
@@ -267,31 +576,127 @@ type dsWarpOpts struct {
 // • CreationOption
 //
 // • DriverName
+//
+// • NumThreads
+//
+// • WarpMemory
+//
+// • WarpErrorThreshold
+//
+// • Progress
+//
+// • Context
 type DatasetWarpOption interface {
 	setDatasetWarpOpt(dwo *dsWarpOpts)
 }
 
 // DatasetWarpIntoOption is an option that can be passed to Dataset.WarpInto()
 //
-// Available DatasetWarpIntoOption is:
+// Available DatasetWarpIntoOptions are:
 //
 // • ConfigOption
 //
+// • NumThreads
+//
+// • WarpMemory
+//
+// • WarpErrorThreshold
+//
+// • Progress
+//
+// • Context
 type DatasetWarpIntoOption interface {
 	setDatasetWarpIntoOpt(dwo *dsWarpIntoOpts)
 }
 
+// warpSetup holds the warp tuning options that are translated to gdalwarp switches
+type warpSetup struct {
+	threads        int
+	memoryMB       int
+	errorThreshold float64
+	hasThreshold   bool
+}
+
+func (ws warpSetup) switches() []string {
+	var sw []string
+	if ws.threads != 0 {
+		nt := "ALL_CPUS"
+		if ws.threads > 0 {
+			nt = strconv.Itoa(ws.threads)
+		}
+		sw = append(sw, "-multi", "-wo", "NUM_THREADS="+nt)
+	}
+	if ws.memoryMB > 0 {
+		sw = append(sw, "-wm", strconv.Itoa(ws.memoryMB))
+	}
+	if ws.hasThreshold {
+		sw = append(sw, "-et", strconv.FormatFloat(ws.errorThreshold, 'g', -1, 64))
+	}
+	return sw
+}
+
 type dsWarpIntoOpts struct {
 	config       []string
+	warp         warpSetup
+	progress     progressOpts
+	errorHandler ErrorHandler
+}
+
+type warperOpts struct {
+	config       []string
+	resampling   ResamplingAlg
+	warp         warpSetup
+	errorHandler ErrorHandler
+}
+
+// WarperOption is an option that can be passed to NewWarper
+//
+// Available WarperOptions are:
+//
+// • Resampling
+//
+// • NumThreads
+//
+// • WarpMemory
+//
+// • WarpErrorThreshold
+//
+// • ConfigOption
+//
+// • ErrLogger
+type WarperOption interface {
+	setWarperOpt(wo *warperOpts)
+}
+
+type warpTileOpts struct {
+	config       []string
+	progress     progressOpts
 	errorHandler ErrorHandler
 }
 
+// WarpTileOption is an option that can be passed to Warper.WarpTile
+//
+// Available WarpTileOptions are:
+//
+// • ConfigOption
+//
+// • Progress
+//
+// • Context
+//
+// • ErrLogger
+type WarpTileOption interface {
+	setWarpTileOpt(wo *warpTileOpts)
+}
+
 type buildOvrOpts struct {
 	config       []string
 	minSize      int
 	resampling   ResamplingAlg
 	bands        []int
 	levels       []int
+	threads      int
+	progress     progressOpts
 	errorHandler ErrorHandler
 }
 
@@ -308,6 +713,12 @@ type buildOvrOpts struct {
 // • MinSize
 //
 // • Bands
+//
+// • NumThreads
+//
+// • Progress
+//
+// • Context
 type BuildOverviewsOption interface {
 	setBuildOverviewsOpt(bo *buildOvrOpts)
 }
@@ -450,6 +861,18 @@ type vsiUnlinkOpts struct {
 type VSIUnlinkOption interface {
 	setVSIUnlinkOpt(vo *vsiUnlinkOpts)
 }
+type vsiInvalidateOpts struct {
+	errorHandler ErrorHandler
+}
+type VSIInvalidateOption interface {
+	setVSIInvalidateOpt(vo *vsiInvalidateOpts)
+}
+type vsiStatsOpts struct {
+	errorHandler ErrorHandler
+}
+type VSIStatsOption interface {
+	setVSIStatsOpt(so *vsiStatsOpts)
+}
 
 type geometryWKTOpts struct {
 	errorHandler ErrorHandler
@@ -567,7 +990,9 @@ func Bands(bnds ...int) interface {
 	DatasetIOOption
 	BuildOverviewsOption
 	RasterizeGeometryOption
+	RasterizeGeometriesOption
 	BuildVRTOption
+	StatisticsOption
 } {
 	ib := make([]int, len(bnds))
 	for i := range bnds {
@@ -585,9 +1010,15 @@ func (bo bandOpt) setBuildOverviewsOpt(ovr *buildOvrOpts) {
 func (bo bandOpt) setRasterizeGeometryOpt(o *rasterizeGeometryOpts) {
 	o.bands = bo.bnds
 }
+func (bo bandOpt) setRasterizeGeometriesOpt(o *rasterizeGeometriesOpts) {
+	o.bands = bo.bnds
+}
 func (bo bandOpt) setBuildVRTOpt(bvo *buildVRTOpts) {
 	bvo.bands = bo.bnds
 }
+func (bo bandOpt) setStatisticsOpt(so *statisticsOpts) {
+	so.bands = bo.bnds
+}
 
 type bandSpacingOpt struct {
 	sp int
@@ -663,6 +1094,26 @@ func (wo windowOpt) setBandIOOpt(ro *bandIOOpts) {
 	ro.dsHeight = wo.sy
 }
 
+type ioThreadsOpt struct {
+	n int
+}
+
+// IOThreads makes Band.IOBatch read the windows concurrently with n threads. As gdal
+// handles cannot be used concurrently, each additional thread reopens the band's dataset
+// by name and without open options for the duration of the call, which is only worthwhile
+// if the windows are expensive to fetch (e.g. from a remote VSI handler). Datasets that
+// cannot be reopened this way (e.g. MEM datasets) are read with the calling thread only.
+// Ignored by Band.IO, and for writes.
+func IOThreads(n int) interface {
+	BandIOOption
+} {
+	return ioThreadsOpt{n}
+}
+
+func (to ioThreadsOpt) setBandIOOpt(ro *bandIOOpts) {
+	ro.threads = to.n
+}
+
 type bandInterleaveOp struct{}
 
 // BandInterleaved makes Read return a band interleaved buffer instead of a pixel interleaved one.
@@ -737,7 +1188,11 @@ func ConfigOption(cfgs ...string) interface {
 	RasterizeOption
 	DatasetIOOption
 	BandIOOption
+	BlockIOOption
+	RawTileOption
 	BuildVRTOption
+	WarperOption
+	WarpTileOption
 	errorAndLoggingOption
 } {
 	return configOpt{cfgs}
@@ -779,9 +1234,21 @@ func (co configOpt) setDatasetIOOpt(oo *datasetIOOpts) {
 func (co configOpt) setBandIOOpt(oo *bandIOOpts) {
 	oo.config = append(oo.config, co.config...)
 }
+func (co configOpt) setBlockIOOpt(bo *blockIOOpts) {
+	bo.config = append(bo.config, co.config...)
+}
+func (co configOpt) setRawTileOpt(ro *rawTileOpts) {
+	ro.config = append(ro.config, co.config...)
+}
 func (co configOpt) setBuildVRTOpt(bvo *buildVRTOpts) {
 	bvo.config = append(bvo.config, co.config...)
 }
+func (co configOpt) setWarperOpt(wo *warperOpts) {
+	wo.config = append(wo.config, co.config...)
+}
+func (co configOpt) setWarpTileOpt(wo *warpTileOpts) {
+	wo.config = append(wo.config, co.config...)
+}
 func (co configOpt) setErrorAndLoggingOpt(elo *errorAndLoggingOpts) {
 	elo.config = append(elo.config, co.config...)
 }
@@ -816,6 +1283,7 @@ func Resampling(alg ResamplingAlg) interface {
 	DatasetIOOption
 	BandIOOption
 	BuildVRTOption
+	WarperOption
 } {
 	return resamplingOpt{alg}
 }
@@ -831,6 +1299,9 @@ func (ro resamplingOpt) setBandIOOpt(io *bandIOOpts) {
 func (ro resamplingOpt) setBuildVRTOpt(bvo *buildVRTOpts) {
 	bvo.resampling = ro.m
 }
+func (ro resamplingOpt) setWarperOpt(wo *warperOpts) {
+	wo.resampling = ro.m
+}
 
 type levelsOpt struct {
 	lvl []int
@@ -852,6 +1323,214 @@ func (lo levelsOpt) setBuildOverviewsOpt(bo *buildOvrOpts) {
 	bo.levels = slevels
 }
 
+type numThreadsOpt struct {
+	n int
+}
+
+// NumThreads sets the number of threads gdal may use to compute the output in parallel.
+// n <= 0 uses all available cores.
+//
+// For BuildOverviews, this sets the GDAL_NUM_THREADS config option so that the blocks of each
+// level are computed in parallel, which requires gdal >= 3.2 and is honored by most resampling
+// algorithms. Overview levels are still computed one after the other, as each level is
+// usually computed from the previous one.
+//
+// For Warp and WarpInto, this enables gdalwarp's multithreaded mode (i.e. the -multi and
+// -wo NUM_THREADS=n switches): I/O and computation of successive chunks are overlapped, and
+// each chunk is computed by n threads. The chunk size is set by WarpMemory.
+func NumThreads(n int) interface {
+	BuildOverviewsOption
+	DatasetWarpOption
+	DatasetWarpIntoOption
+	WarperOption
+} {
+	if n <= 0 {
+		n = -1
+	}
+	return numThreadsOpt{n}
+}
+func (nto numThreadsOpt) setBuildOverviewsOpt(bo *buildOvrOpts) {
+	bo.threads = nto.n
+}
+func (nto numThreadsOpt) setDatasetWarpOpt(dwo *dsWarpOpts) {
+	dwo.warp.threads = nto.n
+}
+func (nto numThreadsOpt) setDatasetWarpIntoOpt(dwo *dsWarpIntoOpts) {
+	dwo.warp.threads = nto.n
+}
+func (nto numThreadsOpt) setWarperOpt(wo *warperOpts) {
+	wo.warp.threads = nto.n
+}
+
+type warpMemoryOpt struct {
+	mb int
+}
+
+// WarpMemory sets the amount of memory, in megabytes, that the warper may use for its
+// working buffers (i.e. the -wm switch). The output is warped in chunks that fit in this
+// size, so a larger value means fewer, larger chunks.
+func WarpMemory(mb int) interface {
+	DatasetWarpOption
+	DatasetWarpIntoOption
+	WarperOption
+} {
+	return warpMemoryOpt{mb}
+}
+func (wmo warpMemoryOpt) setDatasetWarpOpt(dwo *dsWarpOpts) {
+	dwo.warp.memoryMB = wmo.mb
+}
+func (wmo warpMemoryOpt) setDatasetWarpIntoOpt(dwo *dsWarpIntoOpts) {
+	dwo.warp.memoryMB = wmo.mb
+}
+func (wmo warpMemoryOpt) setWarperOpt(wo *warperOpts) {
+	wo.warp.memoryMB = wmo.mb
+}
+
+type warpErrorThresholdOpt struct {
+	et float64
+}
+
+// WarpErrorThreshold sets the maximum error, in pixels, of the approximate transformer used
+// by the warper (i.e. the -et switch). 0 uses the exact transformer for every pixel, and
+// larger values let the warper interpolate the transformation over larger spans.
+func WarpErrorThreshold(pixels float64) interface {
+	DatasetWarpOption
+	DatasetWarpIntoOption
+	WarperOption
+} {
+	return warpErrorThresholdOpt{pixels}
+}
+func (weo warpErrorThresholdOpt) setDatasetWarpOpt(dwo *dsWarpOpts) {
+	dwo.warp.errorThreshold = weo.et
+	dwo.warp.hasThreshold = true
+}
+func (weo warpErrorThresholdOpt) setDatasetWarpIntoOpt(dwo *dsWarpIntoOpts) {
+	dwo.warp.errorThreshold = weo.et
+	dwo.warp.hasThreshold = true
+}
+func (weo warpErrorThresholdOpt) setWarperOpt(wo *warperOpts) {
+	wo.warp.errorThreshold = weo.et
+	wo.warp.hasThreshold = true
+}
+
+func numThreadsConfig(n int) string {
+	if n < 0 {
+		return "GDAL_NUM_THREADS=ALL_CPUS"
+	}
+	return "GDAL_NUM_THREADS=" + strconv.Itoa(n)
+}
+
+type progressOpt struct {
+	fn ProgressFunc
+}
+
+// Progress makes long running operations report their progress to fn, which can
+// interrupt them by returning false. fn is called from the thread running the operation.
+func Progress(fn ProgressFunc) interface {
+	BuildOverviewsOption
+	DatasetTranslateOption
+	DatasetWarpOption
+	DatasetWarpIntoOption
+	RasterizeOption
+	DatasetVectorTranslateOption
+	BuildVRTOption
+	WarpTileOption
+	PolygonizeOption
+	SieveFilterOption
+	RasterizeGeometriesOption
+} {
+	return progressOpt{fn}
+}
+func (po progressOpt) setRasterizeGeometriesOpt(o *rasterizeGeometriesOpts) {
+	o.progress.fn = po.fn
+}
+func (po progressOpt) setPolygonizeOpt(o *polygonizeOpts) {
+	o.progress.fn = po.fn
+}
+func (po progressOpt) setSieveFilterOpt(o *sieveFilterOpts) {
+	o.progress.fn = po.fn
+}
+func (po progressOpt) setBuildOverviewsOpt(bo *buildOvrOpts) {
+	bo.progress.fn = po.fn
+}
+func (po progressOpt) setDatasetTranslateOpt(dto *dsTranslateOpts) {
+	dto.progress.fn = po.fn
+}
+func (po progressOpt) setDatasetWarpOpt(dwo *dsWarpOpts) {
+	dwo.progress.fn = po.fn
+}
+func (po progressOpt) setDatasetWarpIntoOpt(dwo *dsWarpIntoOpts) {
+	dwo.progress.fn = po.fn
+}
+func (po progressOpt) setRasterizeOpt(ro *rasterizeOpts) {
+	ro.progress.fn = po.fn
+}
+func (po progressOpt) setDatasetVectorTranslateOpt(dwo *dsVectorTranslateOpts) {
+	dwo.progress.fn = po.fn
+}
+func (po progressOpt) setBuildVRTOpt(bvo *buildVRTOpts) {
+	bvo.progress.fn = po.fn
+}
+func (po progressOpt) setWarpTileOpt(wo *warpTileOpts) {
+	wo.progress.fn = po.fn
+}
+
+type contextOpt struct {
+	ctx context.Context
+}
+
+// Context makes long running operations return ctx.Err() once ctx is cancelled or its
+// deadline is exceeded. The context is checked each time gdal reports progress, so the
+// operation may keep running a little while after ctx is done.
+func Context(ctx context.Context) interface {
+	BuildOverviewsOption
+	DatasetTranslateOption
+	DatasetWarpOption
+	DatasetWarpIntoOption
+	RasterizeOption
+	DatasetVectorTranslateOption
+	BuildVRTOption
+	WarpTileOption
+	PolygonizeOption
+	SieveFilterOption
+	RasterizeGeometriesOption
+} {
+	return contextOpt{ctx}
+}
+func (co contextOpt) setRasterizeGeometriesOpt(o *rasterizeGeometriesOpts) {
+	o.progress.ctx = co.ctx
+}
+func (co contextOpt) setPolygonizeOpt(o *polygonizeOpts) {
+	o.progress.ctx = co.ctx
+}
+func (co contextOpt) setSieveFilterOpt(o *sieveFilterOpts) {
+	o.progress.ctx = co.ctx
+}
+func (co contextOpt) setBuildOverviewsOpt(bo *buildOvrOpts) {
+	bo.progress.ctx = co.ctx
+}
+func (co contextOpt) setDatasetTranslateOpt(dto *dsTranslateOpts) {
+	dto.progress.ctx = co.ctx
+}
+func (co contextOpt) setDatasetWarpOpt(dwo *dsWarpOpts) {
+	dwo.progress.ctx = co.ctx
+}
+func (co contextOpt) setDatasetWarpIntoOpt(dwo *dsWarpIntoOpts) {
+	dwo.progress.ctx = co.ctx
+}
+func (co contextOpt) setRasterizeOpt(ro *rasterizeOpts) {
+	ro.progress.ctx = co.ctx
+}
+func (co contextOpt) setDatasetVectorTranslateOpt(dwo *dsVectorTranslateOpts) {
+	dwo.progress.ctx = co.ctx
+}
+func (co contextOpt) setBuildVRTOpt(bvo *buildVRTOpts) {
+	bvo.progress.ctx = co.ctx
+}
+func (co contextOpt) setWarpTileOpt(wo *warpTileOpts) {
+	wo.progress.ctx = co.ctx
+}
+
 type maskBandOpt struct {
 	band *Band
 }
@@ -985,6 +1664,7 @@ type rasterizeOpts struct {
 	create       []string
 	config       []string
 	driver       DriverName
+	progress     progressOpts
 	errorHandler ErrorHandler
 }
 
@@ -997,6 +1677,10 @@ type rasterizeOpts struct {
 // • ConfigOption
 //
 // • DriverName
+//
+// • Progress
+//
+// • Context
 type RasterizeOption interface {
 	setRasterizeOpt(ro *rasterizeOpts)
 }
@@ -1013,17 +1697,46 @@ type RasterizeGeometryOption interface {
 	setRasterizeGeometryOpt(o *rasterizeGeometryOpts)
 }
 
+type rasterizeGeometriesOpts struct {
+	bands        []int
+	allTouched   int
+	workers      int
+	progress     progressOpts
+	errorHandler ErrorHandler
+}
+
+// RasterizeGeometriesOption is an option that can be passed to Dataset.RasterizeGeometries()
+//
+// Available RasterizeGeometriesOptions are:
+//
+// • Bands(bnd ...int) the list of bands to affect
+//
+// • AllTouched()
+//
+// • Workers(n) to burn the geometries by chunks of rows on n threads
+//
+// • Progress
+//
+// • Context
+type RasterizeGeometriesOption interface {
+	setRasterizeGeometriesOpt(o *rasterizeGeometriesOpts)
+}
+
 type allTouchedOpt struct{}
 
 func (at allTouchedOpt) setRasterizeGeometryOpt(o *rasterizeGeometryOpts) {
 	o.allTouched = 1
 }
+func (at allTouchedOpt) setRasterizeGeometriesOpt(o *rasterizeGeometriesOpts) {
+	o.allTouched = 1
+}
 
 // AllTouched is an option that can be passed to Dataset.RasterizeGeometries()
 // where all pixels touched by lines or polygons will be updated, not just those on the line
 // render path, or whose center point is within the polygon.
 func AllTouched() interface {
 	RasterizeGeometryOption
+	RasterizeGeometriesOption
 } {
 	return allTouchedOpt{}
 }
@@ -1032,6 +1745,7 @@ type dsVectorTranslateOpts struct {
 	config       []string
 	creation     []string
 	driver       DriverName
+	progress     progressOpts
 	errorHandler ErrorHandler
 }
 
@@ -1042,10 +1756,130 @@ type dsVectorTranslateOpts struct {
 // • CreationOption
 // • ConfigOption
 // • DriverName
+// • Progress
+// • Context
 type DatasetVectorTranslateOption interface {
 	setDatasetVectorTranslateOpt(dwo *dsVectorTranslateOpts)
 }
 
+type featureBatchOpts struct {
+	errorHandler ErrorHandler
+}
+
+// FeatureBatchOption is an option that can be passed to Layer.NextFeatureBatch
+//
+// Available FeatureBatchOptions are:
+//
+// • ErrLogger
+type FeatureBatchOption interface {
+	setFeatureBatchOpt(fbo *featureBatchOpts)
+}
+
+type writeFeatureBatchOpts struct {
+	transactionSize int
+	errorHandler    ErrorHandler
+}
+
+// WriteFeatureBatchOption is an option that can be passed to Layer.WriteFeatureBatch
+//
+// Available WriteFeatureBatchOptions are:
+//
+// • TransactionSize
+//
+// • ErrLogger
+type WriteFeatureBatchOption interface {
+	setWriteFeatureBatchOpt(wo *writeFeatureBatchOpts)
+}
+
+type transactionSizeOpt struct {
+	n int
+}
+
+// TransactionSize sets the number of features Layer.WriteFeatureBatch creates per
+// transaction. n <= 0 creates the features without explicit transactions.
+func TransactionSize(n int) interface {
+	WriteFeatureBatchOption
+} {
+	return transactionSizeOpt{n}
+}
+func (tso transactionSizeOpt) setWriteFeatureBatchOpt(wo *writeFeatureBatchOpts) {
+	wo.transactionSize = tso.n
+}
+
+type geometryOp struct {
+	trn      *Transform
+	buffer   bool
+	distance float64
+	segments int
+}
+
+type geometryBatchOpts struct {
+	ops          []geometryOp
+	encoding     GeometryEncoding
+	precision    int
+	workers      int
+	errorHandler ErrorHandler
+}
+
+// GeometryBatchOption is an option that can be passed to ProcessGeometries or ProcessWKB
+//
+// Available GeometryBatchOptions are:
+//
+// • BatchTransform, BatchSimplify, BatchBuffer
+//
+// • BatchEncoding
+//
+// • SignificantDigits, for GeoJSONEncoding
+//
+// • Workers
+//
+// • ErrLogger
+type GeometryBatchOption interface {
+	setGeometryBatchOpt(gbo *geometryBatchOpts)
+}
+
+func (op geometryOp) setGeometryBatchOpt(gbo *geometryBatchOpts) {
+	gbo.ops = append(gbo.ops, op)
+}
+
+// BatchTransform reprojects the geometries with trn, as Geometry.Transform does. trn must
+// not be closed nor used concurrently while the batch is processed.
+func BatchTransform(trn *Transform) interface {
+	GeometryBatchOption
+} {
+	return geometryOp{trn: trn}
+}
+
+// BatchSimplify simplifies the geometries with the given tolerance, as Geometry.Simplify does
+func BatchSimplify(tolerance float64) interface {
+	GeometryBatchOption
+} {
+	return geometryOp{distance: tolerance}
+}
+
+// BatchBuffer buffers the geometries, as Geometry.Buffer does
+func BatchBuffer(distance float64, segments int) interface {
+	GeometryBatchOption
+} {
+	return geometryOp{buffer: true, distance: distance, segments: segments}
+}
+
+type batchEncodingOpt struct {
+	encoding GeometryEncoding
+}
+
+// BatchEncoding sets the format of the geometries returned by ProcessGeometries and
+// ProcessWKB. Defaults to WKBEncoding.
+func BatchEncoding(encoding GeometryEncoding) interface {
+	GeometryBatchOption
+} {
+	return batchEncodingOpt{encoding}
+}
+
+func (beo batchEncodingOpt) setGeometryBatchOpt(gbo *geometryBatchOpts) {
+	gbo.encoding = beo.encoding
+}
+
 type newFeatureOpts struct {
 	errorHandler ErrorHandler
 }
@@ -1084,11 +1918,15 @@ type significantDigits int
 func (sd significantDigits) setGeojsonOpt(o *geojsonOpts) {
 	o.precision = int(sd)
 }
+func (sd significantDigits) setGeometryBatchOpt(o *geometryBatchOpts) {
+	o.precision = int(sd)
+}
 
 // SignificantDigits sets the number of significant digits after the decimal separator should
 // be kept for geojson output
 func SignificantDigits(n int) interface {
 	GeoJSONOption
+	GeometryBatchOption
 } {
 	return significantDigits(n)
 }
@@ -1098,6 +1936,7 @@ type buildVRTOpts struct {
 	openOptions  []string
 	bands        []int
 	resampling   ResamplingAlg
+	progress     progressOpts
 	errorHandler ErrorHandler
 }
 
@@ -1112,12 +1951,26 @@ type buildVRTOpts struct {
 // • Bands
 //
 // • Resampling
+//
+// • Progress
+//
+// • Context
 type BuildVRTOption interface {
 	setBuildVRTOpt(bvo *buildVRTOpts)
 }
 
 type vsiHandlerOpts struct {
 	bufferSize, cacheSize int
+	mergeGap              int
+	sharedCacheSize       int
+	statTTL, negStatTTL   time.Duration
+	prefetch              int
+	partSize              int
+	readAhead             int
+	trace                 func(VSITrace)
+	maxConcurrency        int
+	hedge                 bool
+	hedgeAfter            time.Duration
 	errorHandler          ErrorHandler
 }
 
@@ -1155,3 +2008,175 @@ func VSIHandlerBufferSize(s int) VSIHandlerOption {
 func VSIHandlerCacheSize(s int) VSIHandlerOption {
 	return cacheSizeOpt{s}
 }
+
+type mergeGapOpt struct {
+	b int
+}
+
+func (b mergeGapOpt) setVSIHandlerOpt(v *vsiHandlerOpts) {
+	v.mergeGap = b.b
+}
+
+// VSIHandlerMergeGap sets the maximum number of bytes separating two ranges requested by gdal
+// in a single multi-range read (e.g. the tiles of a window) for them to be merged into a single
+// range before being passed on to the VSIKeyReader. The bytes in between are read and discarded.
+// A value of 64Kb is usually a good tradeoff for object-storage backends where the cost of an
+// individual request dominates.
+//
+// Defaults to 0, i.e. only contiguous or overlapping ranges are merged.
+func VSIHandlerMergeGap(s int) VSIHandlerOption {
+	return mergeGapOpt{s}
+}
+
+type sharedCacheSizeOpt struct {
+	b int
+}
+
+func (b sharedCacheSizeOpt) setVSIHandlerOpt(v *vsiHandlerOpts) {
+	v.sharedCacheSize = b.b
+}
+
+// VSIHandlerSharedCacheSize enables a block cache of at most s bytes shared by all the
+// handles opened on the prefix, so that re-opening a given key does not start with a cold cache.
+// Blocks are evicted in least recently used order and are of VSIHandlerBufferSize bytes (or 64Kb
+// if the buffer size is 0). When set, the per-handle cache configured by VSIHandlerCacheSize
+// is not used.
+//
+// Defaults to 0, i.e. no shared cache.
+func VSIHandlerSharedCacheSize(s int) VSIHandlerOption {
+	return sharedCacheSizeOpt{s}
+}
+
+type statCacheOpt struct {
+	ttl, negativeTTL time.Duration
+}
+
+func (s statCacheOpt) setVSIHandlerOpt(v *vsiHandlerOpts) {
+	v.statTTL = s.ttl
+	v.negStatTTL = s.negativeTTL
+}
+
+// VSIHandlerStatCache caches the sizes returned by VSIReader.Size() for ttl, and the keys
+// for which VSIKeyReader.VSIReader() or VSIReader.Size() failed for negativeTTL, so that the
+// multiple Stat and Open calls gdal issues when opening a dataset result in a single lookup.
+// A zero duration disables the corresponding cache. Use VSIInvalidate to drop cached
+// entries for keys that have been modified.
+//
+// Defaults to 0,0 i.e. no caching.
+func VSIHandlerStatCache(ttl, negativeTTL time.Duration) VSIHandlerOption {
+	return statCacheOpt{ttl, negativeTTL}
+}
+
+type prefetchOpt struct {
+	b int
+}
+
+func (b prefetchOpt) setVSIHandlerOpt(v *vsiHandlerOpts) {
+	v.prefetch = b.b
+}
+
+// VSIHandlerPrefetch makes the handler read the first s bytes of a file when it is opened,
+// using the same VSIReader that was used to query its size. Most drivers start by reading the
+// file header, so a value of e.g. 16Kb removes a round-trip from each dataset opening on
+// high latency backends. The prefetched bytes are kept along with the handle, or seeded into
+// the shared block cache if VSIHandlerSharedCacheSize is set. Must be less than 256Mb.
+//
+// Defaults to 0, i.e. no prefetching.
+func VSIHandlerPrefetch(s int) VSIHandlerOption {
+	return prefetchOpt{s}
+}
+
+type partSizeOpt struct {
+	b int
+}
+
+func (b partSizeOpt) setVSIHandlerOpt(v *vsiHandlerOpts) {
+	v.partSize = b.b
+}
+
+// VSIHandlerWritePartSize sets the size of the parts passed to the Write method of the
+// writers returned by a VSIKeyWriter. Must be less than 256Mb.
+//
+// Defaults to 8Mb.
+func VSIHandlerWritePartSize(s int) VSIHandlerOption {
+	return partSizeOpt{s}
+}
+
+type readAheadOpt struct {
+	n int
+}
+
+func (r readAheadOpt) setVSIHandlerOpt(v *vsiHandlerOpts) {
+	v.readAhead = r.n
+}
+
+// VSIHandlerReadAhead enables read-ahead on handles that are being read sequentially (e.g.
+// by VSIFile.Read, or by drivers scanning a whole file): once two consecutive reads have been
+// detected, the n blocks following the current position are fetched concurrently in the
+// background, each of them with a call to ReadAt of VSIHandlerBufferSize bytes (or 64Kb if
+// the buffer size is 0). Read-ahead stops as soon as a non sequential read is issued.
+// The background reads of all the handles of the handler are made from at most n threads.
+// It is not used when VSIHandlerSharedCacheSize is set.
+//
+// Defaults to 0, i.e. no read-ahead.
+func VSIHandlerReadAhead(n int) VSIHandlerOption {
+	return readAheadOpt{n}
+}
+
+type traceOpt struct {
+	fn func(VSITrace)
+}
+
+func (t traceOpt) setVSIHandlerOpt(v *vsiHandlerOpts) {
+	v.trace = t.fn
+}
+
+// VSIHandlerTrace sets a callback that is called after each ReadAt or ReadAtMulti request
+// made to the handler's VSIReaders, e.g. in order to log or to meter them. fn may be called
+// concurrently and should return quickly as it is called synchronously from the i/o path.
+// The per-handler and per-file counters returned by VSIStats are always maintained and
+// do not require a trace callback.
+func VSIHandlerTrace(fn func(VSITrace)) VSIHandlerOption {
+	return traceOpt{fn}
+}
+
+type maxConcurrencyOpt struct {
+	n int
+}
+
+func (m maxConcurrencyOpt) setVSIHandlerOpt(v *vsiHandlerOpts) {
+	v.maxConcurrency = m.n
+}
+
+// VSIHandlerMaxConcurrency limits the number of concurrent ReadAt calls made to the
+// VSIReaders of the handler, e.g. when a single RasterIO request spans hundreds of blocks
+// that are fetched concurrently because the reader does not implement VSIMultiReader. The
+// limit is shared by all the files opened through the handler. ReadAtMulti calls are not
+// limited.
+//
+// Defaults to 0, i.e. no limit.
+func VSIHandlerMaxConcurrency(n int) VSIHandlerOption {
+	return maxConcurrencyOpt{n}
+}
+
+type hedgeOpt struct {
+	after time.Duration
+}
+
+func (h hedgeOpt) setVSIHandlerOpt(v *vsiHandlerOpts) {
+	v.hedge = true
+	v.hedgeAfter = h.after
+}
+
+// VSIHandlerHedgedReads makes the handler issue a second, identical, ReadAt request if
+// the first one has not completed after the given delay, and use the result of whichever
+// completes first. This trades a few extra requests for lower tail latencies on backends
+// where a small fraction of the requests are much slower than the others. If after is 0,
+// the delay is the 95th percentile of the latencies of the latest requests (no request is
+// hedged until enough latencies have been measured).
+// A hedged request is not issued if it would exceed VSIHandlerMaxConcurrency. As the
+// losing request must not write into gdal's buffers, hedged reads go through an
+// intermediate buffer.
+func VSIHandlerHedgedReads(after time.Duration) VSIHandlerOption {
+	return hedgeOpt{after}
+}
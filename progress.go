@@ -0,0 +1,106 @@
+// Copyright 2021 Airbus Defence and Space
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package godal
+
+/*
+#include "godal.h"
+#include <stdlib.h>
+*/
+import "C"
+import (
+	"context"
+	"errors"
+	"sync"
+)
+
+// ProgressFunc is called by long running operations to report their progress. complete
+// goes from 0 to 1, and message is an optional description of the current step.
+//
+// Returning false interrupts the operation, which then returns ErrInterrupted.
+type ProgressFunc func(complete float64, message string) bool
+
+// ErrInterrupted is returned by operations that were interrupted by their ProgressFunc
+var ErrInterrupted = errors.New("interrupted by progress function")
+
+type progressOpts struct {
+	fn  ProgressFunc
+	ctx context.Context
+}
+
+type progressWrapper struct {
+	mu  sync.Mutex
+	fn  ProgressFunc
+	ctx context.Context
+	err error //set once the operation has been interrupted
+}
+
+var progressMu sync.Mutex
+var progressIndex int
+var progressHandlers = make(map[int]*progressWrapper)
+
+// registerProgress returns the index of the progress handler to pass to the C side,
+// or 0 if the operation needs no progress callback at all
+func registerProgress(po progressOpts) int {
+	if po.fn == nil && po.ctx == nil {
+		return 0
+	}
+	progressMu.Lock()
+	defer progressMu.Unlock()
+	for progressIndex == 0 || progressHandlers[progressIndex] != nil {
+		progressIndex++
+	}
+	progressHandlers[progressIndex] = &progressWrapper{fn: po.fn, ctx: po.ctx}
+	return progressIndex
+}
+
+func getProgress(i int) *progressWrapper {
+	progressMu.Lock()
+	defer progressMu.Unlock()
+	return progressHandlers[i]
+}
+
+func unregisterProgress(i int) {
+	progressMu.Lock()
+	defer progressMu.Unlock()
+	delete(progressHandlers, i)
+}
+
+//export goProgressCallback
+func goProgressCallback(progressID C.int, complete C.double, msg *C.char) C.int {
+	//returns 0 to interrupt the running operation
+	p := getProgress(int(progressID))
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	if p.err != nil {
+		return 0
+	}
+	if p.ctx != nil {
+		if err := p.ctx.Err(); err != nil {
+			p.err = err
+			return 0
+		}
+	}
+	if p.fn != nil {
+		smsg := ""
+		if msg != nil {
+			smsg = C.GoString(msg)
+		}
+		if !p.fn(float64(complete), smsg) {
+			p.err = ErrInterrupted
+			return 0
+		}
+	}
+	return 1
+}
@@ -42,6 +42,19 @@ type TransformOption interface {
 	setTransformOpt(o *trnOpts)
 }
 
+type transformExOpts struct {
+	workers int
+}
+
+// TransformExOption is an option that can be passed to Transform.TransformEx
+//
+// Available TransformExOptions are:
+//
+// • Workers
+type TransformExOption interface {
+	setTransformExOpt(o *transformExOpts)
+}
+
 func (sr *SpatialRef) setBoundsOpt(o *boundsOpts) {
 	o.sr = sr
 }
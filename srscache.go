@@ -0,0 +1,123 @@
+// Copyright 2021 Airbus Defence and Space
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package godal
+
+/*
+#include "godal.h"
+#include <stdlib.h>
+*/
+import "C"
+import (
+	"runtime"
+	"unsafe"
+)
+
+// CachedSpatialRefFromEPSG is the same as NewSpatialRefFromEPSG, except that the lookup in
+// the proj database is only done once per process for each code. The returned SpatialRef
+// is a copy of the cached one, owned by the caller who must Close it.
+func CachedSpatialRefFromEPSG(code int, opts ...CreateSpatialRefOption) (*SpatialRef, error) {
+	if code == 0 {
+		//0 is used to select the wkt cache on the C side
+		return NewSpatialRefFromEPSG(code, opts...)
+	}
+	return cachedSpatialRef(code, "", opts)
+}
+
+// CachedSpatialRefFromWKT is the same as NewSpatialRefFromWKT, except that the WKT is
+// only parsed once per process. The returned SpatialRef is a copy of the cached one, owned
+// by the caller who must Close it.
+func CachedSpatialRefFromWKT(wkt string, opts ...CreateSpatialRefOption) (*SpatialRef, error) {
+	return cachedSpatialRef(0, wkt, opts)
+}
+
+func cachedSpatialRef(code int, wkt string, opts []CreateSpatialRefOption) (*SpatialRef, error) {
+	cso := &createSpatialRefOpts{}
+	for _, o := range opts {
+		o.setCreateSpatialRefOpt(cso)
+	}
+	var cwkt *C.char
+	if code == 0 {
+		cwkt = C.CString(wkt)
+		defer C.free(unsafe.Pointer(cwkt))
+	}
+	cgc := createCGOContext(nil, cso.errorHandler)
+	hndl := C.godalCachedSpatialRef(cgc.cPointer(), C.int(code), cwkt)
+	if err := cgc.close(); err != nil {
+		return nil, err
+	}
+	return &SpatialRef{handle: hndl, isOwned: true}, nil
+}
+
+// SharedTransform is a coordinate transformation that can be used concurrently from any
+// number of goroutines. Each OS thread transforms with its own instance of the underlying
+// gdal transformation, which is created on first use.
+//
+// SharedTransforms are cached for the lifetime of the process and need not (and cannot)
+// be closed.
+type SharedTransform struct {
+	handle C.godalSharedTransformH
+}
+
+// NewSharedTransform returns the process wide SharedTransform from src to dst, creating
+// it on the first call for a given pair of spatial references. src and dst are copied,
+// and may be closed once NewSharedTransform returns.
+func NewSharedTransform(src, dst *SpatialRef, opts ...TransformOption) (*SharedTransform, error) {
+	to := &trnOpts{}
+	for _, o := range opts {
+		o.setTransformOpt(to)
+	}
+	cgc := createCGOContext(nil, to.errorHandler)
+	hndl := C.godalCachedTransform(cgc.cPointer(), src.handle, dst.handle)
+	if err := cgc.close(); err != nil {
+		return nil, err
+	}
+	return &SharedTransform{handle: hndl}, nil
+}
+
+// threadTransform returns the instance of the transformation for the current OS thread,
+// which must be locked by the caller for as long as the returned Transform is used
+func (st *SharedTransform) threadTransform(errorHandler ErrorHandler) (*Transform, error) {
+	cgc := createCGOContext(nil, errorHandler)
+	hndl := C.godalSharedTransformHandle(cgc.cPointer(), st.handle)
+	if err := cgc.close(); err != nil {
+		return nil, err
+	}
+	return &Transform{handle: hndl}, nil
+}
+
+// TransformEx reprojects points in place, as Transform.TransformEx does
+func (st *SharedTransform) TransformEx(x []float64, y []float64, z []float64, successful []bool, opts ...TransformExOption) error {
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+	trn, err := st.threadTransform(nil)
+	if err != nil {
+		return err
+	}
+	return trn.TransformEx(x, y, z, successful, opts...)
+}
+
+// TransformGeometry transforms the given geometry in place, as Geometry.Transform does.
+// The geometry is assigned its own copy of the target spatial reference.
+func (st *SharedTransform) TransformGeometry(g *Geometry, opts ...GeometryTransformOption) error {
+	gto := geometryTransformOpts{}
+	for _, o := range opts {
+		o.setGeometryTransformOpt(&gto)
+	}
+	runtime.LockOSThread()
+	defer runtime.UnlockOSThread()
+	cgc := createCGOContext(nil, gto.errorHandler)
+	C.godalSharedTransformGeometry(cgc.cPointer(), g.handle, st.handle)
+	return cgc.close()
+}
@@ -0,0 +1,268 @@
+// Copyright 2021 Airbus Defence and Space
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package godal
+
+import (
+	"fmt"
+	"runtime"
+	"sync"
+)
+
+// Tile is a window of a dataset being processed by ProcessTiles
+type Tile struct {
+	Block
+	// Buffer holds the W*H pixels of all the bands of the window, pixel interleaved,
+	// in a slice of the dataset's data type (i.e. []byte, []float32, ...). It may be
+	// modified in place and is only valid for the duration of the TileFunc call.
+	Buffer interface{}
+}
+
+// TileFunc is the kernel applied by ProcessTiles to each tile
+type TileFunc func(t Tile) error
+
+// newBuffer allocates a slice of n pixels of type dt
+func newBuffer(dt DataType, n int) (interface{}, error) {
+	switch dt {
+	case Byte:
+		return make([]byte, n), nil
+	case Int16:
+		return make([]int16, n), nil
+	case UInt16:
+		return make([]uint16, n), nil
+	case Int32:
+		return make([]int32, n), nil
+	case UInt32:
+		return make([]uint32, n), nil
+	case Float32:
+		return make([]float32, n), nil
+	case Float64:
+		return make([]float64, n), nil
+	case CInt16, CFloat32:
+		return make([]complex64, n), nil
+	case CInt32, CFloat64:
+		return make([]complex128, n), nil
+	default:
+		return nil, fmt.Errorf("unsupported data type %s", dt)
+	}
+}
+
+// sliceBuffer returns the first n pixels of a buffer allocated by newBuffer
+func sliceBuffer(buf interface{}, n int) interface{} {
+	switch b := buf.(type) {
+	case []byte:
+		return b[:n]
+	case []int16:
+		return b[:n]
+	case []uint16:
+		return b[:n]
+	case []int32:
+		return b[:n]
+	case []uint32:
+		return b[:n]
+	case []float32:
+		return b[:n]
+	case []float64:
+		return b[:n]
+	case []complex64:
+		return b[:n]
+	case []complex128:
+		return b[:n]
+	default:
+		panic("unsupported type")
+	}
+}
+
+// ProcessTiles cuts the dataset into windows aligned on its blocks (c.f. TileSize), and
+// runs a read → fn → write pipeline on each of them with a pool of workers:
+//
+// • each worker reads the tiles from its own handle on the dataset, reopened by name
+// with the same driver and open options, as datasets cannot be used concurrently. If the
+// dataset is not opened read-only (as other handles would miss its unflushed writes) or
+// cannot be reopened identically (e.g. a MEM dataset), the reads are serialized on ds while
+// fn is still run concurrently.
+//
+// • fn is called concurrently from the workers, in no particular order.
+//
+// • if a destination dataset is given with ProcessInto, the tiles are written to it once
+// fn returns, by a single goroutine. The destination must have the size and number of
+// bands of ds, and may be ds itself.
+//
+// At most MaxTilesInFlight tile buffers are in use at any time. Processing stops at the
+// first error, which is returned, and no tile is written after it.
+func (ds *Dataset) ProcessTiles(fn TileFunc, opts ...ProcessTilesOption) error {
+	po := processTilesOpts{
+		workers: runtime.NumCPU(),
+	}
+	for _, o := range opts {
+		o.setProcessTilesOpt(&po)
+	}
+	st := ds.Structure()
+	if po.tileX <= 0 || po.tileY <= 0 {
+		po.tileX, po.tileY = st.BlockSizeX, st.BlockSizeY
+	}
+	if po.tileX%st.BlockSizeX != 0 || po.tileY%st.BlockSizeY != 0 {
+		return fmt.Errorf("tile size %dx%d is not a multiple of the block size %dx%d",
+			po.tileX, po.tileY, st.BlockSizeX, st.BlockSizeY)
+	}
+	if _, err := newBuffer(st.DataType, 0); err != nil {
+		return err
+	}
+	if po.dst != nil {
+		dst := po.dst.Structure()
+		if dst.SizeX != st.SizeX || dst.SizeY != st.SizeY || dst.NBands != st.NBands {
+			return fmt.Errorf("destination dataset is %dx%dx%d, expected %dx%dx%d",
+				dst.SizeX, dst.SizeY, dst.NBands, st.SizeX, st.SizeY, st.NBands)
+		}
+	}
+	if po.workers <= 0 {
+		po.workers = 1
+	}
+	if po.inFlight <= 0 {
+		po.inFlight = 2 * po.workers
+	}
+	var ioOpts []DatasetIOOption
+	if po.errorHandler != nil {
+		ioOpts = append(ioOpts, ErrLogger(po.errorHandler))
+	}
+
+	var (
+		errMu    sync.Mutex
+		firstErr error
+		done     = make(chan struct{})
+	)
+	fail := func(err error) {
+		errMu.Lock()
+		defer errMu.Unlock()
+		if firstErr == nil {
+			firstErr = err
+			close(done)
+		}
+	}
+
+	//each worker reads from its own handle, or from ds under ioMu if it cannot be reopened.
+	//writes to ds itself are also made under ioMu
+	reopened, err := ds.reopen(po.workers, po.errorHandler)
+	if err != nil {
+		return err
+	}
+	handles := make([]*Dataset, po.workers)
+	copy(handles, reopened)
+	var ioMu sync.Mutex
+	defer func() {
+		for _, h := range handles {
+			if h != nil {
+				_ = h.Close()
+			}
+		}
+	}()
+
+	free := make(chan interface{}, po.inFlight)
+	for i := 0; i < po.inFlight; i++ {
+		free <- nil //buffers are allocated lazily
+	}
+	tiles := make(chan Tile)
+	writes := make(chan Tile)
+	var wg sync.WaitGroup
+
+	//producer
+	go func() {
+		defer close(tiles)
+		for b, ok := BlockIterator(st.SizeX, st.SizeY, po.tileX, po.tileY), true; ok; b, ok = b.Next() {
+			var buf interface{}
+			select {
+			case buf = <-free:
+			case <-done:
+				return
+			}
+			if buf == nil {
+				buf, _ = newBuffer(st.DataType, po.tileX*po.tileY*st.NBands)
+			}
+			select {
+			case tiles <- Tile{Block: b, Buffer: buf}:
+			case <-done:
+				return
+			}
+		}
+	}()
+
+	wg.Add(po.workers)
+	for w := 0; w < po.workers; w++ {
+		go func(w int) {
+			defer wg.Done()
+			src := handles[w]
+			if src == nil {
+				src = ds
+			}
+			for t := range tiles {
+				full := t.Buffer
+				t.Buffer = sliceBuffer(full, t.W*t.H*st.NBands)
+				if src == ds {
+					ioMu.Lock()
+				}
+				err := src.Read(t.X0, t.Y0, t.Buffer, t.W, t.H, ioOpts...)
+				if src == ds {
+					ioMu.Unlock()
+				}
+				if err == nil {
+					err = fn(t)
+				}
+				if err != nil {
+					fail(err)
+					free <- full
+					continue
+				}
+				if po.dst == nil {
+					free <- full
+					continue
+				}
+				select {
+				case writes <- t:
+				case <-done:
+					free <- full
+				}
+			}
+		}(w)
+	}
+
+	//writer
+	writerDone := make(chan struct{})
+	go func() {
+		defer close(writerDone)
+		inPlace := po.dst != nil && po.dst.handle() == ds.handle()
+		for t := range writes {
+			select {
+			case <-done:
+				//drain the remaining tiles without writing them
+			default:
+				if inPlace {
+					ioMu.Lock()
+				}
+				err := po.dst.Write(t.X0, t.Y0, t.Buffer, t.W, t.H, ioOpts...)
+				if inPlace {
+					ioMu.Unlock()
+				}
+				if err != nil {
+					fail(err)
+				}
+			}
+			free <- sliceBuffer(t.Buffer, po.tileX*po.tileY*st.NBands)
+		}
+	}()
+
+	wg.Wait()
+	close(writes)
+	<-writerDone
+	return firstErr
+}
@@ -0,0 +1,116 @@
+// Copyright 2021 Airbus Defence and Space
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package godal
+
+/*
+#include "godal.h"
+#include <stdlib.h>
+*/
+import "C"
+import (
+	"fmt"
+	"unsafe"
+)
+
+// Warper warps a fixed set of source datasets into many destination datasets, e.g.
+// to serve map tiles. The warp options and the source to destination transformers are
+// set up once by NewWarper, so that each WarpTile call only costs the warping of the
+// pixels it produces.
+//
+// A Warper must not be used concurrently, and its sources must stay open until the
+// Warper is closed.
+type Warper struct {
+	handle  C.godalWarperH
+	sources []*Dataset
+}
+
+// NewWarper creates a Warper from the given sources, which must all have the same number
+// of bands, into the dstSRS spatial reference. If dstSRS is nil, the sources are warped
+// in their own spatial reference.
+//
+// Unless set with WarpErrorThreshold, an approximate transformer with a 0.125 pixel error
+// threshold is used, as gdalwarp does.
+func NewWarper(sources []*Dataset, dstSRS *SpatialRef, opts ...WarperOption) (*Warper, error) {
+	wo := warperOpts{resampling: Nearest}
+	for _, opt := range opts {
+		opt.setWarperOpt(&wo)
+	}
+	if len(sources) == 0 {
+		return nil, fmt.Errorf("no source datasets")
+	}
+	alg, err := wo.resampling.warpAlg()
+	if err != nil {
+		return nil, err
+	}
+	errorThreshold := 0.125
+	if wo.warp.hasThreshold {
+		errorThreshold = wo.warp.errorThreshold
+	}
+	srcDS := make([]C.GDALDatasetH, len(sources))
+	for i, dataset := range sources {
+		srcDS[i] = dataset.handle()
+	}
+	var csrs C.OGRSpatialReferenceH
+	if dstSRS != nil {
+		csrs = dstSRS.handle
+	}
+
+	cgc := createCGOContext(wo.config, wo.errorHandler)
+	hndl := C.godalCreateWarper(cgc.cPointer(), C.int(len(sources)), (*C.GDALDatasetH)(unsafe.Pointer(&srcDS[0])),
+		csrs, alg, C.double(errorThreshold), C.double(wo.warp.memoryMB)*1024*1024, C.int(wo.warp.threads))
+	if err := cgc.close(); err != nil {
+		return nil, err
+	}
+	srcs := make([]*Dataset, len(sources))
+	copy(srcs, sources)
+	return &Warper{handle: hndl, sources: srcs}, nil
+}
+
+// WarpTile warps the sources into dst, after having set its geotransform so that it covers
+// bounds, in the order:
+//  [MinX, MinY, MaxX, MaxY]
+// expressed in the Warper's destination spatial reference. dst must have as many bands as
+// the sources. If dst has no projection, it is set to the Warper's destination spatial
+// reference. The pixels of dst that are not covered by any source are set to the dst
+// band's nodata value, or to 0.
+func (w *Warper) WarpTile(dst *Dataset, bounds [4]float64, opts ...WarpTileOption) error {
+	wo := warpTileOpts{}
+	for _, opt := range opts {
+		opt.setWarpTileOpt(&wo)
+	}
+	st := dst.Structure()
+	if st.SizeX <= 0 || st.SizeY <= 0 {
+		return fmt.Errorf("invalid destination size %dx%d", st.SizeX, st.SizeY)
+	}
+	gt := [6]C.double{
+		C.double(bounds[0]), C.double((bounds[2] - bounds[0]) / float64(st.SizeX)), 0,
+		C.double(bounds[3]), 0, C.double(-(bounds[3] - bounds[1]) / float64(st.SizeY)),
+	}
+
+	cgc := createCGOContext(wo.config, wo.errorHandler)
+	cgc.setProgress(wo.progress)
+	C.godalWarperWarp(cgc.cPointer(), w.handle, dst.handle(), &gt[0])
+	return cgc.close()
+}
+
+// Close releases the resources held by the Warper. It does not close its sources.
+func (w *Warper) Close() {
+	if w.handle == nil {
+		return
+	}
+	C.godalDestroyWarper(w.handle)
+	w.handle = nil
+	w.sources = nil
+}